@@ -102,6 +102,7 @@ typedef struct _ClutterAnimationInfo    ClutterAnimationInfo;
 struct _SizeRequest
 {
   guint  age;
+  guint  generation;
   gfloat for_size;
   gfloat min_size;
   gfloat natural_size;
@@ -271,6 +272,57 @@ gboolean clutter_actor_get_redraw_clip (ClutterActor       *self,
                                         ClutterPaintVolume *dst_old_pv,
                                         ClutterPaintVolume *dst_new_pv);
 
+void clutter_actor_cull_occluded (ClutterActor         *self,
+                                  const cairo_region_t *clip_region,
+                                  GPtrArray            *occluded_actors);
+
+void clutter_actor_reset_occluded (ClutterActor *self);
+
+/* Per actor state of the redraw queue of the stage, see
+ * clutter_stage_queue_actor_redraw()
+ */
+typedef struct _ClutterQueueRedrawEntry
+{
+  /* link in the stage list of actors with a pending redraw */
+  GList link;
+  gboolean queued;
+
+  /* NULL when the whole actor needs to be redrawn */
+  ClutterPaintVolume *clip;
+
+  /* stage space bounding box of the last paint volume, valid as long
+   * as last_paint_box_serial matches the stage projection serial
+   */
+  ClutterActorBox last_paint_box;
+  unsigned int last_paint_box_serial;
+} ClutterQueueRedrawEntry;
+
+ClutterQueueRedrawEntry * clutter_actor_get_queue_redraw_entry (ClutterActor *self);
+
+void clutter_actor_begin_transition_updates (void);
+void clutter_actor_end_transition_updates (void);
+
+gboolean clutter_actor_can_set_transition_value (ClutterActor *self,
+                                                 GParamSpec   *pspec);
+gboolean clutter_actor_set_transition_value (ClutterActor *self,
+                                             GParamSpec   *pspec,
+                                             const GValue *value);
+gboolean clutter_actor_set_transition_float (ClutterActor *self,
+                                             GParamSpec   *pspec,
+                                             float         value);
+gboolean clutter_actor_set_transition_double (ClutterActor *self,
+                                              GParamSpec   *pspec,
+                                              double        value);
+gboolean clutter_actor_set_transition_point (ClutterActor           *self,
+                                             GParamSpec             *pspec,
+                                             const graphene_point_t *value);
+gboolean clutter_actor_set_transition_size (ClutterActor          *self,
+                                            GParamSpec            *pspec,
+                                            const graphene_size_t *value);
+gboolean clutter_actor_set_transition_color (ClutterActor       *self,
+                                             GParamSpec         *pspec,
+                                             const ClutterColor *value);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ACTOR_PRIVATE_H__ */
@@ -665,9 +665,12 @@ typedef enum
                               */
 } MapStateChange;
 
-/* 3 entries should be a good compromise, few layout managers
- * will ask for 3 different preferred size in each allocation cycle */
-#define N_CACHED_SIZE_REQUESTS 3
+/* height-for-width layouts (e.g. box layouts with wrapping text or
+ * flow layouts) ask for a handful of different preferred sizes while
+ * distributing space, so keep a few more than that around */
+#define N_CACHED_SIZE_REQUESTS 6
+
+#define OCCLUSION_EPSILON 0.01f
 
 struct _ClutterActorPrivate
 {
@@ -682,6 +685,10 @@ struct _ClutterActorPrivate
   guint cached_height_age;
   guint cached_width_age;
 
+  /* cached size requests from an older generation are stale; bumped
+   * whenever a relayout is queued */
+  guint size_request_generation;
+
   /* the bounding box of the actor, relative to the parent's
    * allocation
    */
@@ -775,6 +782,8 @@ struct _ClutterActorPrivate
    */
   ClutterPaintVolume last_paint_volume;
 
+  ClutterQueueRedrawEntry queue_redraw_entry;
+
   ClutterColor bg_color;
 
   /* a string used for debugging messages */
@@ -801,6 +810,13 @@ struct _ClutterActorPrivate
 
   GList *stage_views;
 
+  /* paint nodes retained across frames; see
+   * clutter_actor_set_retain_paint_nodes() */
+  ClutterPaintNode *retained_root_node;
+  float retained_width;
+  float retained_height;
+  guint8 retained_paint_opacity;
+
   /* bitfields: KEEP AT THE END */
 
   /* fixed position and sizes */
@@ -843,6 +859,9 @@ struct _ClutterActorPrivate
   guint had_effects_on_last_paint_volume_update : 1;
   guint needs_update_stage_views    : 1;
   guint clear_stage_views_needs_stage_views_changed : 1;
+  guint retain_paint_nodes          : 1;
+  guint is_occluded                 : 1;
+  guint in_transition_batch         : 1;
 };
 
 enum
@@ -1066,6 +1085,7 @@ static void clutter_actor_push_in_cloned_branch (ClutterActor *self,
 static void clutter_actor_pop_in_cloned_branch (ClutterActor *self,
                                                 gulong        count);
 static void ensure_valid_actor_transform (ClutterActor *actor);
+static void clutter_actor_invalidate_retained_paint_nodes (ClutterActor *self);
 
 static void push_in_paint_unmapped_branch (ClutterActor *self,
                                            guint         count);
@@ -1655,6 +1675,8 @@ clutter_actor_real_unmap (ClutterActor *self)
 
   CLUTTER_ACTOR_UNSET_FLAGS (self, CLUTTER_ACTOR_MAPPED);
 
+  clutter_actor_invalidate_retained_paint_nodes (self);
+
   if (priv->unmapped_paint_branch_counter == 0)
     {
       /* clear the contents of the last paint volume, so that hiding + moving +
@@ -1662,6 +1684,7 @@ clutter_actor_real_unmap (ClutterActor *self)
        */
      _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
       priv->last_paint_volume_valid = TRUE;
+      priv->queue_redraw_entry.last_paint_box_serial = 0;
 
       if (priv->parent && !CLUTTER_ACTOR_IN_DESTRUCTION (priv->parent))
         {
@@ -2687,11 +2710,16 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   priv->needs_height_request = TRUE;
   priv->needs_allocation     = TRUE;
 
-  /* reset the cached size requests */
-  memset (priv->width_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
-  memset (priv->height_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+  /* invalidate the cached size requests */
+  priv->size_request_generation++;
+  if (G_UNLIKELY (priv->size_request_generation == 0))
+    {
+      memset (priv->width_requests, 0,
+              N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+      memset (priv->height_requests, 0,
+              N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+      priv->size_request_generation = 1;
+    }
 
   /* We may need to go all the way up the hierarchy */
   if (priv->parent != NULL)
@@ -3372,9 +3400,13 @@ _clutter_actor_update_last_paint_volume (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
   const ClutterPaintVolume *pv;
+  ClutterPaintVolume old_pv;
+  gboolean had_last_paint_volume;
 
+  had_last_paint_volume = priv->last_paint_volume_valid;
   if (priv->last_paint_volume_valid)
     {
+      _clutter_paint_volume_copy_static (&priv->last_paint_volume, &old_pv);
       clutter_paint_volume_free (&priv->last_paint_volume);
       priv->last_paint_volume_valid = FALSE;
     }
@@ -3385,6 +3417,7 @@ _clutter_actor_update_last_paint_volume (ClutterActor *self)
       CLUTTER_NOTE (CLIPPING, "Bail from update_last_paint_volume (%s): "
                     "Actor failed to report a paint volume",
                     _clutter_actor_get_debug_name (self));
+      priv->queue_redraw_entry.last_paint_box_serial = 0;
       return;
     }
 
@@ -3394,6 +3427,11 @@ _clutter_actor_update_last_paint_volume (ClutterActor *self)
                                             NULL); /* eye coordinates */
 
   priv->last_paint_volume_valid = TRUE;
+
+  /* Actors that didn't move keep their cached stage space bounds */
+  if (!had_last_paint_volume ||
+      memcmp (&old_pv, &priv->last_paint_volume, sizeof (old_pv)) != 0)
+    priv->queue_redraw_entry.last_paint_box_serial = 0;
 }
 
 /* This is the same as clutter_actor_add_effect except that it doesn't
@@ -3522,10 +3560,10 @@ clutter_actor_real_paint (ClutterActor        *actor,
     }
 }
 
-static gboolean
-clutter_actor_paint_node (ClutterActor        *actor,
-                          ClutterPaintNode    *root,
-                          ClutterPaintContext *paint_context)
+static void
+clutter_actor_add_paint_nodes (ClutterActor        *actor,
+                               ClutterPaintNode    *root,
+                               ClutterPaintContext *paint_context)
 {
   ClutterActorPrivate *priv = actor->priv;
   ClutterActorBox box;
@@ -3583,7 +3621,61 @@ clutter_actor_paint_node (ClutterActor        *actor,
 
   if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
     CLUTTER_ACTOR_GET_CLASS (actor)->paint_node (actor, root);
+}
+
+static void
+clutter_actor_invalidate_retained_paint_nodes (ClutterActor *self)
+{
+  g_clear_pointer (&self->priv->retained_root_node, clutter_paint_node_unref);
+}
+
+static ClutterPaintNode *
+clutter_actor_ensure_retained_paint_nodes (ClutterActor        *self,
+                                           ClutterPaintContext *paint_context)
+{
+  ClutterActorPrivate *priv = self->priv;
+  CoglFramebuffer *framebuffer;
+  float width, height;
+  guint8 paint_opacity;
+
+  framebuffer = clutter_paint_context_get_base_framebuffer (paint_context);
+  width = clutter_actor_box_get_width (&priv->allocation);
+  height = clutter_actor_box_get_height (&priv->allocation);
+  paint_opacity = clutter_actor_get_paint_opacity_internal (self);
+
+  /* The paint opacity depends on the ancestors, and allocation changes
+   * don't necessarily queue a redraw on the actor itself, so check these
+   * explicitly instead of relying on clutter_actor_queue_redraw().
+   */
+  if (priv->retained_root_node &&
+      (priv->retained_paint_opacity != paint_opacity ||
+       !G_APPROX_VALUE (priv->retained_width, width, FLT_EPSILON) ||
+       !G_APPROX_VALUE (priv->retained_height, height, FLT_EPSILON)))
+    clutter_actor_invalidate_retained_paint_nodes (self);
+
+  if (priv->retained_root_node)
+    {
+      _clutter_dummy_node_set_framebuffer (priv->retained_root_node,
+                                           framebuffer);
+      return clutter_paint_node_ref (priv->retained_root_node);
+    }
 
+  priv->retained_root_node = _clutter_dummy_node_new (self, framebuffer);
+  clutter_paint_node_set_static_name (priv->retained_root_node, "Root");
+  priv->retained_width = width;
+  priv->retained_height = height;
+  priv->retained_paint_opacity = paint_opacity;
+
+  clutter_actor_add_paint_nodes (self, priv->retained_root_node, paint_context);
+
+  return clutter_paint_node_ref (priv->retained_root_node);
+}
+
+static gboolean
+clutter_actor_paint_node (ClutterActor        *actor,
+                          ClutterPaintNode    *root,
+                          ClutterPaintContext *paint_context)
+{
   if (clutter_paint_node_get_n_children (root) == 0)
     return FALSE;
 
@@ -3798,6 +3890,12 @@ clutter_actor_paint (ClutterActor        *self,
        * the initialization is redundant :-( */
       ClutterCullResult result = CLUTTER_CULL_RESULT_IN;
 
+      /* Fully covered by opaque actors painted above, see
+       * clutter_actor_cull_occluded()
+       */
+      if (priv->is_occluded)
+        return;
+
       success = should_cull_out
         ? cull_actor (self, paint_context, &result)
         : FALSE;
@@ -3866,9 +3964,20 @@ clutter_actor_continue_paint (ClutterActor        *self,
        * for the entire frame, starting from the Stage; the paint()
        * virtual function can then be called directly.
        */
-      framebuffer = clutter_paint_context_get_base_framebuffer (paint_context);
-      dummy = _clutter_dummy_node_new (self, framebuffer);
-      clutter_paint_node_set_static_name (dummy, "Root");
+      if (priv->retain_paint_nodes && !CLUTTER_ACTOR_IS_TOPLEVEL (self))
+        {
+          dummy = clutter_actor_ensure_retained_paint_nodes (self,
+                                                             paint_context);
+        }
+      else
+        {
+          framebuffer =
+            clutter_paint_context_get_base_framebuffer (paint_context);
+          dummy = _clutter_dummy_node_new (self, framebuffer);
+          clutter_paint_node_set_static_name (dummy, "Root");
+
+          clutter_actor_add_paint_nodes (self, dummy, paint_context);
+        }
 
       /* XXX - for 1.12, we use the return value of paint_node() to
        * decide whether we should call the paint() vfunc.
@@ -5575,6 +5684,7 @@ clutter_actor_dispose (GObject *object)
     }
 
   g_clear_pointer (&priv->stage_views, g_list_free);
+  clutter_actor_invalidate_retained_paint_nodes (self);
 
   G_OBJECT_CLASS (clutter_actor_parent_class)->dispose (object);
 }
@@ -5829,6 +5939,29 @@ clutter_actor_real_has_overlaps (ClutterActor *self)
   return TRUE;
 }
 
+static cairo_region_t *
+clutter_actor_real_get_opaque_region (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  cairo_rectangle_int_t rect;
+
+  /* The background color is painted below the content and paint_node(),
+   * so whatever those draw, an opaque background keeps the actor opaque.
+   */
+  if (!priv->bg_color_set || priv->bg_color.alpha != 255)
+    return NULL;
+
+  rect.x = 0;
+  rect.y = 0;
+  rect.width = floorf (clutter_actor_box_get_width (&priv->allocation));
+  rect.height = floorf (clutter_actor_box_get_height (&priv->allocation));
+
+  if (rect.width <= 0 || rect.height <= 0)
+    return NULL;
+
+  return cairo_region_create_rectangle (&rect);
+}
+
 static float
 clutter_actor_real_calculate_resource_scale (ClutterActor *self,
                                              int           phase)
@@ -5930,6 +6063,7 @@ clutter_actor_class_init (ClutterActorClass *klass)
   klass->get_accessible = clutter_actor_real_get_accessible;
   klass->get_paint_volume = clutter_actor_real_get_paint_volume;
   klass->has_overlaps = clutter_actor_real_has_overlaps;
+  klass->get_opaque_region = clutter_actor_real_get_opaque_region;
   klass->calculate_resource_scale = clutter_actor_real_calculate_resource_scale;
   klass->paint = clutter_actor_real_paint;
   klass->destroy = clutter_actor_real_destroy;
@@ -7894,6 +8028,7 @@ clutter_actor_init (ClutterActor *self)
 
   priv->cached_width_age = 1;
   priv->cached_height_age = 1;
+  priv->size_request_generation = 1;
 
   priv->opacity_override = -1;
   priv->enable_model_view_transform = TRUE;
@@ -7902,6 +8037,8 @@ clutter_actor_init (ClutterActor *self)
   _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
   priv->last_paint_volume_valid = TRUE;
 
+  priv->queue_redraw_entry.link.data = self;
+
   priv->transform_valid = FALSE;
 
   /* the default is to stretch the content, to match the
@@ -8007,6 +8144,11 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
    * should be up to date).
    */
 
+  /* Anything queueing a redraw may have changed what the actor paints,
+   * so the retained paint nodes can't be reused anymore.
+   */
+  clutter_actor_invalidate_retained_paint_nodes (self);
+
   /* ignore queueing a redraw for actors being destroyed */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
@@ -8523,12 +8665,16 @@ clutter_actor_adjust_height (ClutterActor *self,
 }
 
 /* looks for a cached size request for this for_size. If not
- * found, returns the oldest entry so it can be overwritten */
+ * found, returns a stale or the least recently used entry so it can
+ * be overwritten */
 static gboolean
 _clutter_actor_get_cached_size_request (gfloat         for_size,
+                                        guint          generation,
                                         SizeRequest   *cached_size_requests,
+                                        guint         *age,
                                         SizeRequest  **result)
 {
+  guint result_age = G_MAXUINT;
   guint i;
 
   *result = &cached_size_requests[0];
@@ -8536,19 +8682,31 @@ _clutter_actor_get_cached_size_request (gfloat         for_size,
   for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
     {
       SizeRequest *sr;
+      guint sr_age;
 
       sr = &cached_size_requests[i];
 
-      if (sr->age > 0 &&
-          sr->for_size == for_size)
+      if (sr->age > 0 && sr->generation == generation)
         {
-          CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
-          *result = sr;
-          return TRUE;
+          if (sr->for_size == for_size)
+            {
+              CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
+              sr->age = (*age)++;
+              *result = sr;
+              return TRUE;
+            }
+
+          sr_age = sr->age;
         }
-      else if (sr->age < (*result)->age)
+      else
+        {
+          sr_age = 0;
+        }
+
+      if (sr_age < result_age)
         {
           *result = sr;
+          result_age = sr_age;
         }
     }
 
@@ -8682,7 +8840,9 @@ clutter_actor_get_preferred_width (ClutterActor *self,
     {
       found_in_cache =
         _clutter_actor_get_cached_size_request (for_height,
+                                                priv->size_request_generation,
                                                 priv->width_requests,
+                                                &priv->cached_width_age,
                                                 &cached_size_request);
     }
   else
@@ -8735,6 +8895,7 @@ clutter_actor_get_preferred_width (ClutterActor *self,
       cached_size_request->natural_size = natural_width;
       cached_size_request->for_size = for_height;
       cached_size_request->age = priv->cached_width_age;
+      cached_size_request->generation = priv->size_request_generation;
 
       priv->cached_width_age += 1;
       priv->needs_width_request = FALSE;
@@ -8847,7 +9008,9 @@ clutter_actor_get_preferred_height (ClutterActor *self,
     {
       found_in_cache =
         _clutter_actor_get_cached_size_request (for_width,
+                                                priv->size_request_generation,
                                                 priv->height_requests,
+                                                &priv->cached_height_age,
                                                 &cached_size_request);
     }
   else
@@ -8899,6 +9062,7 @@ clutter_actor_get_preferred_height (ClutterActor *self,
       cached_size_request->natural_size = natural_height;
       cached_size_request->for_size = for_width;
       cached_size_request->age = priv->cached_height_age;
+      cached_size_request->generation = priv->size_request_generation;
 
       priv->cached_height_age += 1;
       priv->needs_height_request = FALSE;
@@ -10895,6 +11059,56 @@ clutter_actor_get_offscreen_redirect (ClutterActor *self)
   return self->priv->offscreen_redirect;
 }
 
+/**
+ * clutter_actor_set_retain_paint_nodes:
+ * @self: a #ClutterActor
+ * @retain: whether to retain the paint nodes of @self between frames
+ *
+ * Sets whether the paint nodes built for @self by its content and its
+ * #ClutterActorClass.paint_node() implementation are kept across frames
+ * and repainted as they are, instead of being rebuilt on every paint.
+ *
+ * The retained nodes are dropped whenever a redraw is queued on @self,
+ * or when its size or paint opacity changes. Only actors whose paint
+ * nodes depend exclusively on state that queues a redraw when changed
+ * should enable this.
+ */
+void
+clutter_actor_set_retain_paint_nodes (ClutterActor *self,
+                                      gboolean      retain)
+{
+  ClutterActorPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  priv = self->priv;
+
+  if (priv->retain_paint_nodes == !!retain)
+    return;
+
+  priv->retain_paint_nodes = !!retain;
+
+  if (!priv->retain_paint_nodes)
+    clutter_actor_invalidate_retained_paint_nodes (self);
+}
+
+/**
+ * clutter_actor_get_retain_paint_nodes:
+ * @self: a #ClutterActor
+ *
+ * Retrieves whether the paint nodes of @self are retained between
+ * frames, as set by clutter_actor_set_retain_paint_nodes().
+ *
+ * Returns: %TRUE if the paint nodes are retained
+ */
+gboolean
+clutter_actor_get_retain_paint_nodes (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  return self->priv->retain_paint_nodes;
+}
+
 /**
  * clutter_actor_set_name:
  * @self: A #ClutterActor
@@ -13323,6 +13537,311 @@ clutter_actor_set_final_state (ClutterAnimatable *animatable,
   g_free (p_name);
 }
 
+/* Actors updated by transitions during the current frame, with their
+ * property notifications frozen until all timelines have advanced
+ */
+static GPtrArray *transition_batch_actors = NULL;
+static int transition_batch_depth = 0;
+
+/*
+ * clutter_actor_begin_transition_updates:
+ *
+ * Starts collecting the property notifications of actors updated by
+ * transitions, so that an actor animating several properties emits each
+ * notification once per frame, after all the transitions of the frame have
+ * been computed. Must be paired with clutter_actor_end_transition_updates().
+ */
+void
+clutter_actor_begin_transition_updates (void)
+{
+  if (transition_batch_actors == NULL)
+    transition_batch_actors = g_ptr_array_new ();
+
+  transition_batch_depth++;
+}
+
+/*
+ * clutter_actor_end_transition_updates:
+ *
+ * Emits the property notifications collected since the matching
+ * clutter_actor_begin_transition_updates().
+ */
+void
+clutter_actor_end_transition_updates (void)
+{
+  g_autoptr (GPtrArray) actors = NULL;
+  unsigned int i;
+
+  g_return_if_fail (transition_batch_depth > 0);
+
+  if (--transition_batch_depth > 0)
+    return;
+
+  /* Notification handlers might start new transitions */
+  actors = g_steal_pointer (&transition_batch_actors);
+
+  for (i = 0; i < actors->len; i++)
+    {
+      ClutterActor *actor = g_ptr_array_index (actors, i);
+
+      actor->priv->in_transition_batch = FALSE;
+      g_object_thaw_notify (G_OBJECT (actor));
+      g_object_unref (actor);
+    }
+}
+
+static void
+clutter_actor_begin_transition_update (ClutterActor *self)
+{
+  if (transition_batch_depth == 0 || self->priv->in_transition_batch)
+    return;
+
+  self->priv->in_transition_batch = TRUE;
+  g_object_freeze_notify (G_OBJECT (self));
+  g_ptr_array_add (transition_batch_actors, g_object_ref (self));
+}
+
+static void
+clutter_actor_end_transition_update (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  /* Instead of repicking the pointer right away for every transition, let
+   * the stage update the input devices once after the frame has been laid
+   * out.
+   */
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL)
+    clutter_stage_invalidate_devices (CLUTTER_STAGE (stage));
+}
+
+/*
+ * clutter_actor_can_set_transition_value:
+ * @self: a #ClutterActor
+ * @pspec: the #GParamSpec of an animatable property
+ *
+ * Checks whether transitions of @pspec can take the fast paths below,
+ * which skip resolving the property from its name. This is the case for
+ * the animatable properties of #ClutterActor itself, unless a subclass
+ * interpolates or applies them differently.
+ */
+gboolean
+clutter_actor_can_set_transition_value (ClutterActor *self,
+                                        GParamSpec   *pspec)
+{
+  ClutterAnimatableInterface *iface;
+
+  if (pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      (pspec->flags & CLUTTER_PARAM_ANIMATABLE) == 0)
+    return FALSE;
+
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (self);
+
+  return (iface->set_final_state == clutter_actor_set_final_state &&
+          iface->interpolate_value == NULL);
+}
+
+/*
+ * clutter_actor_set_transition_value:
+ * @self: a #ClutterActor
+ * @pspec: the #GParamSpec of an animatable property
+ * @value: the interpolated value
+ *
+ * Fast path for transitions updating one of the animatable properties of
+ * #ClutterActor itself.
+ *
+ * Returns: %FALSE if @pspec isn't handled, and the generic
+ *   clutter_animatable_set_final_state() must be used instead
+ */
+gboolean
+clutter_actor_set_transition_value (ClutterActor *self,
+                                    GParamSpec   *pspec,
+                                    const GValue *value)
+{
+  if (!clutter_actor_can_set_transition_value (self, pspec))
+    return FALSE;
+
+  clutter_actor_begin_transition_update (self);
+  clutter_actor_set_animatable_property (self, pspec->param_id, value, pspec);
+  clutter_actor_end_transition_update (self);
+
+  return TRUE;
+}
+
+/*
+ * clutter_actor_set_transition_float:
+ * @self: a #ClutterActor
+ * @pspec: a #GParamSpec accepted by clutter_actor_can_set_transition_value()
+ * @value: the interpolated value
+ *
+ * Like clutter_actor_set_transition_value(), for float properties, without
+ * going through a #GValue.
+ *
+ * Returns: %FALSE if @pspec isn't a float property with a direct setter
+ */
+gboolean
+clutter_actor_set_transition_float (ClutterActor *self,
+                                    GParamSpec   *pspec,
+                                    float         value)
+{
+  clutter_actor_begin_transition_update (self);
+
+  switch (pspec->param_id)
+    {
+    case PROP_X:
+      clutter_actor_set_x_internal (self, value);
+      break;
+
+    case PROP_Y:
+      clutter_actor_set_y_internal (self, value);
+      break;
+
+    case PROP_WIDTH:
+      clutter_actor_set_width_internal (self, value);
+      break;
+
+    case PROP_HEIGHT:
+      clutter_actor_set_height_internal (self, value);
+      break;
+
+    case PROP_Z_POSITION:
+      clutter_actor_set_z_position_internal (self, value);
+      break;
+
+    case PROP_PIVOT_POINT_Z:
+      clutter_actor_set_pivot_point_z_internal (self, value);
+      break;
+
+    case PROP_TRANSLATION_X:
+    case PROP_TRANSLATION_Y:
+    case PROP_TRANSLATION_Z:
+      clutter_actor_set_translation_internal (self, value, pspec);
+      break;
+
+    case PROP_MARGIN_TOP:
+    case PROP_MARGIN_BOTTOM:
+    case PROP_MARGIN_LEFT:
+    case PROP_MARGIN_RIGHT:
+      clutter_actor_set_margin_internal (self, value, pspec);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  clutter_actor_end_transition_update (self);
+
+  return TRUE;
+}
+
+/*
+ * clutter_actor_set_transition_double:
+ *
+ * Like clutter_actor_set_transition_float(), for double properties.
+ */
+gboolean
+clutter_actor_set_transition_double (ClutterActor *self,
+                                     GParamSpec   *pspec,
+                                     double        value)
+{
+  clutter_actor_begin_transition_update (self);
+
+  switch (pspec->param_id)
+    {
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_SCALE_Z:
+      clutter_actor_set_scale_factor_internal (self, value, pspec);
+      break;
+
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      clutter_actor_set_rotation_angle_internal (self, value, pspec);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  clutter_actor_end_transition_update (self);
+
+  return TRUE;
+}
+
+/*
+ * clutter_actor_set_transition_point:
+ *
+ * Like clutter_actor_set_transition_float(), for #graphene_point_t
+ * properties.
+ */
+gboolean
+clutter_actor_set_transition_point (ClutterActor           *self,
+                                    GParamSpec             *pspec,
+                                    const graphene_point_t *value)
+{
+  clutter_actor_begin_transition_update (self);
+
+  switch (pspec->param_id)
+    {
+    case PROP_POSITION:
+      clutter_actor_set_position_internal (self, value);
+      break;
+
+    case PROP_PIVOT_POINT:
+      clutter_actor_set_pivot_point_internal (self, value);
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  clutter_actor_end_transition_update (self);
+
+  return TRUE;
+}
+
+/*
+ * clutter_actor_set_transition_size:
+ *
+ * Like clutter_actor_set_transition_float(), for #graphene_size_t
+ * properties.
+ */
+gboolean
+clutter_actor_set_transition_size (ClutterActor          *self,
+                                   GParamSpec            *pspec,
+                                   const graphene_size_t *value)
+{
+  if (pspec->param_id != PROP_SIZE)
+    return FALSE;
+
+  clutter_actor_begin_transition_update (self);
+  clutter_actor_set_size_internal (self, value);
+  clutter_actor_end_transition_update (self);
+
+  return TRUE;
+}
+
+/*
+ * clutter_actor_set_transition_color:
+ *
+ * Like clutter_actor_set_transition_float(), for #ClutterColor properties.
+ */
+gboolean
+clutter_actor_set_transition_color (ClutterActor       *self,
+                                    GParamSpec         *pspec,
+                                    const ClutterColor *value)
+{
+  if (pspec->param_id != PROP_BACKGROUND_COLOR)
+    return FALSE;
+
+  clutter_actor_begin_transition_update (self);
+  clutter_actor_set_background_color_internal (self, value);
+  clutter_actor_end_transition_update (self);
+
+  return TRUE;
+}
+
 static ClutterActor *
 clutter_actor_get_actor (ClutterAnimatable *animatable)
 {
@@ -16087,6 +16606,272 @@ clutter_actor_has_overlaps (ClutterActor *self)
   return CLUTTER_ACTOR_GET_CLASS (self)->has_overlaps (self);
 }
 
+/**
+ * clutter_actor_get_opaque_region:
+ * @self: A #ClutterActor
+ *
+ * Asks the actor's implementation which part of it is painted fully
+ * opaque, not accounting for the opacity of the actor or of its
+ * ancestors. Children are not part of the region, as they report
+ * their own.
+ *
+ * The stage skips painting actors that are fully covered by the opaque
+ * regions of actors above them, as long as those are only scaled and
+ * translated relative to the stage.
+ *
+ * Custom actors can override the default response, which covers the
+ * allocation if the actor has an opaque background color, by
+ * implementing the #ClutterActorClass.get_opaque_region() virtual
+ * function.
+ *
+ * Return value: (transfer full) (nullable): the opaque region, relative
+ *   to the allocation of @self, or %NULL if no part of @self is opaque
+ */
+cairo_region_t *
+clutter_actor_get_opaque_region (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
+
+  return CLUTTER_ACTOR_GET_CLASS (self)->get_opaque_region (self);
+}
+
+static gboolean
+clutter_actor_has_active_effects (ClutterActor *self)
+{
+  const GList *l;
+
+  if (!self->priv->effects)
+    return FALSE;
+
+  for (l = _clutter_meta_group_peek_metas (self->priv->effects); l; l = l->next)
+    {
+      if (clutter_actor_meta_get_enabled (l->data))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+add_opaque_region_to_occlusion (ClutterActor   *self,
+                                cairo_region_t *occluded_region)
+{
+  cairo_region_t *opaque_region;
+  cairo_rectangle_int_t extents;
+  ClutterActorBox extents_box;
+  graphene_point3d_t verts[4];
+  float scale_x, scale_y;
+  int n_rects, i;
+
+  opaque_region = clutter_actor_get_opaque_region (self);
+  if (!opaque_region)
+    return;
+
+  if (cairo_region_is_empty (opaque_region))
+    goto out;
+
+  cairo_region_get_extents (opaque_region, &extents);
+  extents_box = (ClutterActorBox) {
+    .x1 = extents.x,
+    .y1 = extents.y,
+    .x2 = extents.x + extents.width,
+    .y2 = extents.y + extents.height,
+  };
+
+  if (!_clutter_actor_transform_and_project_box (self, &extents_box, verts))
+    goto out;
+
+  /* Only scales and translations relative to the stage map the
+   * rectangles of the region to rectangles in stage space.
+   */
+  if (!G_APPROX_VALUE (verts[0].y, verts[1].y, OCCLUSION_EPSILON) ||
+      !G_APPROX_VALUE (verts[2].y, verts[3].y, OCCLUSION_EPSILON) ||
+      !G_APPROX_VALUE (verts[0].x, verts[2].x, OCCLUSION_EPSILON) ||
+      !G_APPROX_VALUE (verts[1].x, verts[3].x, OCCLUSION_EPSILON))
+    goto out;
+
+  scale_x = (verts[1].x - verts[0].x) / extents.width;
+  scale_y = (verts[2].y - verts[0].y) / extents.height;
+
+  n_rects = cairo_region_num_rectangles (opaque_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      float x1, y1, x2, y2;
+      int stage_x1, stage_y1, stage_x2, stage_y2;
+
+      cairo_region_get_rectangle (opaque_region, i, &rect);
+
+      x1 = verts[0].x + (rect.x - extents.x) * scale_x;
+      x2 = verts[0].x + (rect.x + rect.width - extents.x) * scale_x;
+      y1 = verts[0].y + (rect.y - extents.y) * scale_y;
+      y2 = verts[0].y + (rect.y + rect.height - extents.y) * scale_y;
+
+      /* Round inwards, partially covered pixels are not opaque */
+      stage_x1 = ceilf (MIN (x1, x2) - OCCLUSION_EPSILON);
+      stage_y1 = ceilf (MIN (y1, y2) - OCCLUSION_EPSILON);
+      stage_x2 = floorf (MAX (x1, x2) + OCCLUSION_EPSILON);
+      stage_y2 = floorf (MAX (y1, y2) + OCCLUSION_EPSILON);
+
+      if (stage_x2 <= stage_x1 || stage_y2 <= stage_y1)
+        continue;
+
+      cairo_region_union_rectangle (occluded_region,
+                                    &(cairo_rectangle_int_t) {
+                                      .x = stage_x1,
+                                      .y = stage_y1,
+                                      .width = stage_x2 - stage_x1,
+                                      .height = stage_y2 - stage_y1,
+                                    });
+    }
+
+out:
+  cairo_region_destroy (opaque_region);
+}
+
+static gboolean
+is_actor_occluded (ClutterActor         *self,
+                   ClutterStage         *stage,
+                   const cairo_region_t *clip_region,
+                   const cairo_region_t *occluded_region)
+{
+  ClutterActorPrivate *priv = self->priv;
+  cairo_rectangle_int_t rect;
+  cairo_region_t *visible_region;
+  ClutterActorBox box;
+  gboolean is_occluded;
+
+  if (!priv->last_paint_volume_valid)
+    return FALSE;
+
+  _clutter_paint_volume_get_stage_paint_box (&priv->last_paint_volume,
+                                             stage,
+                                             &box);
+
+  rect.x = floorf (box.x1);
+  rect.y = floorf (box.y1);
+  rect.width = ceilf (box.x2) - rect.x;
+  rect.height = ceilf (box.y2) - rect.y;
+
+  if (rect.width <= 0 || rect.height <= 0)
+    return FALSE;
+
+  if (cairo_region_contains_rectangle (occluded_region, &rect) ==
+      CAIRO_REGION_OVERLAP_IN)
+    return TRUE;
+
+  if (cairo_region_contains_rectangle (clip_region, &rect) ==
+      CAIRO_REGION_OVERLAP_IN)
+    return FALSE;
+
+  /* Only the part inside the clip is painted, see if that is covered */
+  visible_region = cairo_region_create_rectangle (&rect);
+  cairo_region_intersect (visible_region, clip_region);
+  cairo_region_subtract (visible_region, occluded_region);
+  is_occluded = cairo_region_is_empty (visible_region);
+  cairo_region_destroy (visible_region);
+
+  return is_occluded;
+}
+
+static void
+cull_occluded_recursive (ClutterActor         *self,
+                         ClutterStage         *stage,
+                         const cairo_region_t *clip_region,
+                         cairo_region_t       *occluded_region,
+                         gboolean              can_occlude,
+                         GPtrArray            *occluded_actors)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *child;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  if (priv->inhibit_culling_counter > 0)
+    return;
+
+  if (!cairo_region_is_empty (occluded_region) &&
+      !CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+      is_actor_occluded (self, stage, clip_region, occluded_region))
+    {
+      priv->is_occluded = TRUE;
+      g_ptr_array_add (occluded_actors, g_object_ref (self));
+      return;
+    }
+
+  /* Descendants of actors painted through an offscreen buffer end up
+   * wherever the effect decides, and an offscreen effect may keep reusing
+   * parts of its buffer that are occluded now, so leave them alone.
+   */
+  if (clutter_actor_has_active_effects (self) ||
+      priv->offscreen_redirect & CLUTTER_OFFSCREEN_REDIRECT_ALWAYS)
+    return;
+
+  if (clutter_actor_get_paint_opacity_internal (self) != 255)
+    can_occlude = FALSE;
+
+  /* Clipped children don't paint all of their opaque region */
+  if (priv->has_clip || priv->clip_to_allocation)
+    can_occlude = FALSE;
+
+  for (child = priv->last_child; child; child = child->priv->prev_sibling)
+    {
+      cull_occluded_recursive (child, stage,
+                               clip_region, occluded_region,
+                               can_occlude,
+                               occluded_actors);
+    }
+
+  /* Ancestors paint below their children, so add the actor itself only
+   * once all of its children went through the culling.
+   */
+  if (can_occlude && !CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    add_opaque_region_to_occlusion (self, occluded_region);
+}
+
+/*< private >
+ * clutter_actor_cull_occluded:
+ * @self: a #ClutterActor
+ * @clip_region: the region about to be painted, in stage coordinates
+ * @occluded_actors: array to add the occluded actors to
+ *
+ * Walks the actors from the top to the bottom, collecting the opaque
+ * region of each actor, see clutter_actor_get_opaque_region(). Actors
+ * whose paint box inside @clip_region is fully covered by actors above
+ * them are marked so they are skipped by the following paint, until
+ * clutter_actor_reset_occluded() is called on them.
+ */
+void
+clutter_actor_cull_occluded (ClutterActor         *self,
+                             const cairo_region_t *clip_region,
+                             GPtrArray            *occluded_actors)
+{
+  ClutterActor *stage;
+  cairo_region_t *occluded_region;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CULLING))
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (!stage)
+    return;
+
+  occluded_region = cairo_region_create ();
+  cull_occluded_recursive (self, CLUTTER_STAGE (stage),
+                           clip_region, occluded_region,
+                           TRUE,
+                           occluded_actors);
+  cairo_region_destroy (occluded_region);
+}
+
+void
+clutter_actor_reset_occluded (ClutterActor *self)
+{
+  self->priv->is_occluded = FALSE;
+}
+
 /**
  * clutter_actor_has_effects:
  * @self: A #ClutterActor
@@ -19621,3 +20406,9 @@ clutter_actor_get_redraw_clip (ClutterActor       *self,
 
   return TRUE;
 }
+
+ClutterQueueRedrawEntry *
+clutter_actor_get_queue_redraw_entry (ClutterActor *self)
+{
+  return &self->priv->queue_redraw_entry;
+}
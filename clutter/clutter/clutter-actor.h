@@ -213,6 +213,9 @@ struct _ClutterActor
  * @paint_node: virtual function for creating paint nodes and attaching
  *   them to the render tree
  * @touch_event: signal class closure for #ClutterActor::touch-event
+ * @get_opaque_region: virtual function for sub-classes to advertise the
+ *   part of the actor they paint fully opaque, so that actors below it can
+ *   be skipped. See clutter_actor_get_opaque_region() for details.
  *
  * Base class for actors.
  */
@@ -298,9 +301,11 @@ struct _ClutterActorClass
   float    (* calculate_resource_scale) (ClutterActor *self,
                                          int           phase);
 
+  cairo_region_t * (* get_opaque_region) (ClutterActor *self);
+
   /*< private >*/
   /* padding for future expansion */
-  gpointer _padding_dummy[25];
+  gpointer _padding_dummy[24];
 };
 
 /**
@@ -586,6 +591,11 @@ void                            clutter_actor_set_offscreen_redirect
 CLUTTER_EXPORT
 ClutterOffscreenRedirect        clutter_actor_get_offscreen_redirect            (ClutterActor               *self);
 CLUTTER_EXPORT
+void                            clutter_actor_set_retain_paint_nodes            (ClutterActor               *self,
+                                                                                 gboolean                    retain);
+CLUTTER_EXPORT
+gboolean                        clutter_actor_get_retain_paint_nodes            (ClutterActor               *self);
+CLUTTER_EXPORT
 gboolean                        clutter_actor_should_pick                       (ClutterActor               *self,
                                                                                  ClutterPickContext         *pick_context);
 CLUTTER_EXPORT
@@ -600,6 +610,9 @@ float                           clutter_actor_get_resource_scale
 CLUTTER_EXPORT
 gboolean                        clutter_actor_has_overlaps                      (ClutterActor               *self);
 
+CLUTTER_EXPORT
+cairo_region_t *                clutter_actor_get_opaque_region                 (ClutterActor               *self);
+
 /* Content */
 CLUTTER_EXPORT
 void                            clutter_actor_set_content                       (ClutterActor               *self,
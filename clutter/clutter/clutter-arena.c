@@ -0,0 +1,113 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterArena is a bump allocator for short lived, plain data
+ * allocations that all share the same lifetime, e.g. the data needed
+ * while painting a single frame. Allocations can't be freed
+ * individually; clutter_arena_reset() releases all of them at once,
+ * while keeping the backing memory around for reuse. Pointers handed
+ * out stay valid until the arena is reset.
+ */
+
+#include "clutter-build-config.h"
+
+#include "clutter-arena.h"
+
+#include <string.h>
+
+#define ARENA_ALIGNMENT 16
+
+struct _ClutterArena
+{
+  size_t chunk_size;
+
+  /* Chunks of chunk_size bytes, reused in order after a reset */
+  GPtrArray *chunks;
+  unsigned int current_chunk;
+  size_t offset;
+
+  /* Allocations too large for a chunk, freed on reset */
+  GPtrArray *large_allocations;
+};
+
+ClutterArena *
+clutter_arena_new (size_t chunk_size)
+{
+  ClutterArena *arena;
+
+  g_return_val_if_fail (chunk_size > 0, NULL);
+
+  arena = g_new0 (ClutterArena, 1);
+  arena->chunk_size = chunk_size;
+  arena->chunks = g_ptr_array_new_with_free_func (g_free);
+  arena->large_allocations = g_ptr_array_new_with_free_func (g_free);
+
+  return arena;
+}
+
+void
+clutter_arena_free (ClutterArena *arena)
+{
+  g_ptr_array_free (arena->chunks, TRUE);
+  g_ptr_array_free (arena->large_allocations, TRUE);
+  g_free (arena);
+}
+
+/* Returns size bytes of zero initialized memory, valid until the next
+ * call to clutter_arena_reset() */
+gpointer
+clutter_arena_alloc (ClutterArena *arena,
+                     size_t        size)
+{
+  uint8_t *chunk;
+  gpointer ptr;
+
+  size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+
+  if (size > arena->chunk_size)
+    {
+      ptr = g_malloc0 (size);
+      g_ptr_array_add (arena->large_allocations, ptr);
+      return ptr;
+    }
+
+  if (arena->current_chunk < arena->chunks->len &&
+      arena->offset + size > arena->chunk_size)
+    {
+      arena->current_chunk++;
+      arena->offset = 0;
+    }
+
+  if (arena->current_chunk == arena->chunks->len)
+    g_ptr_array_add (arena->chunks, g_malloc (arena->chunk_size));
+
+  chunk = g_ptr_array_index (arena->chunks, arena->current_chunk);
+  ptr = chunk + arena->offset;
+  arena->offset += size;
+
+  memset (ptr, 0, size);
+
+  return ptr;
+}
+
+void
+clutter_arena_reset (ClutterArena *arena)
+{
+  arena->current_chunk = 0;
+  arena->offset = 0;
+
+  g_ptr_array_set_size (arena->large_allocations, 0);
+}
@@ -0,0 +1,34 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUTTER_ARENA_H
+#define CLUTTER_ARENA_H
+
+#include <glib.h>
+
+typedef struct _ClutterArena ClutterArena;
+
+ClutterArena * clutter_arena_new (size_t chunk_size);
+
+void clutter_arena_free (ClutterArena *arena);
+
+gpointer clutter_arena_alloc (ClutterArena *arena,
+                              size_t        size);
+
+void clutter_arena_reset (ClutterArena *arena);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ClutterArena, clutter_arena_free)
+
+#endif /* CLUTTER_ARENA_H */
@@ -22,6 +22,8 @@
 
 #include <cogl/cogl.h>
 
+#include "clutter-enums.h"
+
 G_BEGIN_DECLS
 
 typedef struct _ClutterBlur ClutterBlur;
@@ -29,6 +31,10 @@ typedef struct _ClutterBlur ClutterBlur;
 ClutterBlur * clutter_blur_new (CoglTexture *texture,
                                 float        sigma);
 
+ClutterBlur * clutter_blur_new_with_mode (CoglTexture     *texture,
+                                          float            sigma,
+                                          ClutterBlurMode  mode);
+
 void clutter_blur_apply (ClutterBlur *blur);
 
 CoglTexture * clutter_blur_get_texture (ClutterBlur *blur);
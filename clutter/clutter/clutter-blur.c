@@ -64,6 +64,17 @@
  *
  * https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch40.html
  *
+ * # Dual Kawase
+ *
+ * With %CLUTTER_BLUR_MODE_DUAL_KAWASE, the gaussian passes are replaced by a
+ * chain of downsampling passes, each halving the size of the contents while
+ * sampling 5 texels, followed by the same number of upsampling passes that
+ * sample 8 texels each. The blur radius grows with the length of the chain,
+ * so large radii cost little more than small ones. The technique is
+ * described in "Bandwidth-Efficient Rendering" by M. Bjørge, SIGGRAPH 2015.
+ *
+ * The textures of the chain are allocated once, when the #ClutterBlur is
+ * created, and are reused every time the blur is applied.
  */
 
 static const char *gaussian_blur_glsl_declarations =
@@ -105,9 +116,44 @@ static const char *gaussian_blur_glsl =
 "                                                                          \n"
 "  cogl_texel = ret / gauss_coefficient_total;                             \n";
 
+static const char *kawase_blur_glsl_declarations =
+"uniform vec2 half_pixel;                                                  \n"
+"uniform float offset;                                                     \n";
+
+static const char *kawase_downsample_glsl =
+"  vec2 uv = vec2 (cogl_tex_coord.st);                                     \n"
+"  vec2 step = half_pixel * offset;                                        \n"
+"                                                                          \n"
+"  vec4 ret = texture2D (cogl_sampler, uv) * 4.0;                          \n"
+"  ret += texture2D (cogl_sampler, uv - step);                             \n"
+"  ret += texture2D (cogl_sampler, uv + step);                             \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x, -step.y));           \n"
+"  ret += texture2D (cogl_sampler, uv - vec2 (step.x, -step.y));           \n"
+"                                                                          \n"
+"  cogl_texel = ret / 8.0;                                                 \n";
+
+static const char *kawase_upsample_glsl =
+"  vec2 uv = vec2 (cogl_tex_coord.st);                                     \n"
+"  vec2 step = half_pixel * offset;                                        \n"
+"                                                                          \n"
+"  vec4 ret = texture2D (cogl_sampler, uv + vec2 (-step.x * 2.0, 0.0));    \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (-step.x, step.y)) * 2.0;     \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (0.0, step.y * 2.0));         \n"
+"  ret += texture2D (cogl_sampler, uv + step) * 2.0;                       \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x * 2.0, 0.0));         \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (step.x, -step.y)) * 2.0;     \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (0.0, -step.y * 2.0));        \n"
+"  ret += texture2D (cogl_sampler, uv - step) * 2.0;                       \n"
+"                                                                          \n"
+"  cogl_texel = ret / 12.0;                                                \n";
+
 #define MIN_DOWNSCALE_SIZE 256.f
 #define MAX_SIGMA 6.f
 
+#define MAX_KAWASE_ITERATIONS 6
+#define MAX_KAWASE_OFFSET 2.f
+#define MIN_KAWASE_LEVEL_SIZE 8
+
 enum
 {
   VERTICAL,
@@ -122,25 +168,43 @@ typedef struct
   int orientation;
 } BlurPass;
 
+/* Level 0 holds the full size result; level n is 1/2^n of the source size
+ * and is where the n-th downsampling pass draws to. The upsampling passes
+ * then walk the chain back, overwriting each level with the upsampled
+ * contents of the level below it.
+ */
+typedef struct
+{
+  CoglFramebuffer *framebuffer;
+  CoglTexture *texture;
+  CoglPipeline *downsample_pipeline;
+  CoglPipeline *upsample_pipeline;
+} KawaseLevel;
+
 struct _ClutterBlur
 {
   CoglTexture *source_texture;
+  ClutterBlurMode mode;
   float sigma;
   float downscale_factor;
 
   BlurPass pass[2];
+
+  KawaseLevel *kawase_levels;
+  int n_kawase_iterations;
+  float kawase_offset;
 };
 
 static CoglPipeline*
-create_blur_pipeline (void)
+create_pipeline (CoglPipelineKey *key,
+                 const char      *declarations,
+                 const char      *source)
 {
-  static CoglPipelineKey blur_pipeline_key = "clutter-blur-pipeline-private";
   CoglContext *ctx =
     clutter_backend_get_cogl_context (clutter_get_default_backend ());
   CoglPipeline *blur_pipeline;
 
-  blur_pipeline =
-    cogl_context_get_named_pipeline (ctx, &blur_pipeline_key);
+  blur_pipeline = cogl_context_get_named_pipeline (ctx, key);
 
   if (G_UNLIKELY (blur_pipeline == NULL))
     {
@@ -157,18 +221,50 @@ create_blur_pipeline (void)
                                          COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
 
       snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
-                                  gaussian_blur_glsl_declarations,
+                                  declarations,
                                   NULL);
-      cogl_snippet_set_replace (snippet, gaussian_blur_glsl);
+      cogl_snippet_set_replace (snippet, source);
       cogl_pipeline_add_layer_snippet (blur_pipeline, 0, snippet);
       cogl_object_unref (snippet);
 
-      cogl_context_set_named_pipeline (ctx, &blur_pipeline_key, blur_pipeline);
+      cogl_context_set_named_pipeline (ctx, key, blur_pipeline);
     }
 
   return cogl_pipeline_copy (blur_pipeline);
 }
 
+static CoglPipeline*
+create_blur_pipeline (void)
+{
+  static CoglPipelineKey blur_pipeline_key = "clutter-blur-pipeline-private";
+
+  return create_pipeline (&blur_pipeline_key,
+                          gaussian_blur_glsl_declarations,
+                          gaussian_blur_glsl);
+}
+
+static CoglPipeline*
+create_kawase_downsample_pipeline (void)
+{
+  static CoglPipelineKey downsample_pipeline_key =
+    "clutter-blur-kawase-downsample-pipeline-private";
+
+  return create_pipeline (&downsample_pipeline_key,
+                          kawase_blur_glsl_declarations,
+                          kawase_downsample_glsl);
+}
+
+static CoglPipeline*
+create_kawase_upsample_pipeline (void)
+{
+  static CoglPipelineKey upsample_pipeline_key =
+    "clutter-blur-kawase-upsample-pipeline-private";
+
+  return create_pipeline (&upsample_pipeline_key,
+                          kawase_blur_glsl_declarations,
+                          kawase_upsample_glsl);
+}
+
 static void
 update_blur_uniforms (ClutterBlur *blur,
                       BlurPass    *pass)
@@ -220,42 +316,32 @@ update_blur_uniforms (ClutterBlur *blur,
 }
 
 static gboolean
-create_fbo (ClutterBlur *blur,
-            BlurPass    *pass)
+create_fbo (float             width,
+            float             height,
+            CoglTexture     **texture,
+            CoglFramebuffer **framebuffer)
 {
   CoglContext *ctx =
     clutter_backend_get_cogl_context (clutter_get_default_backend ());
-  float scaled_height;
-  float scaled_width;
-  float height;
-  float width;
 
-  g_clear_pointer (&pass->texture, cogl_object_unref);
-  g_clear_object (&pass->framebuffer);
-
-  width = cogl_texture_get_width (blur->source_texture);
-  height = cogl_texture_get_height (blur->source_texture);
-  scaled_width = floorf (width / blur->downscale_factor);
-  scaled_height = floorf (height / blur->downscale_factor);
+  g_clear_pointer (texture, cogl_object_unref);
+  g_clear_object (framebuffer);
 
-  pass->texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
-                                                               scaled_width,
-                                                               scaled_height));
-  if (!pass->texture)
+  *texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, width, height));
+  if (!*texture)
     return FALSE;
 
-  pass->framebuffer =
-    COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (pass->texture));
-  if (!pass->framebuffer)
+  *framebuffer = COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (*texture));
+  if (!*framebuffer)
     {
       g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
       return FALSE;
     }
 
-  cogl_framebuffer_orthographic (pass->framebuffer,
+  cogl_framebuffer_orthographic (*framebuffer,
                                  0.0, 0.0,
-                                 scaled_width,
-                                 scaled_height,
+                                 width,
+                                 height,
                                  0.0, 1.0);
   return TRUE;
 }
@@ -266,11 +352,17 @@ setup_blur_pass (ClutterBlur *blur,
                  int          orientation,
                  CoglTexture *texture)
 {
+  float width = cogl_texture_get_width (blur->source_texture);
+  float height = cogl_texture_get_height (blur->source_texture);
+
   pass->orientation = orientation;
   pass->pipeline = create_blur_pipeline ();
   cogl_pipeline_set_layer_texture (pass->pipeline, 0, texture);
 
-  if (!create_fbo (blur, pass))
+  if (!create_fbo (floorf (width / blur->downscale_factor),
+                   floorf (height / blur->downscale_factor),
+                   &pass->texture,
+                   &pass->framebuffer))
     return FALSE;
 
   update_blur_uniforms (blur, pass);
@@ -305,22 +397,164 @@ calculate_downscale_factor (float width,
   return downscale_factor;
 }
 
+static int
+calculate_kawase_iterations (float width,
+                             float height,
+                             float sigma)
+{
+  int n_iterations = 1;
+
+  /* Every iteration doubles the reach of the samples, the offset then
+   * interpolates between iterations. Prefer more iterations over large
+   * offsets, which produce visible artifacts, as long as the smallest level
+   * of the chain doesn't get too small.
+   */
+  while (n_iterations < MAX_KAWASE_ITERATIONS &&
+         sigma / (1 << n_iterations) > MAX_KAWASE_OFFSET &&
+         (int) width >> (n_iterations + 1) >= MIN_KAWASE_LEVEL_SIZE &&
+         (int) height >> (n_iterations + 1) >= MIN_KAWASE_LEVEL_SIZE)
+    n_iterations++;
+
+  return n_iterations;
+}
+
 static void
-apply_blur_pass (BlurPass *pass)
+update_kawase_uniforms (ClutterBlur  *blur,
+                        CoglPipeline *pipeline,
+                        CoglTexture  *target)
+{
+  int half_pixel_uniform;
+  int offset_uniform;
+
+  half_pixel_uniform =
+    cogl_pipeline_get_uniform_location (pipeline, "half_pixel");
+  if (half_pixel_uniform > -1)
+    {
+      float half_pixel[2] = {
+        0.5f / cogl_texture_get_width (target),
+        0.5f / cogl_texture_get_height (target),
+      };
+
+      cogl_pipeline_set_uniform_float (pipeline,
+                                       half_pixel_uniform,
+                                       2, 1,
+                                       half_pixel);
+    }
+
+  offset_uniform = cogl_pipeline_get_uniform_location (pipeline, "offset");
+  if (offset_uniform > -1)
+    {
+      cogl_pipeline_set_uniform_1f (pipeline,
+                                    offset_uniform,
+                                    blur->kawase_offset);
+    }
+}
+
+static gboolean
+setup_kawase_levels (ClutterBlur *blur)
+{
+  float width = cogl_texture_get_width (blur->source_texture);
+  float height = cogl_texture_get_height (blur->source_texture);
+  int n_iterations;
+  int i;
+
+  n_iterations = calculate_kawase_iterations (width, height, blur->sigma);
+
+  blur->n_kawase_iterations = n_iterations;
+  blur->kawase_offset = blur->sigma / (1 << n_iterations);
+  blur->kawase_levels = g_new0 (KawaseLevel, n_iterations + 1);
+
+  for (i = 0; i <= n_iterations; i++)
+    {
+      KawaseLevel *level = &blur->kawase_levels[i];
+
+      if (!create_fbo (MAX (1, (int) width >> i),
+                       MAX (1, (int) height >> i),
+                       &level->texture,
+                       &level->framebuffer))
+        return FALSE;
+    }
+
+  for (i = 0; i <= n_iterations; i++)
+    {
+      KawaseLevel *level = &blur->kawase_levels[i];
+
+      if (i > 0)
+        {
+          CoglTexture *source = i == 1 ? blur->source_texture
+                                       : blur->kawase_levels[i - 1].texture;
+
+          level->downsample_pipeline = create_kawase_downsample_pipeline ();
+          cogl_pipeline_set_layer_texture (level->downsample_pipeline,
+                                           0, source);
+          update_kawase_uniforms (blur,
+                                  level->downsample_pipeline,
+                                  level->texture);
+        }
+
+      if (i < n_iterations)
+        {
+          level->upsample_pipeline = create_kawase_upsample_pipeline ();
+          cogl_pipeline_set_layer_texture (level->upsample_pipeline,
+                                           0,
+                                           blur->kawase_levels[i + 1].texture);
+          update_kawase_uniforms (blur,
+                                  level->upsample_pipeline,
+                                  level->texture);
+        }
+    }
+
+  return TRUE;
+}
+
+static void
+draw_pass (CoglFramebuffer *framebuffer,
+           CoglPipeline    *pipeline,
+           CoglTexture     *texture)
 {
   CoglColor transparent;
 
   cogl_color_init_from_4ub (&transparent, 0, 0, 0, 0);
 
-  cogl_framebuffer_clear (pass->framebuffer,
+  cogl_framebuffer_clear (framebuffer,
                           COGL_BUFFER_BIT_COLOR,
                           &transparent);
 
-  cogl_framebuffer_draw_rectangle (pass->framebuffer,
-                                   pass->pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer,
+                                   pipeline,
                                    0, 0,
-                                   cogl_texture_get_width (pass->texture),
-                                   cogl_texture_get_height (pass->texture));
+                                   cogl_texture_get_width (texture),
+                                   cogl_texture_get_height (texture));
+}
+
+static void
+apply_blur_pass (BlurPass *pass)
+{
+  draw_pass (pass->framebuffer, pass->pipeline, pass->texture);
+}
+
+static void
+apply_kawase_passes (ClutterBlur *blur)
+{
+  int i;
+
+  for (i = 1; i <= blur->n_kawase_iterations; i++)
+    {
+      KawaseLevel *level = &blur->kawase_levels[i];
+
+      draw_pass (level->framebuffer,
+                 level->downsample_pipeline,
+                 level->texture);
+    }
+
+  for (i = blur->n_kawase_iterations - 1; i >= 0; i--)
+    {
+      KawaseLevel *level = &blur->kawase_levels[i];
+
+      draw_pass (level->framebuffer,
+                 level->upsample_pipeline,
+                 level->texture);
+    }
 }
 
 static void
@@ -331,6 +565,27 @@ clear_blur_pass (BlurPass *pass)
   g_clear_object (&pass->framebuffer);
 }
 
+static void
+clear_kawase_levels (ClutterBlur *blur)
+{
+  int i;
+
+  if (!blur->kawase_levels)
+    return;
+
+  for (i = 0; i <= blur->n_kawase_iterations; i++)
+    {
+      KawaseLevel *level = &blur->kawase_levels[i];
+
+      g_clear_pointer (&level->downsample_pipeline, cogl_object_unref);
+      g_clear_pointer (&level->upsample_pipeline, cogl_object_unref);
+      g_clear_pointer (&level->texture, cogl_object_unref);
+      g_clear_object (&level->framebuffer);
+    }
+
+  g_clear_pointer (&blur->kawase_levels, g_free);
+}
+
 /**
  * clutter_blur_new:
  * @texture: a #CoglTexture
@@ -343,6 +598,24 @@ clear_blur_pass (BlurPass *pass)
 ClutterBlur *
 clutter_blur_new (CoglTexture *texture,
                   float        sigma)
+{
+  return clutter_blur_new_with_mode (texture, sigma, CLUTTER_BLUR_MODE_GAUSSIAN);
+}
+
+/**
+ * clutter_blur_new_with_mode:
+ * @texture: a #CoglTexture
+ * @sigma: blur sigma
+ * @mode: the #ClutterBlurMode to blur with
+ *
+ * Creates a new #ClutterBlur using the algorithm given by @mode.
+ *
+ * Returns: (transfer full) (nullable): A newly created #ClutterBlur
+ */
+ClutterBlur *
+clutter_blur_new_with_mode (CoglTexture     *texture,
+                            float            sigma,
+                            ClutterBlurMode  mode)
 {
   ClutterBlur *blur;
   unsigned int height;
@@ -357,6 +630,7 @@ clutter_blur_new (CoglTexture *texture,
   height = cogl_texture_get_height (texture);
 
   blur = g_new0 (ClutterBlur, 1);
+  blur->mode = mode;
   blur->sigma = sigma;
   blur->source_texture = cogl_object_ref (texture);
   blur->downscale_factor = calculate_downscale_factor (width, height, sigma);
@@ -364,6 +638,17 @@ clutter_blur_new (CoglTexture *texture,
   if (G_APPROX_VALUE (sigma, 0.0, FLT_EPSILON))
     goto out;
 
+  if (mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    {
+      if (!setup_kawase_levels (blur))
+        {
+          clutter_blur_free (blur);
+          return NULL;
+        }
+
+      goto out;
+    }
+
   vpass = &blur->pass[VERTICAL];
   hpass = &blur->pass[HORIZONTAL];
 
@@ -391,8 +676,17 @@ clutter_blur_apply (ClutterBlur *blur)
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return;
 
-  apply_blur_pass (&blur->pass[VERTICAL]);
-  apply_blur_pass (&blur->pass[HORIZONTAL]);
+  switch (blur->mode)
+    {
+    case CLUTTER_BLUR_MODE_GAUSSIAN:
+      apply_blur_pass (&blur->pass[VERTICAL]);
+      apply_blur_pass (&blur->pass[HORIZONTAL]);
+      break;
+
+    case CLUTTER_BLUR_MODE_DUAL_KAWASE:
+      apply_kawase_passes (blur);
+      break;
+    }
 }
 
 /**
@@ -409,6 +703,8 @@ clutter_blur_get_texture (ClutterBlur *blur)
 {
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return blur->source_texture;
+  else if (blur->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    return blur->kawase_levels[0].texture;
   else
     return blur->pass[HORIZONTAL].texture;
 }
@@ -426,6 +722,7 @@ clutter_blur_free (ClutterBlur *blur)
 
   clear_blur_pass (&blur->pass[VERTICAL]);
   clear_blur_pass (&blur->pass[HORIZONTAL]);
+  clear_kawase_levels (blur);
   cogl_clear_object (&blur->source_texture);
   g_free (blur);
 }
@@ -1644,6 +1644,22 @@ typedef enum
   CLUTTER_PREEDIT_RESET_COMMIT,
 } ClutterPreeditResetMode;
 
+/**
+ * ClutterBlurMode:
+ * @CLUTTER_BLUR_MODE_GAUSSIAN: A two pass gaussian blur; accurate, but its
+ *   cost grows with the blur radius
+ * @CLUTTER_BLUR_MODE_DUAL_KAWASE: A dual Kawase blur, approximating a
+ *   gaussian blur by repeatedly downsampling and upsampling the contents;
+ *   its cost is mostly independent of the blur radius
+ *
+ * The algorithm used by a #ClutterBlurNode.
+ */
+typedef enum
+{
+  CLUTTER_BLUR_MODE_GAUSSIAN,
+  CLUTTER_BLUR_MODE_DUAL_KAWASE,
+} ClutterBlurMode;
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ENUMS_H__ */
@@ -56,6 +56,9 @@ typedef struct _ClutterEventPrivate {
 
   gpointer platform_data;
 
+  /* Older events of the same device, compressed into this one */
+  GPtrArray *history;
+
   ClutterModifierType button_state;
   ClutterModifierType base_state;
   ClutterModifierType latched_state;
@@ -1310,6 +1313,21 @@ clutter_event_copy (const ClutterEvent *event)
   new_real_event->locked_state = real_event->locked_state;
   new_real_event->tool = real_event->tool;
 
+  if (real_event->history)
+    {
+      unsigned int i;
+
+      new_real_event->history =
+        g_ptr_array_new_full (real_event->history->len,
+                              (GDestroyNotify) clutter_event_free);
+
+      for (i = 0; i < real_event->history->len; i++)
+        {
+          g_ptr_array_add (new_real_event->history,
+                           clutter_event_copy (real_event->history->pdata[i]));
+        }
+    }
+
   switch (event->type)
     {
     case CLUTTER_BUTTON_PRESS:
@@ -1383,6 +1401,7 @@ clutter_event_free (ClutterEvent *event)
 
       g_clear_object (&real_event->device);
       g_clear_object (&real_event->source_device);
+      g_clear_pointer (&real_event->history, g_ptr_array_unref);
 
       switch (event->type)
         {
@@ -2218,3 +2237,83 @@ clutter_event_get_relative_motion (const ClutterEvent *event,
   else
     return FALSE;
 }
+
+/*< private >
+ * _clutter_event_push_history:
+ * @event: a #ClutterEvent
+ * @older_event: (transfer full): an older event of the same device that
+ *   is being compressed into @event
+ *
+ * Records @older_event, along with any history it had, as part of the
+ * history of @event.
+ */
+void
+_clutter_event_push_history (ClutterEvent *event,
+                             ClutterEvent *older_event)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+  ClutterEventPrivate *older_real_event = (ClutterEventPrivate *) older_event;
+  g_autoptr (GPtrArray) older_history = NULL;
+
+  older_history = g_steal_pointer (&older_real_event->history);
+
+  if (!real_event->history)
+    {
+      real_event->history =
+        g_ptr_array_new_with_free_func ((GDestroyNotify) clutter_event_free);
+    }
+
+  if (older_history)
+    {
+      unsigned int i;
+
+      for (i = 0; i < older_history->len; i++)
+        g_ptr_array_add (real_event->history,
+                         g_steal_pointer (&older_history->pdata[i]));
+    }
+
+  g_ptr_array_add (real_event->history, older_event);
+}
+
+/**
+ * clutter_event_get_n_history_events:
+ * @event: a #ClutterEvent
+ *
+ * Retrieves the number of older events that were compressed into
+ * @event. Only motion events of devices with a tool, such as tablets,
+ * keep the events they were compressed from.
+ *
+ * Returns: the number of events in the history of @event
+ */
+unsigned int
+clutter_event_get_n_history_events (const ClutterEvent *event)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+
+  g_return_val_if_fail (event != NULL, 0);
+
+  return real_event->history ? real_event->history->len : 0;
+}
+
+/**
+ * clutter_event_get_history_event:
+ * @event: a #ClutterEvent
+ * @index_: the index of the event, oldest first
+ *
+ * Retrieves an older event that was compressed into @event, see
+ * clutter_event_get_n_history_events().
+ *
+ * Returns: (transfer none): the event at @index_ in the history of @event
+ */
+const ClutterEvent *
+clutter_event_get_history_event (const ClutterEvent *event,
+                                 unsigned int        index_)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+
+  g_return_val_if_fail (event != NULL, NULL);
+  g_return_val_if_fail (real_event->history != NULL, NULL);
+  g_return_val_if_fail (index_ < real_event->history->len, NULL);
+
+  return g_ptr_array_index (real_event->history, index_);
+}
@@ -824,6 +824,12 @@ gboolean                 clutter_event_get_relative_motion (const ClutterEvent *
                                                             double             *dx_unaccel,
                                                             double             *dy_unaccel);
 
+CLUTTER_EXPORT
+unsigned int             clutter_event_get_n_history_events (const ClutterEvent *event);
+CLUTTER_EXPORT
+const ClutterEvent *     clutter_event_get_history_event (const ClutterEvent *event,
+                                                          unsigned int        index_);
+
 
 G_END_DECLS
 
@@ -19,6 +19,7 @@
 
 #include "clutter/clutter-frame-clock.h"
 
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-main.h"
 #include "clutter/clutter-private.h"
@@ -199,6 +200,10 @@ advance_timelines (ClutterFrameClock *frame_clock,
   timelines = g_list_copy (frame_clock->timelines);
   g_list_foreach (timelines, (GFunc) g_object_ref, NULL);
 
+  /* Actors animated by several transitions notify each property once,
+   * after all of them have been advanced */
+  clutter_actor_begin_transition_updates ();
+
   for (l = timelines; l; l = l->next)
     {
       ClutterTimeline *timeline = l->data;
@@ -206,6 +211,8 @@ advance_timelines (ClutterFrameClock *frame_clock,
       _clutter_timeline_do_tick (timeline, time_us / 1000);
     }
 
+  clutter_actor_end_transition_updates ();
+
   g_list_free_full (timelines, g_object_unref);
 }
 
@@ -117,14 +117,14 @@ graphene_size_progress (const GValue *a,
 void
 clutter_graphene_init (void)
 {
-  clutter_interval_register_progress_func (GRAPHENE_TYPE_MATRIX,
-                                           graphene_matrix_progress);
-  clutter_interval_register_progress_func (GRAPHENE_TYPE_POINT,
-                                           graphene_point_progress);
-  clutter_interval_register_progress_func (GRAPHENE_TYPE_POINT3D,
-                                           graphene_point3d_progress);
-  clutter_interval_register_progress_func (GRAPHENE_TYPE_RECT,
-                                           graphene_rect_progress);
-  clutter_interval_register_progress_func (GRAPHENE_TYPE_SIZE,
-                                           graphene_size_progress);
+  _clutter_interval_register_builtin_progress_func (GRAPHENE_TYPE_MATRIX,
+                                                    graphene_matrix_progress);
+  _clutter_interval_register_builtin_progress_func (GRAPHENE_TYPE_POINT,
+                                                    graphene_point_progress);
+  _clutter_interval_register_builtin_progress_func (GRAPHENE_TYPE_POINT3D,
+                                                    graphene_point3d_progress);
+  _clutter_interval_register_builtin_progress_func (GRAPHENE_TYPE_RECT,
+                                                    graphene_rect_progress);
+  _clutter_interval_register_builtin_progress_func (GRAPHENE_TYPE_SIZE,
+                                                    graphene_size_progress);
 }
@@ -207,6 +207,11 @@ clutter_context_get_pango_fontmap (void)
   use_mipmapping = !clutter_disable_mipmap_text;
   cogl_pango_font_map_set_use_mipmapping (font_map, use_mipmapping);
 
+  /* Text of actors painted with a scale, e.g. by the magnifier, the
+   * overview or fractional scaling, stays sharp without rasterizing
+   * a new set of glyphs for every scale */
+  cogl_pango_font_map_set_use_distance_fields (font_map, TRUE);
+
   self->font_map = font_map;
 
   return self->font_map;
@@ -97,6 +97,9 @@ CLUTTER_EXPORT
 void clutter_stage_repick_device (ClutterStage       *stage,
                                   ClutterInputDevice *device);
 
+CLUTTER_EXPORT
+uint64_t clutter_paint_node_get_n_created (void);
+
 CLUTTER_EXPORT
 void clutter_get_debug_flags (ClutterDebugFlag     *debug_flags,
                               ClutterDrawDebugFlag *draw_flags,
@@ -84,6 +84,15 @@
  *
  * In both cases, the "Pipeline" node is created with the return value
  * of #ClutterOffscreenEffectClass.create_pipeline().
+ *
+ * ## Partial updates
+ *
+ * The contents of the offscreen buffer are kept across frames. When the
+ * actor is painted by a stage view with the same on-screen position and
+ * offscreen geometry as the last time, only the part of the offscreen
+ * buffer covered by the redraw clip of the view is redrawn; the redraw
+ * clip already includes any damage the actor and its children queued
+ * since the previous paint.
  */
 
 #include "clutter-build-config.h"
@@ -98,6 +107,7 @@
 #include "clutter-debug.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
+#include "clutter-stage-view.h"
 #include "clutter-paint-context-private.h"
 #include "clutter-paint-node-private.h"
 #include "clutter-paint-nodes.h"
@@ -123,9 +133,25 @@ struct _ClutterOffscreenEffectPrivate
   int target_width;
   int target_height;
 
+  /* The on-screen mapping of the fbo contents, valid when contents_valid is
+     set; used to decide whether only the damaged area needs to be redrawn.
+     The view is a weak pointer, so that a view destroyed by a monitor
+     change can't be mistaken for a new one allocated at the same address */
+  gboolean contents_valid;
+  ClutterStageView *contents_view;
+  graphene_point_t contents_scale;
+  graphene_point_t contents_translation;
+  int contents_offset_x;
+  int contents_offset_y;
+
+  gboolean has_damage;
+  cairo_rectangle_int_t damage;
+
   gulong purge_handler_id;
 };
 
+#define STAGE_MAPPING_EPSILON 0.01f
+
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ClutterOffscreenEffect,
                                      clutter_offscreen_effect,
                                      CLUTTER_TYPE_EFFECT)
@@ -143,6 +169,8 @@ clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
 
   /* clear out the previous state */
   g_clear_object (&priv->offscreen);
+  g_clear_weak_pointer (&priv->contents_view);
+  priv->contents_valid = FALSE;
 
   /* we keep a back pointer here, to avoid going through the ActorMeta */
   priv->actor = clutter_actor_meta_get_actor (meta);
@@ -258,6 +286,7 @@ update_fbo (ClutterEffect *effect,
 
   g_clear_pointer (&priv->texture, cogl_object_unref);
   g_clear_object (&priv->offscreen);
+  priv->contents_valid = FALSE;
 
   priv->texture =
     clutter_offscreen_effect_create_texture (self, target_width, target_height);
@@ -290,6 +319,159 @@ update_fbo (ClutterEffect *effect,
   return TRUE;
 }
 
+static gboolean
+get_stage_mapping (ClutterActor          *actor,
+                   const ClutterActorBox *box,
+                   graphene_point_t      *scale,
+                   graphene_point_t      *translation)
+{
+  graphene_point3d_t vertices[4];
+  graphene_point3d_t point;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      graphene_point3d_init (&point,
+                             i % 2 ? box->x2 : box->x1,
+                             i / 2 ? box->y2 : box->y1,
+                             0.f);
+      clutter_actor_apply_transform_to_point (actor, &point, &vertices[i]);
+    }
+
+  /* Only actors that end up axis aligned on the stage can have their
+   * damage mapped back to the fbo with a simple scale and translation
+   */
+  if (!G_APPROX_VALUE (vertices[0].y, vertices[1].y, STAGE_MAPPING_EPSILON) ||
+      !G_APPROX_VALUE (vertices[2].y, vertices[3].y, STAGE_MAPPING_EPSILON) ||
+      !G_APPROX_VALUE (vertices[0].x, vertices[2].x, STAGE_MAPPING_EPSILON) ||
+      !G_APPROX_VALUE (vertices[1].x, vertices[3].x, STAGE_MAPPING_EPSILON))
+    return FALSE;
+
+  scale->x = (vertices[1].x - vertices[0].x) / (box->x2 - box->x1);
+  scale->y = (vertices[2].y - vertices[0].y) / (box->y2 - box->y1);
+  if (scale->x <= 0.f || scale->y <= 0.f)
+    return FALSE;
+
+  translation->x = vertices[0].x - box->x1 * scale->x;
+  translation->y = vertices[0].y - box->y1 * scale->y;
+
+  return TRUE;
+}
+
+static gboolean
+is_box_inside_view (const graphene_point_t *scale,
+                    const graphene_point_t *translation,
+                    const ClutterActorBox  *box,
+                    ClutterStageView       *view)
+{
+  cairo_rectangle_int_t layout;
+
+  clutter_stage_view_get_layout (view, &layout);
+
+  return (box->x1 * scale->x + translation->x >= layout.x &&
+          box->y1 * scale->y + translation->y >= layout.y &&
+          box->x2 * scale->x + translation->x <= layout.x + layout.width &&
+          box->y2 * scale->y + translation->y <= layout.y + layout.height);
+}
+
+static void
+update_damage (ClutterOffscreenEffect *self,
+               ClutterPaintContext    *paint_context,
+               float                   target_width,
+               float                   target_height,
+               float                   ceiled_resource_scale)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  const cairo_region_t *redraw_clip;
+  cairo_rectangle_int_t clip_extents;
+  graphene_point_t translation;
+  graphene_point_t scale;
+  ClutterStageView *view;
+  ClutterActorBox box;
+  gboolean was_valid;
+  float x1, y1, x2, y2;
+
+  was_valid = priv->contents_valid;
+
+  priv->contents_valid = FALSE;
+  priv->has_damage = FALSE;
+
+  /* Painting for a clone or off-stage (e.g. for a screenshot) doesn't have
+   * a redraw clip we can map to the fbo, redraw everything
+   */
+  view = clutter_paint_context_get_stage_view (paint_context);
+  if (!view || clutter_actor_is_in_clone_paint (priv->actor))
+    return;
+
+  box.x1 = priv->fbo_offset_x;
+  box.y1 = priv->fbo_offset_y;
+  box.x2 = box.x1 + target_width / ceiled_resource_scale;
+  box.y2 = box.y1 + target_height / ceiled_resource_scale;
+
+  if (!get_stage_mapping (priv->actor, &box, &scale, &translation))
+    return;
+
+  /* Damage is only tracked per view; if the actor spans multiple views,
+   * the redraw clip of this one doesn't cover all changes
+   */
+  if (!is_box_inside_view (&scale, &translation, &box, view))
+    return;
+
+  priv->contents_valid = TRUE;
+
+  if (!was_valid ||
+      priv->contents_view != view ||
+      priv->contents_offset_x != priv->fbo_offset_x ||
+      priv->contents_offset_y != priv->fbo_offset_y ||
+      !graphene_point_near (&priv->contents_scale, &scale,
+                            STAGE_MAPPING_EPSILON) ||
+      !graphene_point_near (&priv->contents_translation, &translation,
+                            STAGE_MAPPING_EPSILON))
+    {
+      g_set_weak_pointer (&priv->contents_view, view);
+      priv->contents_offset_x = priv->fbo_offset_x;
+      priv->contents_offset_y = priv->fbo_offset_y;
+      priv->contents_scale = scale;
+      priv->contents_translation = translation;
+      return;
+    }
+
+  redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
+  if (!redraw_clip)
+    return;
+
+  cairo_region_get_extents (redraw_clip, &clip_extents);
+
+  /* Map the clip from stage coordinates to actor coordinates, and from
+   * there into the fbo; pad by a pixel to account for filtering
+   */
+  x1 = (clip_extents.x - translation.x) / scale.x;
+  y1 = (clip_extents.y - translation.y) / scale.y;
+  x2 = (clip_extents.x + clip_extents.width - translation.x) / scale.x;
+  y2 = (clip_extents.y + clip_extents.height - translation.y) / scale.y;
+
+  x1 = floorf ((x1 - priv->fbo_offset_x) * ceiled_resource_scale) - 1;
+  y1 = floorf ((y1 - priv->fbo_offset_y) * ceiled_resource_scale) - 1;
+  x2 = ceilf ((x2 - priv->fbo_offset_x) * ceiled_resource_scale) + 1;
+  y2 = ceilf ((y2 - priv->fbo_offset_y) * ceiled_resource_scale) + 1;
+
+  x1 = CLAMP (x1, 0, target_width);
+  y1 = CLAMP (y1, 0, target_height);
+  x2 = CLAMP (x2, 0, target_width);
+  y2 = CLAMP (y2, 0, target_height);
+
+  if (x1 == 0 && y1 == 0 && x2 == target_width && y2 == target_height)
+    return;
+
+  priv->has_damage = TRUE;
+  priv->damage = (cairo_rectangle_int_t) {
+    .x = x1,
+    .y = y1,
+    .width = x2 - x1,
+    .height = y2 - y1,
+  };
+}
+
 static gboolean
 clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
                                     ClutterPaintNode    *node,
@@ -400,6 +582,10 @@ clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
 
   cogl_framebuffer_set_projection_matrix (offscreen, &projection);
 
+  update_damage (self, paint_context,
+                 target_width, target_height,
+                 ceiled_resource_scale);
+
   return TRUE;
 
 disable_effect:
@@ -522,6 +708,8 @@ clutter_offscreen_effect_paint_node (ClutterEffect           *effect,
   layer_node = clutter_layer_node_new_to_framebuffer (fb, priv->pipeline);
   clutter_paint_node_set_static_name (layer_node,
                                       "ClutterOffscreenEffect (actor offscreen)");
+  if (priv->has_damage)
+    _clutter_layer_node_set_scissor (layer_node, &priv->damage);
   clutter_paint_node_add_child (node, layer_node);
   clutter_paint_node_unref (layer_node);
 
@@ -578,6 +766,7 @@ clutter_offscreen_effect_finalize (GObject *gobject)
   g_clear_object (&priv->offscreen);
   g_clear_pointer (&priv->texture, cogl_object_unref);
   g_clear_pointer (&priv->pipeline, cogl_object_unref);
+  g_clear_weak_pointer (&priv->contents_view);
 
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
 }
@@ -115,6 +115,10 @@ gpointer                _clutter_paint_node_create                      (GType g
 ClutterPaintNode *      _clutter_transform_node_new                     (const graphene_matrix_t     *matrix);
 ClutterPaintNode *      _clutter_dummy_node_new                         (ClutterActor                *actor,
                                                                          CoglFramebuffer             *framebuffer);
+void                    _clutter_dummy_node_set_framebuffer             (ClutterPaintNode            *node,
+                                                                         CoglFramebuffer             *framebuffer);
+void                    _clutter_layer_node_set_scissor                 (ClutterPaintNode            *node,
+                                                                         const cairo_rectangle_int_t *scissor);
 
 void                    _clutter_paint_node_dump_tree                   (ClutterPaintNode            *root);
 
@@ -67,12 +67,15 @@
 #include "clutter-paint-node-private.h"
 
 #include "clutter-debug.h"
+#include "clutter/clutter-mutter.h"
 #include "clutter-private.h"
 
 #include <gobject/gvaluecollector.h>
 
 static inline void      clutter_paint_operation_clear   (ClutterPaintOperation *op);
 
+static uint64_t n_paint_nodes_created = 0;
+
 static void
 value_paint_node_init (GValue *value)
 {
@@ -1255,9 +1258,23 @@ _clutter_paint_node_create (GType gtype)
 {
   g_return_val_if_fail (g_type_is_a (gtype, CLUTTER_TYPE_PAINT_NODE), NULL);
 
+  n_paint_nodes_created++;
+
   return (gpointer) g_type_create_instance (gtype);
 }
 
+/**
+ * clutter_paint_node_get_n_created: (skip)
+ *
+ * Retrieves the number of paint nodes created since startup; used to
+ * measure the paint node churn per frame.
+ */
+uint64_t
+clutter_paint_node_get_n_created (void)
+{
+  return n_paint_nodes_created;
+}
+
 /**
  * clutter_paint_node_get_framebuffer:
  * @node: a #ClutterPaintNode
@@ -362,6 +362,15 @@ _clutter_dummy_node_new (ClutterActor    *actor,
   return res;
 }
 
+void
+_clutter_dummy_node_set_framebuffer (ClutterPaintNode *node,
+                                     CoglFramebuffer  *framebuffer)
+{
+  ClutterDummyNode *dnode = (ClutterDummyNode *) node;
+
+  g_set_object (&dnode->framebuffer, framebuffer);
+}
+
 /*
  * Pipeline node
  */
@@ -1348,7 +1357,10 @@ struct _ClutterLayerNode
 
   guint8 opacity;
 
+  cairo_rectangle_int_t scissor;
+
   gboolean needs_fbo_setup : 1;
+  gboolean has_scissor : 1;
 };
 
 struct _ClutterLayerNodeClass
@@ -1393,6 +1405,18 @@ clutter_layer_node_pre_draw (ClutterPaintNode *node,
 
   clutter_paint_context_push_framebuffer (paint_context, lnode->offscreen);
 
+  /* only the scissored area is cleared and redrawn, the rest of the
+   * offscreen keeps its previous contents
+   */
+  if (lnode->has_scissor)
+    {
+      cogl_framebuffer_push_scissor_clip (lnode->offscreen,
+                                          lnode->scissor.x,
+                                          lnode->scissor.y,
+                                          lnode->scissor.width,
+                                          lnode->scissor.height);
+    }
+
   /* clear out the target framebuffer */
   cogl_framebuffer_clear4f (lnode->offscreen,
                             COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_DEPTH,
@@ -1417,6 +1441,8 @@ clutter_layer_node_post_draw (ClutterPaintNode    *node,
 
   /* switch to the previous framebuffer */
   cogl_framebuffer_pop_matrix (lnode->offscreen);
+  if (lnode->has_scissor)
+    cogl_framebuffer_pop_clip (lnode->offscreen);
   clutter_paint_context_pop_framebuffer (paint_context);
 
   if (!node->operations)
@@ -1642,6 +1668,36 @@ clutter_layer_node_new_to_framebuffer (CoglFramebuffer *framebuffer,
   return (ClutterPaintNode *) res;
 }
 
+/*< private >
+ * _clutter_layer_node_set_scissor:
+ * @node: a #ClutterLayerNode
+ * @scissor: (nullable): the area of the offscreen to redraw, in
+ *   framebuffer coordinates, or %NULL to redraw all of it
+ *
+ * Restricts clearing and drawing into the offscreen of @node to @scissor,
+ * keeping the previous contents of the offscreen everywhere else.
+ */
+void
+_clutter_layer_node_set_scissor (ClutterPaintNode            *node,
+                                 const cairo_rectangle_int_t *scissor)
+{
+  ClutterLayerNode *lnode;
+
+  g_return_if_fail (CLUTTER_IS_LAYER_NODE (node));
+
+  lnode = CLUTTER_LAYER_NODE (node);
+
+  if (scissor)
+    {
+      lnode->scissor = *scissor;
+      lnode->has_scissor = TRUE;
+    }
+  else
+    {
+      lnode->has_scissor = FALSE;
+    }
+}
+
 /*
  * ClutterBlitNode
  */
@@ -1828,16 +1884,131 @@ clutter_blit_node_add_blit_rectangle (ClutterBlitNode *blit_node,
  * ClutterBlurNode
  */
 
+/* Blur nodes are usually recreated on every frame with the same parameters;
+ * keep the offscreen and downsample chain of the last few finalized dual
+ * Kawase nodes around so they can be reused instead of reallocating all
+ * textures every frame. Gaussian nodes only need two textures and are not
+ * cached. The cache is attached to the CoglContext, and is freed together
+ * with it.
+ */
+#define N_CACHED_BLURS 2
+
+typedef struct
+{
+  unsigned int width;
+  unsigned int height;
+  float sigma;
+  ClutterBlurMode mode;
+} BlurCacheKey;
+
+typedef struct
+{
+  BlurCacheKey key;
+  CoglFramebuffer *offscreen;
+  ClutterBlur *blur;
+} BlurCacheEntry;
+
+static CoglUserDataKey blur_cache_key;
+
 struct _ClutterBlurNode
 {
   ClutterLayerNode parent_instance;
 
   ClutterBlur *blur;
   unsigned int sigma;
+
+  BlurCacheKey cache_key;
 };
 
 G_DEFINE_TYPE (ClutterBlurNode, clutter_blur_node, CLUTTER_TYPE_LAYER_NODE)
 
+static void
+blur_cache_entry_free (BlurCacheEntry *entry)
+{
+  g_clear_pointer (&entry->blur, clutter_blur_free);
+  g_clear_object (&entry->offscreen);
+  g_free (entry);
+}
+
+static void
+blur_cache_free (GQueue *blur_cache)
+{
+  g_queue_free_full (blur_cache, (GDestroyNotify) blur_cache_entry_free);
+}
+
+static GQueue *
+blur_cache_get (CoglContext *context,
+                gboolean     create)
+{
+  GQueue *blur_cache;
+
+  blur_cache = cogl_object_get_user_data (COGL_OBJECT (context),
+                                          &blur_cache_key);
+  if (!blur_cache && create)
+    {
+      blur_cache = g_queue_new ();
+      cogl_object_set_user_data (COGL_OBJECT (context),
+                                 &blur_cache_key,
+                                 blur_cache,
+                                 (CoglUserDataDestroyCallback) blur_cache_free);
+    }
+
+  return blur_cache;
+}
+
+static BlurCacheEntry *
+blur_cache_steal (CoglContext        *context,
+                  const BlurCacheKey *key)
+{
+  GQueue *blur_cache;
+  GList *l;
+
+  if (key->mode != CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    return NULL;
+
+  blur_cache = blur_cache_get (context, FALSE);
+  if (!blur_cache)
+    return NULL;
+
+  for (l = blur_cache->head; l; l = l->next)
+    {
+      BlurCacheEntry *entry = l->data;
+
+      if (entry->key.width == key->width &&
+          entry->key.height == key->height &&
+          entry->key.sigma == key->sigma)
+        {
+          g_queue_delete_link (blur_cache, l);
+          return entry;
+        }
+    }
+
+  return NULL;
+}
+
+static void
+blur_cache_add (CoglContext        *context,
+                const BlurCacheKey *key,
+                CoglFramebuffer    *offscreen,
+                ClutterBlur        *blur)
+{
+  BlurCacheEntry *entry;
+  GQueue *blur_cache;
+
+  g_assert (key->mode == CLUTTER_BLUR_MODE_DUAL_KAWASE);
+
+  blur_cache = blur_cache_get (context, TRUE);
+
+  entry = g_new0 (BlurCacheEntry, 1);
+  entry->key = *key;
+  entry->offscreen = offscreen;
+  entry->blur = blur;
+  g_queue_push_head (blur_cache, entry);
+
+  while (blur_cache->length > N_CACHED_BLURS)
+    blur_cache_entry_free (g_queue_pop_tail (blur_cache));
+}
+
 static void
 clutter_blur_node_post_draw (ClutterPaintNode    *node,
                              ClutterPaintContext *paint_context)
@@ -1855,6 +2026,19 @@ static void
 clutter_blur_node_finalize (ClutterPaintNode *node)
 {
   ClutterBlurNode *blur_node = CLUTTER_BLUR_NODE (node);
+  ClutterLayerNode *layer_node = CLUTTER_LAYER_NODE (node);
+
+  if (blur_node->blur && layer_node->offscreen &&
+      blur_node->cache_key.mode == CLUTTER_BLUR_MODE_DUAL_KAWASE)
+    {
+      CoglContext *context =
+        cogl_framebuffer_get_context (layer_node->offscreen);
+
+      blur_cache_add (context,
+                      &blur_node->cache_key,
+                      g_steal_pointer (&layer_node->offscreen),
+                      g_steal_pointer (&blur_node->blur));
+    }
 
   g_clear_pointer (&blur_node->blur, clutter_blur_free);
 
@@ -1874,6 +2058,11 @@ clutter_blur_node_serialize (ClutterPaintNode *node)
   json_builder_begin_object (builder);
   json_builder_set_member_name (builder, "sigma");
   json_builder_add_string_value (builder, src_ptr);
+  json_builder_set_member_name (builder, "mode");
+  json_builder_add_string_value (builder,
+                                 blur_node->cache_key.mode ==
+                                 CLUTTER_BLUR_MODE_DUAL_KAWASE ?
+                                 "dual-kawase" : "gaussian");
   json_builder_end_object (builder);
 
   return json_builder_get_root (builder);
@@ -1913,11 +2102,38 @@ ClutterPaintNode *
 clutter_blur_node_new (unsigned int width,
                        unsigned int height,
                        float        sigma)
+{
+  return clutter_blur_node_new_with_mode (width, height, sigma,
+                                          CLUTTER_BLUR_MODE_GAUSSIAN);
+}
+
+/**
+ * clutter_blur_node_new_with_mode:
+ * @width width of the blur layer
+ * @height: height of the blur layer
+ * @sigma: sigma value of the blur
+ * @mode: the #ClutterBlurMode to blur with
+ *
+ * Creates a new #ClutterBlurNode, like clutter_blur_node_new(), using
+ * the blur algorithm given by @mode.
+ *
+ * %CLUTTER_BLUR_MODE_DUAL_KAWASE trades accuracy for performance, and
+ * should be preferred for large @sigma values.
+ *
+ * Return value: (transfer full): the newly created #ClutterBlurNode.
+ *   Use clutter_paint_node_unref() when done.
+ */
+ClutterPaintNode *
+clutter_blur_node_new_with_mode (unsigned int    width,
+                                 unsigned int    height,
+                                 float           sigma,
+                                 ClutterBlurMode mode)
 {
   g_autoptr (CoglOffscreen) offscreen = NULL;
   g_autoptr (GError) error = NULL;
   ClutterLayerNode *layer_node;
   ClutterBlurNode *blur_node;
+  BlurCacheEntry *cached;
   CoglTexture2D *tex_2d;
   CoglContext *context;
   CoglTexture *texture;
@@ -1927,7 +2143,25 @@ clutter_blur_node_new (unsigned int width,
 
   blur_node = _clutter_paint_node_create (CLUTTER_TYPE_BLUR_NODE);
   blur_node->sigma = sigma;
+  blur_node->cache_key = (BlurCacheKey) {
+    .width = width,
+    .height = height,
+    .sigma = sigma,
+    .mode = mode,
+  };
+
   context = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  cached = blur_cache_steal (context, &blur_node->cache_key);
+  if (cached)
+    {
+      offscreen = COGL_OFFSCREEN (g_steal_pointer (&cached->offscreen));
+      blur = g_steal_pointer (&cached->blur);
+      blur_node->blur = blur;
+      blur_cache_entry_free (cached);
+      goto setup_layer;
+    }
+
   tex_2d = cogl_texture_2d_new_with_size (context, width, height);
 
   texture = COGL_TEXTURE (tex_2d);
@@ -1942,7 +2176,7 @@ clutter_blur_node_new (unsigned int width,
       goto out;
     }
 
-  blur = clutter_blur_new (texture, sigma);
+  blur = clutter_blur_new_with_mode (texture, sigma, mode);
   blur_node->blur = blur;
 
   if (!blur)
@@ -1951,6 +2185,7 @@ clutter_blur_node_new (unsigned int width,
       goto out;
     }
 
+setup_layer:
   layer_node = CLUTTER_LAYER_NODE (blur_node);
   layer_node->offscreen = COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
   layer_node->pipeline = cogl_pipeline_copy (default_texture_pipeline);
@@ -284,6 +284,12 @@ ClutterPaintNode * clutter_blur_node_new (unsigned int width,
                                           unsigned int height,
                                           float        sigma);
 
+CLUTTER_EXPORT
+ClutterPaintNode * clutter_blur_node_new_with_mode (unsigned int    width,
+                                                    unsigned int    height,
+                                                    float           sigma,
+                                                    ClutterBlurMode mode);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_PAINT_NODES_H__ */
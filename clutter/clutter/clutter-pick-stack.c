@@ -62,8 +62,18 @@ project_vertices (CoglMatrixEntry       *matrix_entry,
                   graphene_point3d_t     vertices[4])
 {
   graphene_matrix_t m;
+  float tx, ty;
   int i;
 
+  if (cogl_matrix_entry_is_2d_translation (matrix_entry, &tx, &ty))
+    {
+      graphene_point3d_init (&vertices[0], box->x1 + tx, box->y1 + ty, 0.f);
+      graphene_point3d_init (&vertices[1], box->x2 + tx, box->y1 + ty, 0.f);
+      graphene_point3d_init (&vertices[2], box->x2 + tx, box->y2 + ty, 0.f);
+      graphene_point3d_init (&vertices[3], box->x1 + tx, box->y2 + ty, 0.f);
+      return;
+    }
+
   cogl_matrix_entry_get (matrix_entry, &m);
 
   graphene_point3d_init (&vertices[0], box->x1, box->y1, 0.f);
@@ -54,7 +54,8 @@ typedef struct _ClutterMainContext      ClutterMainContext;
 }
 
 #define CLUTTER_REGISTER_INTERVAL_PROGRESS(func)                      { \
-  clutter_interval_register_progress_func (g_define_type_id, func);     \
+  _clutter_interval_register_builtin_progress_func (g_define_type_id,   \
+                                                    func);              \
 }
 
 #define CLUTTER_PRIVATE_FLAGS(a)	 (((ClutterActor *) (a))->private_flags)
@@ -253,6 +254,9 @@ typedef enum _ClutterCullResult
 } ClutterCullResult;
 
 gboolean        _clutter_has_progress_function  (GType gtype);
+gboolean        _clutter_has_custom_progress_function (GType gtype);
+void            _clutter_interval_register_builtin_progress_func (GType               value_type,
+                                                                  ClutterProgressFunc func);
 gboolean        _clutter_run_progress_function  (GType gtype,
                                                  const GValue *initial,
                                                  const GValue *final,
@@ -34,6 +34,7 @@
 
 #include "clutter-property-transition.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-animatable.h"
 #include "clutter-debug.h"
 #include "clutter-interval.h"
@@ -45,6 +46,10 @@ struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* The value type of pspec if it can be interpolated and set without
+   * going through GValues, G_TYPE_INVALID otherwise */
+  GType typed_value_type;
 };
 
 enum
@@ -92,6 +97,32 @@ clutter_property_transition_ensure_interval (ClutterPropertyTransition *transiti
     }
 }
 
+static GType
+clutter_property_transition_get_typed_value_type (ClutterAnimatable *animatable,
+                                                  GParamSpec        *pspec)
+{
+  GType value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
+
+  if (!CLUTTER_IS_ACTOR (animatable) ||
+      !clutter_actor_can_set_transition_value (CLUTTER_ACTOR (animatable),
+                                               pspec))
+    return G_TYPE_INVALID;
+
+  if (value_type != G_TYPE_FLOAT &&
+      value_type != G_TYPE_DOUBLE &&
+      value_type != GRAPHENE_TYPE_POINT &&
+      value_type != GRAPHENE_TYPE_SIZE &&
+      value_type != CLUTTER_TYPE_COLOR)
+    return G_TYPE_INVALID;
+
+  /* The typed path interpolates the same way as ClutterInterval and the
+   * progress functions Clutter registers, but not as replacements */
+  if (_clutter_has_custom_progress_function (value_type))
+    return G_TYPE_INVALID;
+
+  return value_type;
+}
+
 static void
 clutter_property_transition_attached (ClutterTransition *transition,
                                       ClutterAnimatable *animatable)
@@ -109,6 +140,10 @@ clutter_property_transition_attached (ClutterTransition *transition,
   if (priv->pspec == NULL)
     return;
 
+  priv->typed_value_type =
+    clutter_property_transition_get_typed_value_type (animatable,
+                                                      priv->pspec);
+
   interval = clutter_transition_get_interval (transition);
   if (interval == NULL)
     return;
@@ -124,6 +159,97 @@ clutter_property_transition_detached (ClutterTransition *transition,
   ClutterPropertyTransitionPrivate *priv = self->priv;
 
   priv->pspec = NULL; 
+  priv->typed_value_type = G_TYPE_INVALID;
+}
+
+static void
+clutter_property_transition_set_final_state (ClutterPropertyTransition *transition,
+                                             ClutterAnimatable         *animatable,
+                                             const GValue              *value)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+
+  /* Properties of ClutterActor itself are set directly */
+  if (CLUTTER_IS_ACTOR (animatable) &&
+      clutter_actor_set_transition_value (CLUTTER_ACTOR (animatable),
+                                          priv->pspec,
+                                          value))
+    return;
+
+  clutter_animatable_set_final_state (animatable,
+                                      priv->property_name,
+                                      value);
+}
+
+/* Interpolates and sets the most commonly animated value types without
+ * boxing them in GValues. Returns FALSE if the generic path must be used */
+static gboolean
+clutter_property_transition_compute_typed_value (ClutterPropertyTransition *transition,
+                                                 ClutterActor              *actor,
+                                                 ClutterInterval           *interval,
+                                                 double                     progress)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+  const GValue *initial = clutter_interval_peek_initial_value (interval);
+  const GValue *final = clutter_interval_peek_final_value (interval);
+  gboolean res;
+
+  if (priv->typed_value_type == G_TYPE_FLOAT)
+    {
+      double a = g_value_get_float (initial);
+      double b = g_value_get_float (final);
+
+      res = clutter_actor_set_transition_float (actor, priv->pspec,
+                                                (progress * (b - a)) + a);
+    }
+  else if (priv->typed_value_type == G_TYPE_DOUBLE)
+    {
+      double a = g_value_get_double (initial);
+      double b = g_value_get_double (final);
+
+      res = clutter_actor_set_transition_double (actor, priv->pspec,
+                                                 (progress * (b - a)) + a);
+    }
+  else if (priv->typed_value_type == GRAPHENE_TYPE_POINT)
+    {
+      graphene_point_t point;
+
+      graphene_point_interpolate (g_value_get_boxed (initial),
+                                  g_value_get_boxed (final),
+                                  progress,
+                                  &point);
+      res = clutter_actor_set_transition_point (actor, priv->pspec, &point);
+    }
+  else if (priv->typed_value_type == GRAPHENE_TYPE_SIZE)
+    {
+      graphene_size_t size;
+
+      graphene_size_interpolate (g_value_get_boxed (initial),
+                                 g_value_get_boxed (final),
+                                 progress,
+                                 &size);
+      res = clutter_actor_set_transition_size (actor, priv->pspec, &size);
+    }
+  else if (priv->typed_value_type == CLUTTER_TYPE_COLOR)
+    {
+      ClutterColor color;
+
+      clutter_color_interpolate (clutter_value_get_color (initial),
+                                 clutter_value_get_color (final),
+                                 progress,
+                                 &color);
+      res = clutter_actor_set_transition_color (actor, priv->pspec, &color);
+    }
+  else
+    {
+      res = FALSE;
+    }
+
+  /* Don't try again for properties without a direct setter */
+  if (!res)
+    priv->typed_value_type = G_TYPE_INVALID;
+
+  return res;
 }
 
 static void
@@ -147,6 +273,17 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
+  /* Intervals subclassing ClutterInterval might compute values
+   * differently */
+  if (priv->typed_value_type != G_TYPE_INVALID &&
+      i_type == p_type &&
+      G_OBJECT_TYPE (interval) == CLUTTER_TYPE_INTERVAL &&
+      clutter_property_transition_compute_typed_value (self,
+                                                       CLUTTER_ACTOR (animatable),
+                                                       interval,
+                                                       progress))
+    return;
+
   g_value_init (&value, i_type);
 
   res = clutter_animatable_interpolate_value (animatable,
@@ -157,34 +294,29 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   if (res)
     {
-      if (i_type != p_type || g_type_is_a (i_type, p_type))
+      if (i_type == p_type)
+        clutter_property_transition_set_final_state (self, animatable, &value);
+      else if (g_value_type_transformable (i_type, p_type))
         {
-          if (g_value_type_transformable (i_type, p_type))
+          GValue transform = G_VALUE_INIT;
+
+          g_value_init (&transform, p_type);
+
+          if (g_value_transform (&value, &transform))
             {
-              GValue transform = G_VALUE_INIT;
-
-              g_value_init (&transform, p_type);
-
-              if (g_value_transform (&value, &transform))
-                {
-                  clutter_animatable_set_final_state (animatable,
-                                                      priv->property_name,
-                                                      &transform);
-                }
-              else
-                g_warning ("%s: Unable to convert a value of type '%s' from "
-                           "the value type '%s' of the interval.",
-                           G_STRLOC,
-                           g_type_name (p_type),
-                           g_type_name (i_type));
-
-              g_value_unset (&transform);
+              clutter_property_transition_set_final_state (self,
+                                                           animatable,
+                                                           &transform);
             }
+          else
+            g_warning ("%s: Unable to convert a value of type '%s' from "
+                       "the value type '%s' of the interval.",
+                       G_STRLOC,
+                       g_type_name (p_type),
+                       g_type_name (i_type));
+
+          g_value_unset (&transform);
         }
-      else
-        clutter_animatable_set_final_state (animatable,
-                                            priv->property_name,
-                                            &value);
     }
 
   g_value_unset (&value);
@@ -98,6 +98,8 @@ void clutter_stage_queue_actor_redraw (ClutterStage             *stage,
 void clutter_stage_dequeue_actor_redraw (ClutterStage *stage,
                                          ClutterActor *actor);
 
+void clutter_stage_invalidate_devices (ClutterStage *stage);
+
 void            _clutter_stage_add_pointer_drag_actor    (ClutterStage       *stage,
                                                           ClutterInputDevice *device,
                                                           ClutterActor       *actor);
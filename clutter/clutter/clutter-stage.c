@@ -53,6 +53,7 @@
 #include "deprecated/clutter-container.h"
 
 #include "clutter-actor-private.h"
+#include "clutter-arena.h"
 #include "clutter-backend-private.h"
 #include "clutter-cairo.h"
 #include "clutter-container.h"
@@ -78,11 +79,14 @@
 
 #define MAX_FRUSTA 64
 
-typedef struct _QueueRedrawEntry
-{
-  gboolean has_clip;
-  ClutterPaintVolume clip;
-} QueueRedrawEntry;
+#define PAINT_VOLUME_ARENA_CHUNK_SIZE (64 * sizeof (ClutterPaintVolume))
+
+/* Time spent per idle callback loading GPU programs ahead of time */
+#define WARM_UP_PROGRAMS_BUDGET_US 2000
+
+/* Delay before saving the list of GPU programs used in this session after
+ * a frame was painted, which may have used new programs */
+#define SAVE_PROGRAMS_DELAY_S 10
 
 typedef struct _PickRecord
 {
@@ -123,10 +127,15 @@ struct _ClutterStagePrivate
 
   GQueue *event_queue;
 
-  GArray *paint_volume_stack;
+  /* paint volumes handed out until the next stage paint */
+  ClutterArena *paint_volume_arena;
 
   GSList *pending_relayouts;
-  GHashTable *pending_queue_redraws;
+  GQueue pending_queue_redraws;
+
+  /* bumped whenever the projection or viewport changes, invalidating
+   * the stage space bounds cached in ClutterQueueRedrawEntry */
+  unsigned int projection_serial;
 
   int update_freeze_count;
 
@@ -136,10 +145,14 @@ struct _ClutterStagePrivate
   GHashTable *pointer_devices;
   GHashTable *touch_sequences;
 
+  guint warm_up_programs_id;
+
   guint throttle_motion_events : 1;
   guint min_size_changed       : 1;
   guint motion_events_enabled  : 1;
   guint actor_needs_immediate_relayout : 1;
+  guint programs_warmed_up : 1;
+  guint programs_warm_up_done : 1;
 };
 
 enum
@@ -174,7 +187,6 @@ static guint stage_signals[LAST_SIGNAL] = { 0, };
 
 static const ClutterColor default_stage_color = { 255, 255, 255, 255 };
 
-static void free_queue_redraw_entry (QueueRedrawEntry *entry);
 static void free_pointer_device_entry (PointerDeviceEntry *entry);
 static void clutter_stage_update_view_perspective (ClutterStage *stage);
 static void clutter_stage_set_viewport (ClutterStage *stage,
@@ -448,7 +460,9 @@ clutter_stage_do_paint_view (ClutterStage         *stage,
   ClutterPaintContext *paint_context;
   cairo_rectangle_int_t clip_rect;
   g_autoptr (GArray) clip_frusta = NULL;
+  g_autoptr (GPtrArray) occluded_actors = NULL;
   graphene_frustum_t clip_frustum;
+  cairo_region_t *cull_region;
   int n_rectangles;
 
   n_rectangles = redraw_clip ? cairo_region_num_rectangles (redraw_clip) : 0;
@@ -483,6 +497,23 @@ clutter_stage_do_paint_view (ClutterStage         *stage,
 
   _clutter_stage_paint_volume_stack_free_all (stage);
 
+  /* Skip actors that are hidden behind opaque actors painted above them */
+  if (redraw_clip)
+    {
+      cull_region = cairo_region_copy (redraw_clip);
+    }
+  else
+    {
+      clutter_stage_view_get_layout (view, &clip_rect);
+      cull_region = cairo_region_create_rectangle (&clip_rect);
+    }
+
+  occluded_actors = g_ptr_array_new_with_free_func (g_object_unref);
+  clutter_actor_cull_occluded (CLUTTER_ACTOR (stage),
+                               cull_region,
+                               occluded_actors);
+  cairo_region_destroy (cull_region);
+
   paint_context = clutter_paint_context_new_for_view (view,
                                                       redraw_clip,
                                                       clip_frusta,
@@ -490,6 +521,10 @@ clutter_stage_do_paint_view (ClutterStage         *stage,
 
   clutter_actor_paint (CLUTTER_ACTOR (stage), paint_context);
   clutter_paint_context_destroy (paint_context);
+
+  g_ptr_array_foreach (occluded_actors,
+                       (GFunc) clutter_actor_reset_occluded,
+                       NULL);
 }
 
 /* This provides a common point of entry for painting the scenegraph
@@ -528,11 +563,64 @@ clutter_stage_emit_before_paint (ClutterStage     *stage,
   g_signal_emit (stage, stage_signals[BEFORE_PAINT], 0, view);
 }
 
+static gboolean
+warm_up_programs_idle (gpointer user_data)
+{
+  ClutterStage *stage = CLUTTER_STAGE (user_data);
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (backend);
+
+  if (cogl_context_warm_up_programs (cogl_context,
+                                     WARM_UP_PROGRAMS_BUDGET_US))
+    return G_SOURCE_CONTINUE;
+
+  stage->priv->warm_up_programs_id = 0;
+  stage->priv->programs_warm_up_done = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+save_programs_timeout (gpointer user_data)
+{
+  ClutterStage *stage = CLUTTER_STAGE (user_data);
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (backend);
+
+  cogl_context_save_program_list (cogl_context);
+
+  stage->priv->warm_up_programs_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
 void
 clutter_stage_emit_after_paint (ClutterStage     *stage,
                                 ClutterStageView *view)
 {
+  ClutterStagePrivate *priv = stage->priv;
+
   g_signal_emit (stage, stage_signals[AFTER_PAINT], 0, view);
+
+  /* Load the programs used in previous sessions once the first frame is
+   * out, so they are ready by the time the pipelines are first used.
+   * Afterwards, painting may have used new programs; save the list of
+   * programs a while later, so that the next session warms them up too.
+   */
+  if (!priv->programs_warmed_up)
+    {
+      priv->programs_warmed_up = TRUE;
+      priv->warm_up_programs_id =
+        clutter_threads_add_idle_full (G_PRIORITY_LOW,
+                                       warm_up_programs_idle,
+                                       stage, NULL);
+    }
+  else if (priv->programs_warm_up_done && !priv->warm_up_programs_id)
+    {
+      priv->warm_up_programs_id =
+        clutter_threads_add_timeout_full (G_PRIORITY_LOW,
+                                          SAVE_PROGRAMS_DELAY_S * 1000,
+                                          save_programs_timeout,
+                                          stage, NULL);
+    }
 }
 
 void
@@ -644,6 +732,21 @@ clutter_stage_real_deactivate (ClutterStage *stage)
   clutter_stage_emit_key_focus_event (stage, FALSE);
 }
 
+static gboolean
+is_smooth_scroll (const ClutterEvent *event)
+{
+  return (event->type == CLUTTER_SCROLL &&
+          event->scroll.direction == CLUTTER_SCROLL_SMOOTH);
+}
+
+static gboolean
+is_compressible_event (const ClutterEvent *event)
+{
+  return (event->type == CLUTTER_MOTION ||
+          event->type == CLUTTER_TOUCH_UPDATE ||
+          is_smooth_scroll (event));
+}
+
 void
 _clutter_stage_queue_event (ClutterStage *stage,
                             ClutterEvent *event,
@@ -663,10 +766,7 @@ _clutter_stage_queue_event (ClutterStage *stage,
 
   if (first_event)
     {
-      gboolean compressible = event->type == CLUTTER_MOTION ||
-                              event->type == CLUTTER_TOUCH_UPDATE;
-
-      if (!compressible)
+      if (!is_compressible_event (event))
         {
           _clutter_process_event (event);
           clutter_event_free (event);
@@ -718,11 +818,84 @@ clutter_stage_compress_motion (ClutterStage       *stage,
   event->motion.dy_unaccel = dy_unaccel + dst_dy_unaccel;
 }
 
+static void
+clutter_stage_compress_scroll (ClutterStage       *stage,
+                               ClutterEvent       *event,
+                               const ClutterEvent *to_discard)
+{
+  double dx, dy;
+  double dst_dx, dst_dy;
+
+  clutter_event_get_scroll_delta (to_discard, &dx, &dy);
+  clutter_event_get_scroll_delta (event, &dst_dx, &dst_dy);
+
+  clutter_event_set_scroll_delta (event, dx + dst_dx, dy + dst_dy);
+}
+
+static gpointer
+get_compression_key (const ClutterEvent *event)
+{
+  switch (event->type)
+    {
+    case CLUTTER_TOUCH_BEGIN:
+    case CLUTTER_TOUCH_UPDATE:
+    case CLUTTER_TOUCH_END:
+    case CLUTTER_TOUCH_CANCEL:
+      if (event->touch.sequence)
+        return event->touch.sequence;
+      break;
+    default:
+      break;
+    }
+
+  return clutter_event_get_device (event);
+}
+
+/*
+ * Returns whether @event can be folded into @next_event, the next queued
+ * event with the same compression key. Since no other event of the same
+ * device or touch sequence, and no event that can't be compressed, sits
+ * between the two, dropping @event does not reorder anything that
+ * matters to the receivers.
+ */
+static gboolean
+can_compress_event (const ClutterEvent *event,
+                    const ClutterEvent *next_event)
+{
+  switch (event->type)
+    {
+    case CLUTTER_MOTION:
+      return (next_event->type == CLUTTER_MOTION ||
+              next_event->type == CLUTTER_LEAVE);
+
+    case CLUTTER_TOUCH_UPDATE:
+      return (next_event->type == CLUTTER_TOUCH_UPDATE &&
+              event->touch.sequence == next_event->touch.sequence);
+
+    case CLUTTER_SCROLL:
+      return (is_smooth_scroll (event) &&
+              is_smooth_scroll (next_event) &&
+              clutter_event_get_scroll_finish_flags (event) ==
+              CLUTTER_SCROLL_FINISHED_NONE &&
+              clutter_event_get_scroll_source (event) ==
+              clutter_event_get_scroll_source (next_event) &&
+              clutter_event_get_state (event) ==
+              clutter_event_get_state (next_event));
+
+    default:
+      return FALSE;
+    }
+}
+
 void
 _clutter_stage_process_queued_events (ClutterStage *stage)
 {
   ClutterStagePrivate *priv;
-  GList *events, *l;
+  g_autoptr (GHashTable) last_events = NULL;
+  g_autofree ClutterEvent **events = NULL;
+  g_autofree int *next_events = NULL;
+  int n_events;
+  int i;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
@@ -736,71 +909,84 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 
   /* Steal events before starting processing to avoid reentrancy
    * issues */
-  events = priv->event_queue->head;
-  priv->event_queue->head =  NULL;
-  priv->event_queue->tail = NULL;
-  priv->event_queue->length = 0;
+  n_events = priv->event_queue->length;
+  events = g_new (ClutterEvent *, n_events);
+  next_events = g_new (int, n_events);
+
+  for (i = 0; i < n_events; i++)
+    events[i] = g_queue_pop_head (priv->event_queue);
+
+  /* Link every event to the next queued event of the same device (or
+   * touch sequence), so compression is not limited to events that
+   * happen to be adjacent in the queue when several devices are active
+   * at once. Events that can't be compressed themselves (key presses,
+   * button presses, crossings...) act as barriers: nothing is folded
+   * across them, so that e.g. a motion queued before a key press is
+   * still delivered before it.
+   */
+  last_events = g_hash_table_new (NULL, NULL);
 
-  for (l = events; l != NULL; l = l->next)
+  for (i = n_events - 1; i >= 0; i--)
     {
-      ClutterEvent *event;
-      ClutterEvent *next_event;
-      ClutterInputDevice *device;
-      ClutterInputDevice *next_device;
-      gboolean check_device = FALSE;
+      gpointer key = get_compression_key (events[i]);
+      gpointer next_index;
 
-      event = l->data;
-      next_event = l->next ? l->next->data : NULL;
+      if (g_hash_table_lookup_extended (last_events, key, NULL, &next_index))
+        next_events[i] = GPOINTER_TO_INT (next_index);
+      else
+        next_events[i] = -1;
 
-      device = clutter_event_get_device (event);
+      if (!is_compressible_event (events[i]))
+        g_hash_table_remove_all (last_events);
 
-      if (next_event != NULL)
-        next_device = clutter_event_get_device (next_event);
-      else
-        next_device = NULL;
+      g_hash_table_insert (last_events, key, GINT_TO_POINTER (i));
+    }
 
-      if (device != NULL && next_device != NULL)
-        check_device = TRUE;
+  for (i = 0; i < n_events; i++)
+    {
+      ClutterEvent *event = events[i];
+      ClutterEvent *next_event;
 
-      /* Skip consecutive motion events coming from the same device. */
-      if (priv->throttle_motion_events && next_event != NULL)
-        {
-          if (event->type == CLUTTER_MOTION &&
-              (next_event->type == CLUTTER_MOTION ||
-               next_event->type == CLUTTER_LEAVE) &&
-              (!check_device || (device == next_device)))
-            {
-              CLUTTER_NOTE (EVENT,
-                            "Omitting motion event at %d, %d",
-                            (int) event->motion.x,
-                            (int) event->motion.y);
+      next_event = next_events[i] >= 0 ? events[next_events[i]] : NULL;
 
-              if (next_event->type == CLUTTER_MOTION)
-                clutter_stage_compress_motion (stage, next_event, event);
+      /* Fold events into the next one from the same device, so that at
+       * most one motion (and thus one pick) per device happens each frame.
+       */
+      if (priv->throttle_motion_events && next_event != NULL &&
+          can_compress_event (event, next_event))
+        {
+          CLUTTER_NOTE (EVENT, "Omitting %s event",
+                        event->type == CLUTTER_MOTION ? "motion" :
+                        event->type == CLUTTER_TOUCH_UPDATE ? "touch update" :
+                        "scroll");
 
-              goto next_event;
+          if (event->type == CLUTTER_SCROLL)
+            {
+              clutter_stage_compress_scroll (stage, next_event, event);
             }
-          else if (event->type == CLUTTER_TOUCH_UPDATE &&
-                   next_event->type == CLUTTER_TOUCH_UPDATE &&
-                   event->touch.sequence == next_event->touch.sequence &&
-                   (!check_device || (device == next_device)))
+          else if (event->type == CLUTTER_MOTION &&
+                   next_event->type == CLUTTER_MOTION)
             {
-              CLUTTER_NOTE (EVENT,
-                            "Omitting touch update event at %d, %d",
-                            (int) event->touch.x,
-                            (int) event->touch.y);
-              goto next_event;
+              clutter_stage_compress_motion (stage, next_event, event);
+
+              /* Tools like tablet styluses want every sample, not only
+               * the latest one, so keep what got compressed around.
+               */
+              if (clutter_event_get_device_tool (event))
+                {
+                  _clutter_event_push_history (next_event, event);
+                  continue;
+                }
             }
+
+          clutter_event_free (event);
+          continue;
         }
 
       _clutter_process_event (event);
-
-    next_event:
       clutter_event_free (event);
     }
 
-  g_list_free (events);
-
   g_object_unref (stage);
 }
 
@@ -889,6 +1075,12 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
     priv->needs_update_devices = TRUE;
 }
 
+void
+clutter_stage_invalidate_devices (ClutterStage *stage)
+{
+  stage->priv->needs_update_devices = TRUE;
+}
+
 GSList *
 clutter_stage_find_updated_devices (ClutterStage *stage)
 {
@@ -1261,7 +1453,12 @@ clutter_stage_dispose (GObject *object)
 
   clutter_actor_destroy_all_children (CLUTTER_ACTOR (object));
 
-  g_hash_table_remove_all (priv->pending_queue_redraws);
+  while (priv->pending_queue_redraws.head)
+    {
+      ClutterActor *actor = priv->pending_queue_redraws.head->data;
+
+      clutter_stage_dequeue_actor_redraw (CLUTTER_STAGE (object), actor);
+    }
 
   g_slist_free_full (priv->pending_relayouts,
                      (GDestroyNotify) g_object_unref);
@@ -1274,6 +1471,8 @@ clutter_stage_dispose (GObject *object)
   g_hash_table_remove_all (priv->pointer_devices);
   g_hash_table_remove_all (priv->touch_sequences);
 
+  g_clear_handle_id (&priv->warm_up_programs_id, g_source_remove);
+
   G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
 }
 
@@ -1291,7 +1490,7 @@ clutter_stage_finalize (GObject *object)
 
   g_free (priv->title);
 
-  g_array_free (priv->paint_volume_stack, TRUE);
+  clutter_arena_free (priv->paint_volume_arena);
 
   G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
 }
@@ -1655,13 +1854,10 @@ clutter_stage_init (ClutterStage *self)
 
   clutter_stage_set_viewport (self, geom.width, geom.height);
 
-  priv->pending_queue_redraws =
-    g_hash_table_new_full (NULL, NULL,
-                           g_object_unref,
-                           (GDestroyNotify) free_queue_redraw_entry);
+  priv->projection_serial = 1;
 
-  priv->paint_volume_stack =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintVolume));
+  priv->paint_volume_arena =
+    clutter_arena_new (PAINT_VOLUME_ARENA_CHUNK_SIZE);
 }
 
 static void
@@ -1730,6 +1926,18 @@ _clutter_stage_get_projection_matrix (ClutterStage      *stage,
   *projection = stage->priv->projection;
 }
 
+static void
+bump_projection_serial (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  /* 0 is never valid, so cached bounds can be invalidated by resetting
+   * their serial */
+  priv->projection_serial++;
+  if (priv->projection_serial == 0)
+    priv->projection_serial = 1;
+}
+
 /* This simply provides a simple mechanism for us to ensure that
  * the projection matrix gets re-asserted before painting.
  *
@@ -1744,6 +1952,8 @@ _clutter_stage_dirty_projection (ClutterStage *stage)
 
   priv = stage->priv;
 
+  bump_projection_serial (stage);
+
   for (l = _clutter_stage_window_get_views (priv->impl); l; l = l->next)
     {
       ClutterStageView *view = l->data;
@@ -1835,6 +2045,8 @@ _clutter_stage_dirty_viewport (ClutterStage *stage)
 
   priv = stage->priv;
 
+  bump_projection_serial (stage);
+
   for (l = _clutter_stage_window_get_views (priv->impl); l; l = l->next)
     {
       ClutterStageView *view = l->data;
@@ -2647,30 +2859,15 @@ clutter_stage_schedule_update (ClutterStage *stage)
 ClutterPaintVolume *
 _clutter_stage_paint_volume_stack_allocate (ClutterStage *stage)
 {
-  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
-
-  g_array_set_size (paint_volume_stack,
-                    paint_volume_stack->len+1);
-
-  return &g_array_index (paint_volume_stack,
-                         ClutterPaintVolume,
-                         paint_volume_stack->len - 1);
+  return clutter_arena_alloc (stage->priv->paint_volume_arena,
+                              sizeof (ClutterPaintVolume));
 }
 
 void
 _clutter_stage_paint_volume_stack_free_all (ClutterStage *stage)
 {
-  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
-  int i;
-
-  for (i = 0; i < paint_volume_stack->len; i++)
-    {
-      ClutterPaintVolume *pv =
-        &g_array_index (paint_volume_stack, ClutterPaintVolume, i);
-      clutter_paint_volume_free (pv);
-    }
-
-  g_array_set_size (paint_volume_stack, 0);
+  /* The volumes are all static, so there is nothing to free per volume */
+  clutter_arena_reset (stage->priv->paint_volume_arena);
 }
 
 /* When an actor queues a redraw we add it to a list on the stage that
@@ -2690,7 +2887,7 @@ clutter_stage_queue_actor_redraw (ClutterStage             *stage,
                                   const ClutterPaintVolume *clip)
 {
   ClutterStagePrivate *priv = stage->priv;
-  QueueRedrawEntry *entry = NULL;
+  ClutterQueueRedrawEntry *entry;
 
   CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
                 _clutter_actor_get_debug_name (actor), clip);
@@ -2709,13 +2906,13 @@ clutter_stage_queue_actor_redraw (ClutterStage             *stage,
       priv->pending_finish_queue_redraws = TRUE;
     }
 
-  entry = g_hash_table_lookup (priv->pending_queue_redraws, actor);
+  entry = clutter_actor_get_queue_redraw_entry (actor);
 
-  if (entry)
+  if (entry->queued)
     {
       /* Ignore all requests to queue a redraw for an actor if a full
        * (non-clipped) redraw of the actor has already been queued. */
-      if (!entry->has_clip)
+      if (!entry->clip)
         {
           CLUTTER_NOTE (CLIPPING, "Bail from stage_queue_actor_redraw (%s): "
                         "Unclipped redraw of actor already queued",
@@ -2727,70 +2924,71 @@ clutter_stage_queue_actor_redraw (ClutterStage             *stage,
        * previously been queued for this actor then combine the latest
        * clip together with the existing clip */
       if (clip)
-        clutter_paint_volume_union (&entry->clip, clip);
+        clutter_paint_volume_union (entry->clip, clip);
       else
-        {
-          clutter_paint_volume_free (&entry->clip);
-          entry->has_clip = FALSE;
-        }
+        g_clear_pointer (&entry->clip, clutter_paint_volume_free);
     }
   else
     {
-      entry = g_new0 (QueueRedrawEntry, 1);
-
       if (clip)
-        {
-          entry->has_clip = TRUE;
-          _clutter_paint_volume_init_static (&entry->clip, actor);
-          _clutter_paint_volume_set_from_volume (&entry->clip, clip);
-        }
-      else
-        entry->has_clip = FALSE;
+        entry->clip = clutter_paint_volume_copy (clip);
 
-      g_hash_table_insert (priv->pending_queue_redraws,
-                           g_object_ref (actor), entry);
+      entry->queued = TRUE;
+      g_object_ref (actor);
+      g_queue_push_tail_link (&priv->pending_queue_redraws, &entry->link);
     }
 }
 
-static void
-free_queue_redraw_entry (QueueRedrawEntry *entry)
-{
-  if (entry->has_clip)
-    clutter_paint_volume_free (&entry->clip);
-  g_free (entry);
-}
-
 void
 clutter_stage_dequeue_actor_redraw (ClutterStage *self,
                                     ClutterActor *actor)
 {
-  g_hash_table_remove (self->priv->pending_queue_redraws, actor);
+  ClutterQueueRedrawEntry *entry;
+
+  entry = clutter_actor_get_queue_redraw_entry (actor);
+  if (!entry->queued)
+    return;
+
+  g_queue_unlink (&self->priv->pending_queue_redraws, &entry->link);
+  g_clear_pointer (&entry->clip, clutter_paint_volume_free);
+  entry->queued = FALSE;
+
+  g_object_unref (actor);
 }
 
 static void
-add_to_stage_clip (ClutterStage       *stage,
-                   ClutterPaintVolume *redraw_clip)
+add_box_to_clip_rects (const ClutterActorBox       *bounding_box,
+                       const cairo_rectangle_int_t *geom,
+                       GArray                      *clip_rects)
 {
-  ClutterStageWindow *stage_window;
-  ClutterActorBox bounding_box;
   ClutterActorBox intersection_box;
-  cairo_rectangle_int_t geom, stage_clip;
+  cairo_rectangle_int_t stage_clip;
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (CLUTTER_ACTOR (stage)))
-    return;
+  intersection_box.x1 = MAX (bounding_box->x1, 0);
+  intersection_box.y1 = MAX (bounding_box->y1, 0);
+  intersection_box.x2 = MIN (bounding_box->x2, geom->width);
+  intersection_box.y2 = MIN (bounding_box->y2, geom->height);
 
-  stage_window = _clutter_stage_get_window (stage);
-  if (stage_window == NULL)
+  /* There is no need to track degenerate/empty redraw clips */
+  if (intersection_box.x2 <= intersection_box.x1 ||
+      intersection_box.y2 <= intersection_box.y1)
     return;
 
-  if (is_full_stage_redraw_queued (stage))
-    return;
+  stage_clip.x = intersection_box.x1;
+  stage_clip.y = intersection_box.y1;
+  stage_clip.width = intersection_box.x2 - stage_clip.x;
+  stage_clip.height = intersection_box.y2 - stage_clip.y;
 
-  if (redraw_clip == NULL)
-    {
-      clutter_stage_add_redraw_clip (stage, NULL);
-      return;
-    }
+  g_array_append_val (clip_rects, stage_clip);
+}
+
+static void
+add_volume_to_clip_rects (ClutterStage                *stage,
+                          ClutterPaintVolume          *redraw_clip,
+                          const cairo_rectangle_int_t *geom,
+                          GArray                      *clip_rects)
+{
+  ClutterActorBox bounding_box;
 
   if (redraw_clip->is_empty)
     return;
@@ -2802,32 +3000,72 @@ add_to_stage_clip (ClutterStage       *stage,
                                              stage,
                                              &bounding_box);
 
-  _clutter_stage_window_get_geometry (stage_window, &geom);
+  add_box_to_clip_rects (&bounding_box, geom, clip_rects);
+}
 
-  intersection_box.x1 = MAX (bounding_box.x1, 0);
-  intersection_box.y1 = MAX (bounding_box.y1, 0);
-  intersection_box.x2 = MIN (bounding_box.x2, geom.width);
-  intersection_box.y2 = MIN (bounding_box.y2, geom.height);
+static gboolean
+add_actor_to_clip_rects (ClutterStage                *stage,
+                         ClutterActor                *actor,
+                         ClutterQueueRedrawEntry     *entry,
+                         ClutterPaintVolume          *clip,
+                         const cairo_rectangle_int_t *geom,
+                         GArray                      *clip_rects)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterPaintVolume old_actor_pv, new_actor_pv;
 
-  /* There is no need to track degenerate/empty redraw clips */
-  if (intersection_box.x2 <= intersection_box.x1 ||
-      intersection_box.y2 <= intersection_box.y1)
-    return;
+  if (clip)
+    {
+      add_volume_to_clip_rects (stage, clip, geom, clip_rects);
+      return TRUE;
+    }
 
-  stage_clip.x = intersection_box.x1;
-  stage_clip.y = intersection_box.y1;
-  stage_clip.width = intersection_box.x2 - stage_clip.x;
-  stage_clip.height = intersection_box.y2 - stage_clip.y;
+  _clutter_paint_volume_init_static (&old_actor_pv, NULL);
+  _clutter_paint_volume_init_static (&new_actor_pv, NULL);
+
+  /* If there's no clip we can use, we have to trigger an unclipped full
+   * stage redraw.
+   */
+  if (!clutter_actor_get_redraw_clip (actor, &old_actor_pv, &new_actor_pv))
+    return FALSE;
+
+  /* Add both the old paint volume of the actor (which is currently
+   * visible on the screen) and the new paint volume (which will be
+   * visible on the screen after this redraw) to the redraw clip.
+   * The former we do to ensure the old texture on the screen will be
+   * fully painted over in case the actor was moved.
+   *
+   * The old paint volume only changes when the actor is moved or
+   * resized, so its projection is cached across frames.
+   */
+  if (!old_actor_pv.is_empty)
+    {
+      if (entry->last_paint_box_serial != priv->projection_serial)
+        {
+          _clutter_paint_volume_get_stage_paint_box (&old_actor_pv,
+                                                     stage,
+                                                     &entry->last_paint_box);
+          entry->last_paint_box_serial = priv->projection_serial;
+        }
 
-  clutter_stage_add_redraw_clip (stage, &stage_clip);
+      add_box_to_clip_rects (&entry->last_paint_box, geom, clip_rects);
+    }
+
+  add_volume_to_clip_rects (stage, &new_actor_pv, geom, clip_rects);
+
+  return TRUE;
 }
 
 void
 clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage)
 {
   ClutterStagePrivate *priv = stage->priv;
-  GHashTableIter iter;
-  gpointer key, value;
+  ClutterStageWindow *stage_window;
+  g_autoptr (GArray) clip_rects = NULL;
+  cairo_rectangle_int_t geom = { 0 };
+  gboolean track_clip;
+  gboolean needs_full_redraw;
+  GList *link;
 
   COGL_TRACE_BEGIN_SCOPED (ClutterStageFinishQueueRedraws, "FinishQueueRedraws");
 
@@ -2836,57 +3074,70 @@ clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage)
 
   priv->pending_finish_queue_redraws = FALSE;
 
-  g_hash_table_iter_init (&iter, priv->pending_queue_redraws);
-  while (g_hash_table_iter_next (&iter, &key, &value))
-    {
-      ClutterActor *redraw_actor = key;
-      QueueRedrawEntry *entry = value;
+  stage_window = _clutter_stage_get_window (stage);
+  track_clip = (!CLUTTER_ACTOR_IN_DESTRUCTION (CLUTTER_ACTOR (stage)) &&
+                stage_window != NULL);
+  if (track_clip)
+    _clutter_stage_window_get_geometry (stage_window, &geom);
 
-      g_hash_table_iter_steal (&iter);
+  needs_full_redraw = is_full_stage_redraw_queued (stage);
+  clip_rects = g_array_new (FALSE, FALSE, sizeof (cairo_rectangle_int_t));
 
-      if (clutter_actor_is_mapped (redraw_actor))
-        {
-          ClutterPaintVolume old_actor_pv, new_actor_pv;
+  /* get_paint_volume() vfuncs might queue redraws, which get appended to
+   * the end of the list, so keep going until it is empty.
+   */
+  while ((link = g_queue_pop_head_link (&priv->pending_queue_redraws)))
+    {
+      ClutterActor *redraw_actor = link->data;
+      ClutterQueueRedrawEntry *entry =
+        clutter_actor_get_queue_redraw_entry (redraw_actor);
+      g_autoptr (ClutterPaintVolume) clip = NULL;
 
-          _clutter_paint_volume_init_static (&old_actor_pv, NULL);
-          _clutter_paint_volume_init_static (&new_actor_pv, NULL);
+      clip = g_steal_pointer (&entry->clip);
+      entry->queued = FALSE;
 
-          if (entry->has_clip)
-            {
-              add_to_stage_clip (stage, &entry->clip);
-            }
-          else if (clutter_actor_get_redraw_clip (redraw_actor,
-                                                  &old_actor_pv,
-                                                  &new_actor_pv))
-            {
-              /* Add both the old paint volume of the actor (which is
-               * currently visible on the screen) and the new paint volume
-               * (which will be visible on the screen after this redraw)
-               * to the redraw clip.
-               * The former we do to ensure the old texture on the screen
-               * will be fully painted over in case the actor was moved.
-               */
-              add_to_stage_clip (stage, &old_actor_pv);
-              add_to_stage_clip (stage, &new_actor_pv);
-            }
-          else
-            {
-              /* If there's no clip we can use, we have to trigger an
-               * unclipped full stage redraw.
-               */
-              add_to_stage_clip (stage, NULL);
-            }
+      if (track_clip &&
+          !needs_full_redraw &&
+          clutter_actor_is_mapped (redraw_actor))
+        {
+          needs_full_redraw = !add_actor_to_clip_rects (stage,
+                                                        redraw_actor,
+                                                        entry,
+                                                        clip,
+                                                        &geom,
+                                                        clip_rects);
         }
 
       g_object_unref (redraw_actor);
-      free_queue_redraw_entry (entry);
+    }
+
+  if (!track_clip)
+    return;
+
+  if (needs_full_redraw)
+    {
+      clutter_stage_add_redraw_clip (stage, NULL);
+    }
+  else if (clip_rects->len > 0)
+    {
+      cairo_region_t *region;
+      int n_rects, i;
 
-      /* get_paint_volume() vfuncs might queue redraws and can cause our
-       * iterator to now be invalidated. So start over. This isn't wasting
-       * any time since we already stole (removed) the elements previously
-       * visited.
+      /* Merge overlapping clips, e.g. the old and new bounds of moved
+       * actors, before distributing them to the views.
        */
-      g_hash_table_iter_init (&iter, priv->pending_queue_redraws);
+      region =
+        cairo_region_create_rectangles ((cairo_rectangle_int_t *) clip_rects->data,
+                                        clip_rects->len);
+      n_rects = cairo_region_num_rectangles (region);
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (region, i, &rect);
+          clutter_stage_add_redraw_clip (stage, &rect);
+        }
+      cairo_region_destroy (region);
     }
 }
 
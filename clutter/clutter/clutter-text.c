@@ -97,6 +97,40 @@ struct _LayoutCache
   guint age;
 };
 
+/* Layouts of non-editable texts are shared between all ClutterText actors
+ * showing the same text with the same font, font options, resolution,
+ * attributes and size, so that
+ * the shaping and the glyph display list are only computed once; this
+ * is the process-wide, least recently used cache backing LayoutCache.
+ */
+#define N_SHARED_LAYOUTS        256
+
+typedef struct _SharedLayout    SharedLayout;
+
+struct _SharedLayout
+{
+  /* Key */
+  PangoFontDescription *font_desc;
+  cairo_font_options_t *font_options;
+  double resolution;
+  char *text;
+  PangoAttrList *attrs;
+  PangoDirection base_dir;
+  PangoAlignment alignment;
+  PangoWrapMode wrap_mode;
+  PangoEllipsizeMode ellipsize;
+  int width;
+  int height;
+  gboolean justify;
+  gboolean single_line_mode;
+
+  PangoLayout *layout;
+  GList link;
+};
+
+static GHashTable *shared_layouts = NULL;
+static GQueue shared_layouts_lru = G_QUEUE_INIT;
+
 struct _ClutterTextInputFocus
 {
   ClutterInputFocus parent_instance;
@@ -211,6 +245,7 @@ struct _ClutterTextPrivate
   guint paint_volume_valid      : 1;
   guint show_password_hint      : 1;
   guint password_hint_visible   : 1;
+  guint layout_exposed          : 1;
   guint resolved_direction      : 4;
 };
 
@@ -717,6 +752,68 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static PangoDirection
+clutter_text_resolve_direction (ClutterText *text,
+                                const char  *contents,
+                                gsize        contents_len)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoDirection pango_dir;
+
+  if (priv->password_char != 0)
+    pango_dir = PANGO_DIRECTION_NEUTRAL;
+  else
+    pango_dir = _clutter_pango_find_base_dir (contents, contents_len);
+
+  if (pango_dir == PANGO_DIRECTION_NEUTRAL)
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+      ClutterTextDirection text_dir;
+
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        {
+          ClutterSeat *seat;
+          ClutterKeymap *keymap;
+
+          seat = clutter_backend_get_default_seat (backend);
+          keymap = clutter_seat_get_keymap (seat);
+          pango_dir = clutter_keymap_get_direction (keymap);
+        }
+      else
+        {
+          text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+
+          if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
+            pango_dir = PANGO_DIRECTION_RTL;
+          else
+            pango_dir = PANGO_DIRECTION_LTR;
+        }
+    }
+
+  priv->resolved_direction = pango_dir;
+
+  return pango_dir;
+}
+
+static void
+clutter_text_set_layout_properties (ClutterText        *text,
+                                    PangoLayout        *layout,
+                                    int                 width,
+                                    int                 height,
+                                    PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  pango_layout_set_alignment (layout, priv->alignment);
+  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
+  pango_layout_set_justify (layout, priv->justify);
+  pango_layout_set_wrap (layout, priv->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, ellipsize);
+  pango_layout_set_width (layout, width);
+  pango_layout_set_height (layout, height);
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -765,40 +862,9 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
     {
       PangoDirection pango_dir;
 
-      if (priv->password_char != 0)
-        pango_dir = PANGO_DIRECTION_NEUTRAL;
-      else
-        pango_dir = _clutter_pango_find_base_dir (contents, contents_len);
-
-      if (pango_dir == PANGO_DIRECTION_NEUTRAL)
-        {
-          ClutterBackend *backend = clutter_get_default_backend ();
-          ClutterTextDirection text_dir;
-
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            {
-              ClutterSeat *seat;
-              ClutterKeymap *keymap;
-
-              seat = clutter_backend_get_default_seat (backend);
-              keymap = clutter_seat_get_keymap (seat);
-              pango_dir = clutter_keymap_get_direction (keymap);
-            }
-          else
-            {
-              text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
-
-              if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
-                pango_dir = PANGO_DIRECTION_RTL;
-              else
-                pango_dir = PANGO_DIRECTION_LTR;
-           }
-        }
-
+      pango_dir = clutter_text_resolve_direction (text, contents, contents_len);
       pango_context_set_base_dir (clutter_actor_get_pango_context (CLUTTER_ACTOR (text)), pango_dir);
 
-      priv->resolved_direction = pango_dir;
-
       pango_layout_set_text (layout, contents, contents_len);
     }
 
@@ -809,20 +875,226 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   if (priv->effective_attrs != NULL)
     pango_layout_set_attributes (layout, priv->effective_attrs);
 
-  pango_layout_set_alignment (layout, priv->alignment);
-  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
-  pango_layout_set_justify (layout, priv->justify);
-  pango_layout_set_wrap (layout, priv->wrap_mode);
-
-  pango_layout_set_ellipsize (layout, ellipsize);
-  pango_layout_set_width (layout, width);
-  pango_layout_set_height (layout, height);
+  clutter_text_set_layout_properties (text, layout, width, height, ellipsize);
 
   g_free (contents);
 
   return layout;
 }
 
+static guint
+shared_layout_hash (gconstpointer data)
+{
+  const SharedLayout *shared = data;
+  guint hash;
+
+  hash = g_str_hash (shared->text);
+  hash = hash * 31 + pango_font_description_hash (shared->font_desc);
+  if (shared->font_options != NULL)
+    hash = hash * 31 + cairo_font_options_hash (shared->font_options);
+  hash = hash * 31 + (guint) shared->resolution;
+  hash = hash * 31 + shared->width;
+  hash = hash * 31 + shared->height;
+  hash = hash * 31 + (shared->base_dir << 8 | shared->ellipsize);
+
+  return hash;
+}
+
+static gboolean
+shared_layout_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const SharedLayout *shared_a = a;
+  const SharedLayout *shared_b = b;
+
+  if (shared_a->width != shared_b->width ||
+      shared_a->height != shared_b->height ||
+      shared_a->base_dir != shared_b->base_dir ||
+      shared_a->alignment != shared_b->alignment ||
+      shared_a->wrap_mode != shared_b->wrap_mode ||
+      shared_a->ellipsize != shared_b->ellipsize ||
+      shared_a->justify != shared_b->justify ||
+      shared_a->single_line_mode != shared_b->single_line_mode ||
+      shared_a->resolution != shared_b->resolution)
+    return FALSE;
+
+  if (shared_a->font_options == NULL || shared_b->font_options == NULL)
+    {
+      if (shared_a->font_options != shared_b->font_options)
+        return FALSE;
+    }
+  else if (!cairo_font_options_equal (shared_a->font_options,
+                                      shared_b->font_options))
+    {
+      return FALSE;
+    }
+
+  if (g_strcmp0 (shared_a->text, shared_b->text) != 0)
+    return FALSE;
+
+  if (!pango_font_description_equal (shared_a->font_desc,
+                                     shared_b->font_desc))
+    return FALSE;
+
+  if (shared_a->attrs == NULL || shared_b->attrs == NULL)
+    return shared_a->attrs == shared_b->attrs;
+
+  return pango_attr_list_equal (shared_a->attrs, shared_b->attrs);
+}
+
+static void
+shared_layout_free (SharedLayout *shared)
+{
+  g_queue_unlink (&shared_layouts_lru, &shared->link);
+
+  g_clear_object (&shared->layout);
+  g_clear_pointer (&shared->attrs, pango_attr_list_unref);
+  g_clear_pointer (&shared->font_desc, pango_font_description_free);
+  g_clear_pointer (&shared->font_options, cairo_font_options_destroy);
+  g_free (shared->text);
+  g_free (shared);
+}
+
+static void
+clear_shared_layouts (ClutterBackend *backend)
+{
+  g_hash_table_remove_all (shared_layouts);
+}
+
+static void
+ensure_shared_layouts (void)
+{
+  ClutterBackend *backend;
+
+  if (G_LIKELY (shared_layouts != NULL))
+    return;
+
+  shared_layouts = g_hash_table_new_full (shared_layout_hash,
+                                          shared_layout_equal,
+                                          NULL,
+                                          (GDestroyNotify) shared_layout_free);
+
+  /* Shared layouts have their own PangoContext, created with the current
+   * backend settings; drop them all when these change
+   */
+  backend = clutter_get_default_backend ();
+  g_signal_connect (backend, "resolution-changed",
+                    G_CALLBACK (clear_shared_layouts), NULL);
+  g_signal_connect (backend, "font-changed",
+                    G_CALLBACK (clear_shared_layouts), NULL);
+}
+
+static gboolean
+clutter_text_can_share_layout (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  return !priv->editable &&
+         priv->password_char == 0 &&
+         !priv->layout_exposed;
+}
+
+/*
+ * clutter_text_get_shared_layout:
+ * @text: a #ClutterText
+ * @width: the width of the layout, in Pango units
+ * @height: the height of the layout, in Pango units
+ * @ellipsize: the ellipsization mode of the layout
+ *
+ * Like clutter_text_create_layout_no_cache(), but returns a layout that
+ * is shared with any other #ClutterText showing the same contents, only
+ * creating and shaping a new one if there is none.
+ *
+ * Return value: (transfer full): a #PangoLayout; it must not be modified
+ */
+static PangoLayout *
+clutter_text_get_shared_layout (ClutterText        *text,
+                                int                 width,
+                                int                 height,
+                                PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  g_autofree char *contents = NULL;
+  PangoContext *text_context;
+  PangoContext *context;
+  SharedLayout *shared;
+  SharedLayout key;
+  gsize contents_len;
+
+  ensure_shared_layouts ();
+
+  contents = clutter_text_get_display_text (text);
+  contents_len = strlen (contents);
+
+  clutter_text_ensure_effective_attributes (text);
+
+  text_context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
+
+  key = (SharedLayout) {
+    .font_desc = priv->font_desc,
+    .font_options =
+      (cairo_font_options_t *) pango_cairo_context_get_font_options (text_context),
+    .resolution = pango_cairo_context_get_resolution (text_context),
+    .text = contents,
+    .attrs = priv->effective_attrs,
+    .base_dir = clutter_text_resolve_direction (text, contents, contents_len),
+    .alignment = priv->alignment,
+    .wrap_mode = priv->wrap_mode,
+    .ellipsize = ellipsize,
+    .width = width,
+    .height = height,
+    .justify = priv->justify,
+    .single_line_mode = priv->single_line_mode,
+  };
+
+  shared = g_hash_table_lookup (shared_layouts, &key);
+  if (shared)
+    {
+      g_queue_unlink (&shared_layouts_lru, &shared->link);
+      g_queue_push_head_link (&shared_layouts_lru, &shared->link);
+
+      return g_object_ref (shared->layout);
+    }
+
+  context = clutter_actor_create_pango_context (CLUTTER_ACTOR (text));
+  pango_cairo_context_set_font_options (context, key.font_options);
+  pango_cairo_context_set_resolution (context, key.resolution);
+  pango_context_set_base_dir (context, key.base_dir);
+
+  shared = g_new0 (SharedLayout, 1);
+  *shared = key;
+  shared->font_desc = pango_font_description_copy (priv->font_desc);
+  shared->font_options = key.font_options != NULL
+                       ? cairo_font_options_copy (key.font_options)
+                       : NULL;
+  shared->text = g_steal_pointer (&contents);
+  shared->attrs = priv->effective_attrs != NULL
+                ? pango_attr_list_copy (priv->effective_attrs)
+                : NULL;
+  shared->link.data = shared;
+
+  shared->layout = pango_layout_new (context);
+  g_object_unref (context);
+
+  pango_layout_set_font_description (shared->layout, shared->font_desc);
+  pango_layout_set_text (shared->layout, shared->text, contents_len);
+  if (shared->attrs != NULL)
+    pango_layout_set_attributes (shared->layout, shared->attrs);
+
+  clutter_text_set_layout_properties (text, shared->layout,
+                                      width, height, ellipsize);
+
+  cogl_pango_ensure_glyph_cache_for_layout (shared->layout);
+
+  g_queue_push_head_link (&shared_layouts_lru, &shared->link);
+  g_hash_table_add (shared_layouts, shared);
+
+  while (shared_layouts_lru.length > N_SHARED_LAYOUTS)
+    g_hash_table_remove (shared_layouts, shared_layouts_lru.tail->data);
+
+  return g_object_ref (shared->layout);
+}
+
 static void
 clutter_text_dirty_cache (ClutterText *text)
 {
@@ -1100,10 +1372,18 @@ clutter_text_create_layout (ClutterText *text,
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  if (clutter_text_can_share_layout (text))
+    {
+      oldest_cache->layout =
+        clutter_text_get_shared_layout (text, width, height, ellipsize);
+    }
+  else
+    {
+      oldest_cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
 
-  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+      cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+    }
 
   /* Mark the 'time' this cache was created and advance the time */
   oldest_cache->age = priv->cache_age++;
@@ -1140,6 +1420,31 @@ maybe_create_text_layout_with_resource_scale (ClutterText *text,
                                         resource_scale);
 }
 
+/*
+ * clutter_text_peek_layout:
+ * @self: a #ClutterText
+ *
+ * Like clutter_text_get_layout(), but the returned layout may be shared
+ * with other #ClutterText actors, so it must not be modified.
+ */
+static PangoLayout *
+clutter_text_peek_layout (ClutterText *self)
+{
+  PangoLayout *layout;
+  gfloat width, height;
+
+  if (self->priv->editable && self->priv->single_line_mode)
+    return clutter_text_create_layout (self, -1, -1);
+
+  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
+  layout = maybe_create_text_layout_with_resource_scale (self, width, height);
+
+  if (!layout)
+    layout = clutter_text_create_layout (self, width, height);
+
+  return layout;
+}
+
 /**
  * clutter_text_coords_to_position:
  * @self: a #ClutterText
@@ -1172,7 +1477,7 @@ clutter_text_coords_to_position (ClutterText *self,
   px = logical_pixels_to_pango (x - self->priv->text_logical_x, resource_scale);
   py = logical_pixels_to_pango (y - self->priv->text_logical_y, resource_scale);
 
-  pango_layout_xy_to_index (clutter_text_get_layout (self),
+  pango_layout_xy_to_index (clutter_text_peek_layout (self),
                             px, py,
                             &index_, &trailing);
 
@@ -1244,7 +1549,7 @@ clutter_text_position_to_coords_internal (ClutterText *self,
       g_string_free (tmp, TRUE);
     }
 
-  pango_layout_get_cursor_pos (clutter_text_get_layout (self),
+  pango_layout_get_cursor_pos (clutter_text_peek_layout (self),
                                index_,
                                &rect, NULL);
 
@@ -1818,7 +2123,7 @@ clutter_text_foreach_selection_rectangle (ClutterText              *self,
                                           gpointer                  user_data)
 {
   ClutterTextPrivate *priv = self->priv;
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_peek_layout (self);
   gchar *utf8 = clutter_text_get_display_text (self);
   gint lines;
   gint start_index;
@@ -1917,7 +2222,7 @@ paint_selection_rectangle (ClutterText           *self,
   ClutterActor *actor = CLUTTER_ACTOR (self);
   guint8 paint_opacity = clutter_actor_get_paint_opacity (actor);
   CoglPipeline *color_pipeline = cogl_pipeline_copy (default_color_pipeline);
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_peek_layout (self);
   CoglColor cogl_color = { 0, };
   const ClutterColor *color;
 
@@ -2017,7 +2322,7 @@ clutter_text_move_word_backward (ClutterText *self,
 
   if (clutter_text_buffer_get_length (get_buffer (self)) > 0 && start > 0)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_peek_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -2043,7 +2348,7 @@ clutter_text_move_word_forward (ClutterText *self,
   n_chars = clutter_text_buffer_get_length (get_buffer (self));
   if (n_chars > 0 && start < n_chars)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_peek_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -2070,7 +2375,7 @@ clutter_text_move_line_start (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_peek_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2106,7 +2411,7 @@ clutter_text_move_line_end (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_peek_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2874,7 +3179,7 @@ clutter_text_get_paint_volume (ClutterActor       *self,
 
       _clutter_paint_volume_init_static (&priv->paint_volume, self);
 
-      layout = clutter_text_get_layout (text);
+      layout = clutter_text_peek_layout (text);
       pango_layout_get_extents (layout, &ink_rect, NULL);
 
       origin.x = pango_to_logical_pixels (ink_rect.x, resource_scale);
@@ -3249,7 +3554,7 @@ clutter_text_real_move_up (ClutterText         *self,
   gint x;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_peek_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -3306,7 +3611,7 @@ clutter_text_real_move_down (ClutterText         *self,
   gint pos;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_peek_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -5777,21 +6082,26 @@ clutter_text_set_markup (ClutterText *self,
 PangoLayout *
 clutter_text_get_layout (ClutterText *self)
 {
-  PangoLayout *layout;
-  gfloat width, height;
+  ClutterTextPrivate *priv;
 
   g_return_val_if_fail (CLUTTER_IS_TEXT (self), NULL);
 
-  if (self->priv->editable && self->priv->single_line_mode)
-    return clutter_text_create_layout (self, -1, -1);
+  priv = self->priv;
 
-  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
-  layout = maybe_create_text_layout_with_resource_scale (self, width, height);
+  /* The caller might modify the returned layout, so stop using layouts
+   * shared with other actors from now on
+   */
+  if (!priv->layout_exposed)
+    {
+      gboolean was_sharing = clutter_text_can_share_layout (self);
 
-  if (!layout)
-    layout = clutter_text_create_layout (self, width, height);
+      priv->layout_exposed = TRUE;
 
-  return layout;
+      if (was_sharing)
+        clutter_text_dirty_cache (self);
+    }
+
+  return clutter_text_peek_layout (self);
 }
 
 /**
@@ -241,6 +241,8 @@ typedef struct
 {
   GType value_type;
   ClutterProgressFunc func;
+  /* Whether func is the one Clutter registers for value_type */
+  gboolean builtin;
 } ProgressData;
 
 G_LOCK_DEFINE_STATIC (progress_funcs);
@@ -257,6 +259,35 @@ _clutter_has_progress_function (GType gtype)
   return g_hash_table_lookup (progress_funcs, type_name) != NULL;
 }
 
+/*
+ * _clutter_has_custom_progress_function:
+ * @gtype: a #GType
+ *
+ * Checks whether the progress function of @gtype was replaced through
+ * clutter_interval_register_progress_func(), so code interpolating
+ * values of the type itself must go through the registered function.
+ */
+gboolean
+_clutter_has_custom_progress_function (GType gtype)
+{
+  ProgressData *pdata;
+  gboolean res;
+
+  G_LOCK (progress_funcs);
+
+  if (progress_funcs == NULL)
+    res = FALSE;
+  else
+    {
+      pdata = g_hash_table_lookup (progress_funcs, g_type_name (gtype));
+      res = pdata != NULL && !pdata->builtin;
+    }
+
+  G_UNLOCK (progress_funcs);
+
+  return res;
+}
+
 gboolean
 _clutter_run_progress_function (GType gtype,
                                 const GValue *initial,
@@ -296,6 +327,54 @@ progress_data_destroy (gpointer data_)
   g_free (data_);
 }
 
+static void
+register_progress_func (GType               value_type,
+                        ClutterProgressFunc func,
+                        gboolean            builtin)
+{
+  ProgressData *progress_func;
+  const char *type_name;
+
+  type_name = g_type_name (value_type);
+
+  G_LOCK (progress_funcs);
+
+  if (G_UNLIKELY (progress_funcs == NULL))
+    progress_funcs = g_hash_table_new_full (NULL, NULL,
+                                            NULL,
+                                            progress_data_destroy);
+
+  progress_func =
+    g_hash_table_lookup (progress_funcs, type_name);
+
+  if (G_UNLIKELY (progress_func))
+    {
+      if (func == NULL)
+        {
+          g_hash_table_remove (progress_funcs, type_name);
+          g_free (progress_func);
+        }
+      else
+        {
+          progress_func->func = func;
+          progress_func->builtin = builtin;
+        }
+    }
+  else
+    {
+      progress_func = g_new0 (ProgressData, 1);
+      progress_func->value_type = value_type;
+      progress_func->func = func;
+      progress_func->builtin = builtin;
+
+      g_hash_table_replace (progress_funcs,
+                            (gpointer) type_name,
+                            progress_func);
+    }
+
+  G_UNLOCK (progress_funcs);
+}
+
 /**
  * clutter_interval_register_progress_func: (skip)
  * @value_type: a #GType
@@ -343,45 +422,16 @@ void
 clutter_interval_register_progress_func (GType               value_type,
                                          ClutterProgressFunc func)
 {
-  ProgressData *progress_func;
-  const char *type_name;
-
   g_return_if_fail (value_type != G_TYPE_INVALID);
 
-  type_name = g_type_name (value_type);
-
-  G_LOCK (progress_funcs);
-
-  if (G_UNLIKELY (progress_funcs == NULL))
-    progress_funcs = g_hash_table_new_full (NULL, NULL,
-                                            NULL,
-                                            progress_data_destroy);
-
-  progress_func =
-    g_hash_table_lookup (progress_funcs, type_name);
-
-  if (G_UNLIKELY (progress_func))
-    {
-      if (func == NULL)
-        {
-          g_hash_table_remove (progress_funcs, type_name);
-          g_free (progress_func);
-        }
-      else
-        progress_func->func = func;
-    }
-  else
-    {
-      progress_func = g_new0 (ProgressData, 1);
-      progress_func->value_type = value_type;
-      progress_func->func = func;
-
-      g_hash_table_replace (progress_funcs,
-                            (gpointer) type_name,
-                            progress_func);
-    }
+  register_progress_func (value_type, func, FALSE);
+}
 
-  G_UNLOCK (progress_funcs);
+void
+_clutter_interval_register_builtin_progress_func (GType               value_type,
+                                                  ClutterProgressFunc func)
+{
+  register_progress_func (value_type, func, TRUE);
 }
 
 PangoDirection
@@ -81,6 +81,10 @@ struct _CoglPangoDisplayListNode
       GArray *rectangles;
       /* A primitive representing those vertices */
       CoglPrimitive *primitive;
+      /* Width of the antialiasing band at a device scale of 1 if
+         the texture stores glyphs as distance fields or 0 otherwise */
+      float distance_field_smoothing;
+      int smoothing_location;
       guint has_color : 1;
     } texture;
 
@@ -137,7 +141,8 @@ _cogl_pango_display_list_add_texture (CoglPangoDisplayList *dl,
                                       float x_1, float y_1,
                                       float x_2, float y_2,
                                       float tx_1, float ty_1,
-                                      float tx_2, float ty_2)
+                                      float tx_2, float ty_2,
+                                      float distance_field_smoothing)
 {
   CoglPangoDisplayListNode *node;
   CoglPangoDisplayListRectangle *rectangle;
@@ -147,6 +152,7 @@ _cogl_pango_display_list_add_texture (CoglPangoDisplayList *dl,
   if (dl->last_node
       && (node = dl->last_node->data)->type == COGL_PANGO_DISPLAY_LIST_TEXTURE
       && node->d.texture.texture == texture
+      && node->d.texture.distance_field_smoothing == distance_field_smoothing
       && (dl->color_override
           ? (node->color_override && cogl_color_equal (&dl->color, &node->color))
           : !node->color_override))
@@ -171,6 +177,8 @@ _cogl_pango_display_list_add_texture (CoglPangoDisplayList *dl,
       node->d.texture.rectangles
         = g_array_new (FALSE, FALSE, sizeof (CoglPangoDisplayListRectangle));
       node->d.texture.primitive = NULL;
+      node->d.texture.distance_field_smoothing = distance_field_smoothing;
+      node->d.texture.smoothing_location = -1;
 
       _cogl_pango_display_list_append_node (dl, node);
     }
@@ -393,7 +401,8 @@ _cogl_framebuffer_draw_display_list_texture (CoglFramebuffer *fb,
 void
 _cogl_pango_display_list_render (CoglFramebuffer *fb,
                                  CoglPangoDisplayList *dl,
-                                 const CoglColor *color)
+                                 const CoglColor *color,
+                                 float device_scale)
 {
   GSList *l;
 
@@ -404,7 +413,17 @@ _cogl_pango_display_list_render (CoglFramebuffer *fb,
 
       if (node->pipeline == NULL)
         {
-          if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE)
+          if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE &&
+              node->d.texture.distance_field_smoothing > 0.0f)
+            {
+              node->pipeline =
+                _cogl_pango_pipeline_cache_get_distance_field
+                  (dl->pipeline_cache, node->d.texture.texture);
+              node->d.texture.smoothing_location =
+                cogl_pipeline_get_uniform_location (node->pipeline,
+                                                    "distance_field_smoothing");
+            }
+          else if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE)
             node->pipeline =
               _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
                                               node->d.texture.texture);
@@ -430,6 +449,17 @@ _cogl_pango_display_list_render (CoglFramebuffer *fb,
 
       cogl_pipeline_set_color (node->pipeline, &draw_color);
 
+      /* The pipeline is shared by all glyphs in the texture so the
+         smoothing for the size of these glyphs is set on every draw,
+         the same way as the color. The band gets narrower in the
+         texture as the glyphs get magnified on screen */
+      if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE &&
+          node->d.texture.smoothing_location != -1)
+        cogl_pipeline_set_uniform_1f (node->pipeline,
+                                      node->d.texture.smoothing_location,
+                                      node->d.texture.distance_field_smoothing /
+                                      device_scale);
+
       switch (node->type)
         {
         case COGL_PANGO_DISPLAY_LIST_TEXTURE:
@@ -52,7 +52,8 @@ _cogl_pango_display_list_add_texture (CoglPangoDisplayList *dl,
                                       float x_1, float y_1,
                                       float x_2, float y_2,
                                       float tx_1, float ty_1,
-                                      float tx_2, float ty_2);
+                                      float tx_2, float ty_2,
+                                      float distance_field_smoothing);
 
 void
 _cogl_pango_display_list_add_rectangle (CoglPangoDisplayList *dl,
@@ -71,7 +72,8 @@ _cogl_pango_display_list_add_trapezoid (CoglPangoDisplayList *dl,
 void
 _cogl_pango_display_list_render (CoglFramebuffer *framebuffer,
                                  CoglPangoDisplayList *dl,
-                                 const CoglColor *color);
+                                 const CoglColor *color,
+                                 float device_scale);
 
 void
 _cogl_pango_display_list_clear (CoglPangoDisplayList *dl);
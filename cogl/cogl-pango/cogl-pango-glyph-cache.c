@@ -64,6 +64,15 @@ struct _CoglPangoGlyphCache
   /* Whether mipmapping is being used for this cache. This only
      affects whether we decide to put the glyph in the global atlas */
   gboolean          use_mipmapping;
+
+  /* Whether the glyphs are stored as signed distance fields. These
+     get extra padding and are always kept in local atlases */
+  gboolean          use_distance_field;
+
+  /* Number of glyphs with a texture and the number of texels reserved
+     for them, used for debugging output and by tests */
+  unsigned int      n_glyphs;
+  size_t            n_texels;
 };
 
 struct _CoglPangoGlyphCacheKey
@@ -142,6 +151,24 @@ cogl_pango_glyph_cache_new (CoglContext *ctx,
 
   cache->use_mipmapping = use_mipmapping;
 
+  cache->use_distance_field = FALSE;
+
+  cache->n_glyphs = 0;
+  cache->n_texels = 0;
+
+  return cache;
+}
+
+CoglPangoGlyphCache *
+_cogl_pango_glyph_cache_new_for_distance_fields (CoglContext *ctx)
+{
+  CoglPangoGlyphCache *cache;
+
+  /* Distance fields are scaled with linear filtering instead of
+     mipmaps */
+  cache = cogl_pango_glyph_cache_new (ctx, FALSE);
+  cache->use_distance_field = TRUE;
+
   return cache;
 }
 
@@ -160,6 +187,8 @@ cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache)
   g_slist_free (cache->atlases);
   cache->atlases = NULL;
   cache->has_dirty_glyphs = FALSE;
+  cache->n_glyphs = 0;
+  cache->n_texels = 0;
 
   g_hash_table_remove_all (cache->hash_table);
 }
@@ -222,6 +251,11 @@ cogl_pango_glyph_cache_add_to_global_atlas (CoglPangoGlyphCache *cache,
   if (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SHARED_ATLAS))
     return FALSE;
 
+  /* Distance fields need a pipeline of their own so there is no point
+     in sharing the global atlas with other textures */
+  if (cache->use_distance_field)
+    return FALSE;
+
   /* If the cache is using mipmapping then we can't use the global
      atlas because it would just get migrated back out */
   if (cache->use_mipmapping)
@@ -343,6 +377,16 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
         value->dirty = FALSE;
       else
         {
+          /* Leave room for the distance field to fall off outside of
+             the glyph outline */
+          if (cache->use_distance_field)
+            {
+              value->draw_x -= COGL_PANGO_DISTANCE_FIELD_SPREAD;
+              value->draw_y -= COGL_PANGO_DISTANCE_FIELD_SPREAD;
+              value->draw_width += COGL_PANGO_DISTANCE_FIELD_SPREAD * 2;
+              value->draw_height += COGL_PANGO_DISTANCE_FIELD_SPREAD * 2;
+            }
+
           /* Try adding the glyph to the global atlas... */
           if (!cogl_pango_glyph_cache_add_to_global_atlas (cache,
                                                            font,
@@ -360,6 +404,10 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 
           value->dirty = TRUE;
           cache->has_dirty_glyphs = TRUE;
+
+          cache->n_glyphs++;
+          cache->n_texels += ((size_t) value->draw_width *
+                              (size_t) value->draw_height);
         }
 
       key = g_new0 (CoglPangoGlyphCacheKey, 1);
@@ -403,6 +451,17 @@ _cogl_pango_glyph_cache_set_dirty_glyphs (CoglPangoGlyphCache *cache,
                         func);
 
   cache->has_dirty_glyphs = FALSE;
+
+  COGL_NOTE (PANGO, "%s glyph cache %p: %u glyphs using %" G_GSIZE_FORMAT
+             " texels",
+             cache->use_distance_field ? "distance field" : "bitmap",
+             cache, cache->n_glyphs, cache->n_texels);
+}
+
+unsigned int
+_cogl_pango_glyph_cache_get_n_glyphs (CoglPangoGlyphCache *cache)
+{
+  return cache->n_glyphs;
 }
 
 void
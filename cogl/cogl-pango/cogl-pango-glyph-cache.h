@@ -36,6 +36,10 @@
 
 G_BEGIN_DECLS
 
+/* Number of pixels of padding around glyphs stored as distance fields.
+   This is also the largest distance that can be represented */
+#define COGL_PANGO_DISTANCE_FIELD_SPREAD 6
+
 typedef struct _CoglPangoGlyphCache      CoglPangoGlyphCache;
 typedef struct _CoglPangoGlyphCacheValue CoglPangoGlyphCacheValue;
 
@@ -71,6 +75,9 @@ COGL_EXPORT CoglPangoGlyphCache *
 cogl_pango_glyph_cache_new (CoglContext *ctx,
                             gboolean use_mipmapping);
 
+CoglPangoGlyphCache *
+_cogl_pango_glyph_cache_new_for_distance_fields (CoglContext *ctx);
+
 COGL_EXPORT void
 cogl_pango_glyph_cache_free (CoglPangoGlyphCache *cache);
 
@@ -83,6 +90,9 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 COGL_EXPORT void
 cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache);
 
+unsigned int
+_cogl_pango_glyph_cache_get_n_glyphs (CoglPangoGlyphCache *cache);
+
 void
 _cogl_pango_glyph_cache_add_reorganize_callback (CoglPangoGlyphCache *cache,
                                                  GHookFunc func,
@@ -91,6 +91,7 @@ _cogl_pango_pipeline_cache_new (CoglContext *ctx,
 
   cache->base_texture_rgba_pipeline = NULL;
   cache->base_texture_alpha_pipeline = NULL;
+  cache->base_distance_field_pipeline = NULL;
 
   cache->use_mipmapping = use_mipmapping;
 
@@ -152,6 +153,48 @@ get_base_texture_alpha_pipeline (CoglPangoPipelineCache *cache)
   return cache->base_texture_alpha_pipeline;
 }
 
+static CoglPipeline *
+get_base_distance_field_pipeline (CoglPangoPipelineCache *cache)
+{
+  if (cache->base_distance_field_pipeline == NULL)
+    {
+      CoglPipeline *pipeline;
+      CoglSnippet *snippet;
+
+      /* Distance fields are never mipmapped, they rely on linear
+         filtering of the distance values instead */
+      pipeline = cogl_pipeline_new (cache->ctx);
+      cache->base_distance_field_pipeline = pipeline;
+
+      cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_set_layer_filters (pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+
+      /* The texture stores 0.5 on the glyph outline, increasing towards
+       * the inside. Turn that back into coverage with an antialiasing
+       * band whose width is set per draw depending on the scale the
+       * glyphs are drawn at, then use the same combine as for alpha
+       * textures.
+       */
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                                  "uniform float distance_field_smoothing;\n",
+                                  "cogl_texel.a = "
+                                  "smoothstep (0.5 - distance_field_smoothing,"
+                                  "            0.5 + distance_field_smoothing,"
+                                  "            cogl_texel.a);\n");
+      cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+      cogl_object_unref (snippet);
+
+      cogl_pipeline_set_layer_combine (pipeline, 0, /* layer */
+                                       "RGBA = MODULATE (PREVIOUS, TEXTURE[A])",
+                                       NULL);
+    }
+
+  return cache->base_distance_field_pipeline;
+}
+
 typedef struct
 {
   CoglPangoPipelineCache *cache;
@@ -167,9 +210,10 @@ pipeline_destroy_notify_cb (void *user_data)
   g_free (data);
 }
 
-CoglPipeline *
-_cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
-                                CoglTexture *texture)
+static CoglPipeline *
+_cogl_pango_pipeline_cache_get_internal (CoglPangoPipelineCache *cache,
+                                         CoglTexture            *texture,
+                                         gboolean                distance_field)
 {
   CoglPangoPipelineCacheEntry *entry;
   PipelineDestroyNotifyData *destroy_data;
@@ -190,7 +234,10 @@ _cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
 
       entry->texture = cogl_object_ref (texture);
 
-      if (_cogl_texture_get_format (entry->texture) == COGL_PIXEL_FORMAT_A_8)
+      if (distance_field)
+        base = get_base_distance_field_pipeline (cache);
+      else if (_cogl_texture_get_format (entry->texture) ==
+               COGL_PIXEL_FORMAT_A_8)
         base = get_base_texture_alpha_pipeline (cache);
       else
         base = get_base_texture_rgba_pipeline (cache);
@@ -224,6 +271,20 @@ _cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
   return entry->pipeline;
 }
 
+CoglPipeline *
+_cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
+                                CoglTexture *texture)
+{
+  return _cogl_pango_pipeline_cache_get_internal (cache, texture, FALSE);
+}
+
+CoglPipeline *
+_cogl_pango_pipeline_cache_get_distance_field (CoglPangoPipelineCache *cache,
+                                               CoglTexture *texture)
+{
+  return _cogl_pango_pipeline_cache_get_internal (cache, texture, TRUE);
+}
+
 void
 _cogl_pango_pipeline_cache_free (CoglPangoPipelineCache *cache)
 {
@@ -231,6 +292,8 @@ _cogl_pango_pipeline_cache_free (CoglPangoPipelineCache *cache)
     cogl_object_unref (cache->base_texture_rgba_pipeline);
   if (cache->base_texture_alpha_pipeline)
     cogl_object_unref (cache->base_texture_alpha_pipeline);
+  if (cache->base_distance_field_pipeline)
+    cogl_object_unref (cache->base_distance_field_pipeline);
 
   g_hash_table_destroy (cache->hash_table);
 
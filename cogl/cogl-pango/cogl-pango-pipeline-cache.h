@@ -48,6 +48,7 @@ typedef struct _CoglPangoPipelineCache
 
   CoglPipeline *base_texture_alpha_pipeline;
   CoglPipeline *base_texture_rgba_pipeline;
+  CoglPipeline *base_distance_field_pipeline;
 
   gboolean use_mipmapping;
 } CoglPangoPipelineCache;
@@ -64,6 +65,13 @@ CoglPipeline *
 _cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
                                 CoglTexture *texture);
 
+/* Same as _cogl_pango_pipeline_cache_get() but for a texture storing
+   glyphs as signed distance fields. The smoothing of the outline is
+   controlled with the "distance_field_smoothing" uniform */
+CoglPipeline *
+_cogl_pango_pipeline_cache_get_distance_field (CoglPangoPipelineCache *cache,
+                                               CoglTexture *texture);
+
 void
 _cogl_pango_pipeline_cache_free (CoglPangoPipelineCache *cache);
 
@@ -52,6 +52,15 @@ _cogl_pango_renderer_set_use_mipmapping (CoglPangoRenderer *renderer,
 gboolean
 _cogl_pango_renderer_get_use_mipmapping (CoglPangoRenderer *renderer);
 
+void
+_cogl_pango_renderer_set_use_distance_fields (CoglPangoRenderer *renderer,
+                                              gboolean value);
+gboolean
+_cogl_pango_renderer_get_use_distance_fields (CoglPangoRenderer *renderer);
+
+COGL_EXPORT unsigned int
+_cogl_pango_renderer_get_n_distance_field_glyphs (CoglPangoRenderer *renderer);
+
 
 
 CoglContext *
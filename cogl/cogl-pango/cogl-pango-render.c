@@ -46,6 +46,8 @@
 #define PANGO_UNKNOWN_GLYPH_HEIGHT 14
 #endif
 
+#include <math.h>
+#include <string.h>
 #include <pango/pango-fontmap.h>
 #include <pango/pangocairo.h>
 #include <pango/pango-renderer.h>
@@ -59,6 +61,22 @@
 #include "cogl-pango-glyph-cache.h"
 #include "cogl-pango-display-list.h"
 
+/* Pixel size at which glyphs are rasterized when they are stored as
+   distance fields. The same texture is then scaled for all sizes */
+#define COGL_PANGO_DISTANCE_FIELD_REFERENCE_SIZE 48
+
+/* Fonts smaller than this are still drawn from hinted bitmaps because
+   distance fields lose too much detail at small sizes */
+#define COGL_PANGO_DISTANCE_FIELD_MIN_SIZE 24
+
+/* Value used as infinity in the distance transform. This needs to be
+   finite to keep the arithmetic in the transform valid */
+#define COGL_PANGO_DISTANCE_FIELD_INF 1e20f
+
+/* Layouts drawn with a scale closer to 1 than this are considered
+   unscaled and keep using the hinted bitmaps */
+#define COGL_PANGO_DISTANCE_FIELD_SCALE_EPSILON 0.01f
+
 enum
 {
   PROP_0,
@@ -84,7 +102,18 @@ struct _CoglPangoRenderer
   CoglPangoRendererCaches no_mipmap_caches;
   CoglPangoRendererCaches mipmap_caches;
 
+  /* Glyphs of large fonts stored as distance fields at a single
+     reference size. These are drawn with the pipeline cache of the
+     caches above using a distance field pipeline */
+  CoglPangoGlyphCache *distance_field_glyph_cache;
+
   gboolean use_mipmapping;
+  gboolean use_distance_fields;
+
+  /* Whether the glyphs of the layout currently being drawn are taken
+     from the distance field cache. This is only set while drawing a
+     layout that is scaled on screen with use_distance_fields enabled */
+  gboolean draw_with_distance_fields;
 
   /* The current display list that is being built */
   CoglPangoDisplayList *display_list;
@@ -111,6 +140,21 @@ struct _CoglPangoLayoutQdata
      need to regenerate the display list if the mipmapping value is
      changed because it will be using a different set of textures */
   gboolean mipmapping_used;
+  /* Same for whether distance fields were used */
+  gboolean distance_fields_used;
+};
+
+typedef struct _CoglPangoDistanceFieldFont CoglPangoDistanceFieldFont;
+
+/* An instance of this struct gets attached to each PangoFont the first
+   time it is drawn with distance fields enabled */
+struct _CoglPangoDistanceFieldFont
+{
+  /* The same font at the reference size used to rasterize the distance
+     fields or NULL if the font has to be drawn from bitmaps */
+  PangoFont *reference_font;
+  /* The size of the font relative to the reference font */
+  float scale;
 };
 
 static void
@@ -120,6 +164,7 @@ typedef struct
 {
   CoglPangoDisplayList *display_list;
   float x1, y1, x2, y2;
+  float distance_field_smoothing;
 } CoglPangoRendererSliceCbData;
 
 PangoRenderer *
@@ -150,24 +195,42 @@ cogl_pango_renderer_slice_cb (CoglTexture *texture,
                                         slice_coords[0],
                                         slice_coords[1],
                                         slice_coords[2],
-                                        slice_coords[3]);
+                                        slice_coords[3],
+                                        data->distance_field_smoothing);
 }
 
+/* distance_field_scale is the scale of the glyph relative to the
+   reference size if it is stored as a distance field or 0 otherwise */
 static void
 cogl_pango_renderer_draw_glyph (CoglPangoRenderer        *priv,
                                 CoglPangoGlyphCacheValue *cache_value,
                                 float                     x1,
-                                float                     y1)
+                                float                     y1,
+                                float                     distance_field_scale)
 {
   CoglPangoRendererSliceCbData data;
+  float scale = 1.0f;
 
   g_return_if_fail (priv->display_list != NULL);
 
   data.display_list = priv->display_list;
+  data.distance_field_smoothing = 0.0f;
+
+  if (distance_field_scale > 0.0f)
+    {
+      /* The distance values change by 1 / (2 * spread) per texel of
+         the reference size, keep the antialiasing band around one
+         pixel wide at the size the glyph is laid out at. The display
+         list adjusts it to the scale the layout is drawn with */
+      scale = distance_field_scale;
+      data.distance_field_smoothing =
+        1.0f / (4.0f * COGL_PANGO_DISTANCE_FIELD_SPREAD * scale);
+    }
+
   data.x1 = x1;
   data.y1 = y1;
-  data.x2 = x1 + (float) cache_value->draw_width;
-  data.y2 = y1 + (float) cache_value->draw_height;
+  data.x2 = x1 + (float) cache_value->draw_width * scale;
+  data.y2 = y1 + (float) cache_value->draw_height * scale;
 
   /* We iterate the internal sub textures of the texture so that we
      can get a pointer to the base texture even if the texture is in
@@ -231,7 +294,11 @@ _cogl_pango_renderer_constructed (GObject *gobject)
   renderer->mipmap_caches.glyph_cache =
     cogl_pango_glyph_cache_new (ctx, TRUE);
 
+  renderer->distance_field_glyph_cache =
+    _cogl_pango_glyph_cache_new_for_distance_fields (ctx);
+
   _cogl_pango_renderer_set_use_mipmapping (renderer, FALSE);
+  _cogl_pango_renderer_set_use_distance_fields (renderer, FALSE);
 
   if (G_OBJECT_CLASS (cogl_pango_renderer_parent_class)->constructed)
     G_OBJECT_CLASS (cogl_pango_renderer_parent_class)->constructed (gobject);
@@ -302,6 +369,7 @@ cogl_pango_renderer_finalize (GObject *object)
 
   cogl_pango_glyph_cache_free (priv->no_mipmap_caches.glyph_cache);
   cogl_pango_glyph_cache_free (priv->mipmap_caches.glyph_cache);
+  cogl_pango_glyph_cache_free (priv->distance_field_glyph_cache);
 
   _cogl_pango_pipeline_cache_free (priv->no_mipmap_caches.pipeline_cache);
   _cogl_pango_pipeline_cache_free (priv->mipmap_caches.pipeline_cache);
@@ -353,6 +421,12 @@ cogl_pango_layout_qdata_forget_display_list (CoglPangoLayoutQdata *qdata)
          (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
          qdata);
 
+      if (qdata->distance_fields_used)
+        _cogl_pango_glyph_cache_remove_reorganize_callback
+          (qdata->renderer->distance_field_glyph_cache,
+           (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
+           qdata);
+
       _cogl_pango_display_list_free (qdata->display_list);
 
       qdata->display_list = NULL;
@@ -368,6 +442,65 @@ cogl_pango_render_qdata_destroy (CoglPangoLayoutQdata *qdata)
   g_free (qdata);
 }
 
+/* Returns the number of device pixels covered by one unit of the
+   current modelview around its origin, or 1 if it can't be
+   determined, e.g. because the origin is behind the viewer */
+static float
+cogl_pango_get_device_scale (CoglFramebuffer *fb)
+{
+  graphene_matrix_t modelview;
+  graphene_matrix_t projection;
+  graphene_matrix_t transform;
+  graphene_vec4_t points[3];
+  float half_width = cogl_framebuffer_get_viewport_width (fb) / 2.0f;
+  float half_height = cogl_framebuffer_get_viewport_height (fb) / 2.0f;
+  float device_x[3], device_y[3];
+  float scale_x, scale_y;
+  int i;
+
+  cogl_framebuffer_get_modelview_matrix (fb, &modelview);
+  cogl_framebuffer_get_projection_matrix (fb, &projection);
+  graphene_matrix_multiply (&modelview, &projection, &transform);
+
+  graphene_vec4_init (&points[0], 0.0f, 0.0f, 0.0f, 1.0f);
+  graphene_vec4_init (&points[1], 1.0f, 0.0f, 0.0f, 1.0f);
+  graphene_vec4_init (&points[2], 0.0f, 1.0f, 0.0f, 1.0f);
+
+  for (i = 0; i < 3; i++)
+    {
+      float w;
+
+      graphene_matrix_transform_vec4 (&transform, &points[i], &points[i]);
+
+      w = graphene_vec4_get_w (&points[i]);
+      if (w <= 0.0f)
+        return 1.0f;
+
+      device_x[i] = graphene_vec4_get_x (&points[i]) / w * half_width;
+      device_y[i] = graphene_vec4_get_y (&points[i]) / w * half_height;
+    }
+
+  scale_x = hypotf (device_x[1] - device_x[0], device_y[1] - device_y[0]);
+  scale_y = hypotf (device_x[2] - device_x[0], device_y[2] - device_y[0]);
+
+  /* Glyphs are drawn with a single antialiasing band so use the
+     geometric mean of non-uniform scales */
+  return sqrtf (scale_x * scale_y);
+}
+
+/* Decides whether the glyphs of the layout about to be drawn with
+   device_scale come from the distance field cache. Layouts drawn at
+   their own size look best with hinted bitmaps, scaled ones would
+   otherwise need a new bitmap for every scale */
+static void
+cogl_pango_renderer_begin_draw (CoglPangoRenderer *priv,
+                                float              device_scale)
+{
+  priv->draw_with_distance_fields =
+    (priv->use_distance_fields &&
+     fabsf (device_scale - 1.0f) > COGL_PANGO_DISTANCE_FIELD_SCALE_EPSILON);
+}
+
 void
 cogl_pango_show_layout (CoglFramebuffer *fb,
                         PangoLayout *layout,
@@ -378,12 +511,19 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
   PangoContext *context;
   CoglPangoRenderer *priv;
   CoglPangoLayoutQdata *qdata;
+  float device_scale;
 
   context = pango_layout_get_context (layout);
   priv = cogl_pango_get_renderer_from_context (context);
   if (G_UNLIKELY (!priv))
     return;
 
+  cogl_framebuffer_push_matrix (fb);
+  cogl_framebuffer_translate (fb, x, y, 0);
+
+  device_scale = cogl_pango_get_device_scale (fb);
+  cogl_pango_renderer_begin_draw (priv, device_scale);
+
   qdata = g_object_get_qdata (G_OBJECT (layout),
                               cogl_pango_layout_get_qdata_key ());
 
@@ -404,7 +544,8 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
   if (qdata->display_list &&
       ((qdata->first_line &&
         qdata->first_line->layout != layout) ||
-       qdata->mipmapping_used != priv->use_mipmapping))
+       qdata->mipmapping_used != priv->use_mipmapping ||
+       qdata->distance_fields_used != priv->draw_with_distance_fields))
     cogl_pango_layout_qdata_forget_display_list (qdata);
 
   if (qdata->display_list == NULL)
@@ -424,20 +565,26 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
         (caches->glyph_cache,
          (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
          qdata);
+      if (priv->draw_with_distance_fields)
+        _cogl_pango_glyph_cache_add_reorganize_callback
+          (priv->distance_field_glyph_cache,
+           (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
+           qdata);
 
       priv->display_list = qdata->display_list;
       pango_renderer_draw_layout (PANGO_RENDERER (priv), layout, 0, 0);
       priv->display_list = NULL;
 
       qdata->mipmapping_used = priv->use_mipmapping;
+      qdata->distance_fields_used = priv->draw_with_distance_fields;
     }
 
-  cogl_framebuffer_push_matrix (fb);
-  cogl_framebuffer_translate (fb, x, y, 0);
-
   _cogl_pango_display_list_render (fb,
                                    qdata->display_list,
-                                   color);
+                                   color,
+                                   device_scale);
+
+  priv->draw_with_distance_fields = FALSE;
 
   cogl_framebuffer_pop_matrix (fb);
 
@@ -467,12 +614,16 @@ cogl_pango_show_layout_line (CoglFramebuffer *fb,
   CoglPangoRendererCaches *caches;
   int pango_x = x * PANGO_SCALE;
   int pango_y = y * PANGO_SCALE;
+  float device_scale;
 
   context = pango_layout_get_context (line->layout);
   priv = cogl_pango_get_renderer_from_context (context);
   if (G_UNLIKELY (!priv))
     return;
 
+  device_scale = cogl_pango_get_device_scale (fb);
+  cogl_pango_renderer_begin_draw (priv, device_scale);
+
   caches = (priv->use_mipmapping ?
             &priv->mipmap_caches :
             &priv->no_mipmap_caches);
@@ -486,10 +637,12 @@ cogl_pango_show_layout_line (CoglFramebuffer *fb,
 
   _cogl_pango_display_list_render (fb,
                                    priv->display_list,
-                                   color);
+                                   color,
+                                   device_scale);
 
   _cogl_pango_display_list_free (priv->display_list);
   priv->display_list = NULL;
+  priv->draw_with_distance_fields = FALSE;
 }
 
 void
@@ -497,6 +650,7 @@ _cogl_pango_renderer_clear_glyph_cache (CoglPangoRenderer *renderer)
 {
   cogl_pango_glyph_cache_clear (renderer->mipmap_caches.glyph_cache);
   cogl_pango_glyph_cache_clear (renderer->no_mipmap_caches.glyph_cache);
+  cogl_pango_glyph_cache_clear (renderer->distance_field_glyph_cache);
 }
 
 void
@@ -512,19 +666,24 @@ _cogl_pango_renderer_get_use_mipmapping (CoglPangoRenderer *renderer)
   return renderer->use_mipmapping;
 }
 
-static CoglPangoGlyphCacheValue *
-cogl_pango_renderer_get_cached_glyph (PangoRenderer *renderer,
-                                      gboolean       create,
-                                      PangoFont     *font,
-                                      PangoGlyph     glyph)
+void
+_cogl_pango_renderer_set_use_distance_fields (CoglPangoRenderer *renderer,
+                                              gboolean value)
 {
-  CoglPangoRenderer *priv = COGL_PANGO_RENDERER (renderer);
-  CoglPangoRendererCaches *caches = (priv->use_mipmapping ?
-                                     &priv->mipmap_caches :
-                                     &priv->no_mipmap_caches);
+  renderer->use_distance_fields = value;
+}
 
-  return cogl_pango_glyph_cache_lookup (caches->glyph_cache,
-                                        create, font, glyph);
+gboolean
+_cogl_pango_renderer_get_use_distance_fields (CoglPangoRenderer *renderer)
+{
+  return renderer->use_distance_fields;
+}
+
+unsigned int
+_cogl_pango_renderer_get_n_distance_field_glyphs (CoglPangoRenderer *renderer)
+{
+  return
+    _cogl_pango_glyph_cache_get_n_glyphs (renderer->distance_field_glyph_cache);
 }
 
 static gboolean
@@ -545,6 +704,188 @@ font_has_color_glyphs (const PangoFont *font)
   return has_color;
 }
 
+static char *
+font_get_face_name (PangoFont *font,
+                    long      *n_glyphs)
+{
+  cairo_scaled_font_t *scaled_font;
+  FT_Face ft_face;
+  char *name;
+
+  scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font));
+
+  if (cairo_scaled_font_get_type (scaled_font) != CAIRO_FONT_TYPE_FT)
+    return NULL;
+
+  /* The faces are locked one at a time because both fonts are likely
+     to share the same underlying face */
+  ft_face = cairo_ft_scaled_font_lock_face (scaled_font);
+  name = g_strdup_printf ("%s %s", ft_face->family_name, ft_face->style_name);
+  *n_glyphs = ft_face->num_glyphs;
+  cairo_ft_scaled_font_unlock_face (scaled_font);
+
+  return name;
+}
+
+static gboolean
+fonts_have_same_face (PangoFont *font,
+                      PangoFont *other_font)
+{
+  g_autofree char *name = NULL;
+  g_autofree char *other_name = NULL;
+  long n_glyphs = 0, other_n_glyphs = 0;
+
+  /* Glyph indices are only meaningful within a face so the reference
+     font must not end up being matched to a different one */
+  name = font_get_face_name (font, &n_glyphs);
+  other_name = font_get_face_name (other_font, &other_n_glyphs);
+
+  return (name != NULL &&
+          g_strcmp0 (name, other_name) == 0 &&
+          n_glyphs == other_n_glyphs);
+}
+
+static GQuark
+cogl_pango_font_get_distance_field_key (void)
+{
+  static GQuark key = 0;
+
+  if (G_UNLIKELY (key == 0))
+    key = g_quark_from_static_string ("CoglPangoDistanceFieldFont");
+
+  return key;
+}
+
+static void
+cogl_pango_distance_field_font_free (CoglPangoDistanceFieldFont *df_font)
+{
+  g_clear_object (&df_font->reference_font);
+  g_free (df_font);
+}
+
+static PangoFont *
+cogl_pango_load_reference_font (PangoFont                  *font,
+                                const PangoFontDescription *desc)
+{
+  PangoFontMap *font_map = pango_font_get_font_map (font);
+  g_autoptr (PangoContext) context = NULL;
+  g_autoptr (PangoFontDescription) reference_desc = NULL;
+  cairo_font_options_t *options;
+  PangoFont *reference_font;
+
+  if (font_map == NULL)
+    return NULL;
+
+  /* Hinting would snap the outlines to the reference size pixel grid
+     which is meaningless once the glyph is scaled */
+  options = cairo_font_options_create ();
+  cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_NONE);
+  cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_OFF);
+  cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+
+  context = pango_font_map_create_context (font_map);
+  pango_cairo_context_set_font_options (context, options);
+  cairo_font_options_destroy (options);
+
+  reference_desc = pango_font_description_copy (desc);
+  pango_font_description_set_absolute_size
+    (reference_desc, COGL_PANGO_DISTANCE_FIELD_REFERENCE_SIZE * PANGO_SCALE);
+
+  reference_font = pango_font_map_load_font (font_map, context,
+                                             reference_desc);
+
+  if (reference_font && !fonts_have_same_face (font, reference_font))
+    g_clear_object (&reference_font);
+
+  return reference_font;
+}
+
+static CoglPangoDistanceFieldFont *
+cogl_pango_get_distance_field_font (PangoFont *font)
+{
+  CoglPangoDistanceFieldFont *df_font;
+  g_autoptr (PangoFontDescription) desc = NULL;
+  cairo_scaled_font_t *scaled_font;
+  cairo_matrix_t ctm;
+  float size;
+
+  df_font = g_object_get_qdata (G_OBJECT (font),
+                                cogl_pango_font_get_distance_field_key ());
+  if (df_font)
+    return df_font;
+
+  df_font = g_new0 (CoglPangoDistanceFieldFont, 1);
+
+  desc = pango_font_describe_with_absolute_size (font);
+  size = (float) pango_font_description_get_size (desc) / PANGO_SCALE;
+
+  scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font));
+  cairo_scaled_font_get_ctm (scaled_font, &ctm);
+
+  /* Color glyphs can't be represented by a single distance. Fonts
+     scaled by the transformation of the Pango context are drawn at
+     their scaled size but rotated or sheared ones aren't scaled
+     versions of the reference font */
+  if (size * ctm.xx >= COGL_PANGO_DISTANCE_FIELD_MIN_SIZE &&
+      ctm.xx == ctm.yy && ctm.xy == 0.0 && ctm.yx == 0.0 &&
+      !font_has_color_glyphs (font))
+    {
+      df_font->reference_font = cogl_pango_load_reference_font (font, desc);
+      df_font->scale =
+        size * ctm.xx / COGL_PANGO_DISTANCE_FIELD_REFERENCE_SIZE;
+    }
+
+  COGL_NOTE (PANGO, "%s font %p of size %.1f with distance fields",
+             df_font->reference_font ? "drawing" : "not drawing",
+             font, size);
+
+  g_object_set_qdata_full (G_OBJECT (font),
+                           cogl_pango_font_get_distance_field_key (),
+                           df_font,
+                           (GDestroyNotify)
+                           cogl_pango_distance_field_font_free);
+
+  return df_font;
+}
+
+/* If the glyph is stored as a distance field, distance_field_scale is
+   set to the scale to apply to the cached glyph or to 0 otherwise */
+static CoglPangoGlyphCacheValue *
+cogl_pango_renderer_get_cached_glyph (PangoRenderer *renderer,
+                                      gboolean       create,
+                                      PangoFont     *font,
+                                      PangoGlyph     glyph,
+                                      float         *distance_field_scale)
+{
+  CoglPangoRenderer *priv = COGL_PANGO_RENDERER (renderer);
+  CoglPangoRendererCaches *caches = (priv->use_mipmapping ?
+                                     &priv->mipmap_caches :
+                                     &priv->no_mipmap_caches);
+
+  if (distance_field_scale)
+    *distance_field_scale = 0.0f;
+
+  if (priv->draw_with_distance_fields)
+    {
+      CoglPangoDistanceFieldFont *df_font =
+        cogl_pango_get_distance_field_font (font);
+
+      if (df_font->reference_font)
+        {
+          if (distance_field_scale)
+            *distance_field_scale = df_font->scale;
+
+          return cogl_pango_glyph_cache_lookup (priv->distance_field_glyph_cache,
+                                                create,
+                                                df_font->reference_font,
+                                                glyph);
+        }
+    }
+
+  return cogl_pango_glyph_cache_lookup (caches->glyph_cache,
+                                        create, font, glyph);
+}
+
 static void
 cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
                                      PangoGlyph glyph,
@@ -556,8 +897,7 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
   cairo_glyph_t cairo_glyph;
   cairo_format_t format_cairo;
   CoglPixelFormat format_cogl;
-
-  COGL_NOTE (PANGO, "redrawing glyph %i", glyph);
+  int64_t start_time = g_get_monotonic_time ();
 
   /* Glyphs that don't take up any space will end up without a
      texture. These should never become dirty so they shouldn't end up
@@ -621,6 +961,236 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
   cairo_surface_destroy (surface);
 
   value->has_color = font_has_color_glyphs (font);
+
+  COGL_NOTE (PANGO, "redrew glyph %i (%ix%i) in %" G_GINT64_FORMAT " us",
+             glyph, value->draw_width, value->draw_height,
+             g_get_monotonic_time () - start_time);
+}
+
+/* One dimensional squared euclidean distance transform from
+ * Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled
+ * Functions". The index of the sample each distance was measured
+ * from is stored in nearest. v and z are scratch buffers of n and
+ * n + 1 elements.
+ */
+static void
+distance_transform_1d (const float *f,
+                       float       *d,
+                       int         *nearest,
+                       int          n,
+                       int         *v,
+                       float       *z)
+{
+  int k = 0;
+  int q;
+
+  v[0] = 0;
+  z[0] = -COGL_PANGO_DISTANCE_FIELD_INF;
+  z[1] = COGL_PANGO_DISTANCE_FIELD_INF;
+
+  for (q = 1; q < n; q++)
+    {
+      float s;
+
+      while (TRUE)
+        {
+          int p = v[k];
+
+          s = ((f[q] + q * q) - (f[p] + p * p)) / (2 * q - 2 * p);
+          if (s > z[k])
+            break;
+
+          k--;
+        }
+
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = COGL_PANGO_DISTANCE_FIELD_INF;
+    }
+
+  k = 0;
+  for (q = 0; q < n; q++)
+    {
+      while (z[k + 1] < q)
+        k++;
+
+      d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+      nearest[q] = v[k];
+    }
+}
+
+/* Replaces each value in grid with the squared distance to the
+   nearest 0 value, going over columns and then over rows. The index
+   in grid of that nearest value is stored in nearest */
+static void
+distance_transform_2d (float *grid,
+                       int   *nearest,
+                       int    width,
+                       int    height)
+{
+  int n = MAX (width, height);
+  g_autofree float *f = g_new (float, n);
+  g_autofree float *d = g_new (float, n);
+  g_autofree float *z = g_new (float, n + 1);
+  g_autofree int *v = g_new (int, n);
+  g_autofree int *nearest_1d = g_new (int, n);
+  g_autofree int *nearest_row = g_new (int, n);
+  int x, y;
+
+  /* The column pass finds the nearest row within each column */
+  for (x = 0; x < width; x++)
+    {
+      for (y = 0; y < height; y++)
+        f[y] = grid[y * width + x];
+
+      distance_transform_1d (f, d, nearest_1d, height, v, z);
+
+      for (y = 0; y < height; y++)
+        {
+          grid[y * width + x] = d[y];
+          nearest[y * width + x] = nearest_1d[y];
+        }
+    }
+
+  /* The row pass then picks the nearest column, whose nearest row
+     was found above */
+  for (y = 0; y < height; y++)
+    {
+      memcpy (f, grid + y * width, width * sizeof (float));
+      memcpy (nearest_row, nearest + y * width, width * sizeof (int));
+
+      distance_transform_1d (f, grid + y * width, nearest_1d, width, v, z);
+
+      for (x = 0; x < width; x++)
+        nearest[y * width + x] =
+          nearest_row[nearest_1d[x]] * width + nearest_1d[x];
+    }
+}
+
+static void
+cogl_pango_renderer_set_dirty_distance_field_glyph (PangoFont *font,
+                                                    PangoGlyph glyph,
+                                                    CoglPangoGlyphCacheValue *value)
+{
+  int width = value->draw_width;
+  int height = value->draw_height;
+  g_autofree float *outside = NULL;
+  g_autofree float *inside = NULL;
+  g_autofree int *nearest_inside = NULL;
+  g_autofree int *nearest_outside = NULL;
+  g_autofree uint8_t *field = NULL;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  cairo_glyph_t cairo_glyph;
+  const uint8_t *coverage;
+  int stride;
+  int64_t start_time = g_get_monotonic_time ();
+  int x, y;
+
+  g_return_if_fail (value->texture != NULL);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+  cr = cairo_create (surface);
+
+  cairo_set_scaled_font (cr,
+                         pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)));
+  cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
+
+  cairo_glyph.x = -value->draw_x;
+  cairo_glyph.y = -value->draw_y;
+  cairo_glyph.index = glyph;
+  cairo_show_glyphs (cr, &cairo_glyph, 1);
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  coverage = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+
+  /* Compute the distance to the outline from both sides by finding
+     the nearest pixel of the opposite side. Pixels with at least half
+     coverage count as inside */
+  outside = g_new (float, width * height);
+  inside = g_new (float, width * height);
+  nearest_inside = g_new (int, width * height);
+  nearest_outside = g_new (int, width * height);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        gboolean is_inside = coverage[y * stride + x] >= 128;
+
+        outside[y * width + x] = is_inside ? 0.0f : COGL_PANGO_DISTANCE_FIELD_INF;
+        inside[y * width + x] = is_inside ? COGL_PANGO_DISTANCE_FIELD_INF : 0.0f;
+      }
+
+  distance_transform_2d (outside, nearest_inside, width, height);
+  distance_transform_2d (inside, nearest_outside, width, height);
+
+  /* The coverage of a pixel the outline crosses tells how far the
+     outline is from its center, taking the outline to be straight
+     across the pixel. Use that on the outline itself and offset the
+     distance to the nearest pixel of the other side by it elsewhere,
+     so the outline isn't snapped to the pixel grid. Store 0.5 on the
+     outline and fall off linearly to 0 and 1 at the spread distance
+     on either side */
+  field = g_malloc (width * height);
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        int i = y * width + x;
+        uint8_t value = coverage[y * stride + x];
+        float distance;
+        float alpha;
+
+        if (value > 0 && value < 255)
+          {
+            distance = 0.5f - value / 255.0f;
+          }
+        else if (value == 255)
+          {
+            int p = nearest_outside[i];
+            float edge = (0.5f -
+                          coverage[(p / width) * stride + p % width] / 255.0f);
+
+            distance = edge - sqrtf (inside[i]);
+          }
+        else
+          {
+            int p = nearest_inside[i];
+            float edge = (coverage[(p / width) * stride + p % width] / 255.0f -
+                          0.5f);
+
+            distance = sqrtf (outside[i]) - edge;
+          }
+
+        alpha = 0.5f - distance / (2.0f * COGL_PANGO_DISTANCE_FIELD_SPREAD);
+        field[i] = (uint8_t) (CLAMP (alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+      }
+
+  cairo_surface_destroy (surface);
+
+  cogl_texture_set_region (value->texture,
+                           0, /* src_x */
+                           0, /* src_y */
+                           value->tx_pixel, /* dst_x */
+                           value->ty_pixel, /* dst_y */
+                           width, /* dst_width */
+                           height, /* dst_height */
+                           width, /* width */
+                           height, /* height */
+                           COGL_PIXEL_FORMAT_A_8,
+                           width, /* rowstride */
+                           field);
+
+  value->has_color = FALSE;
+
+  COGL_NOTE (PANGO, "redrew distance field glyph %i (%ix%i) in %"
+             G_GINT64_FORMAT " us",
+             glyph, width, height,
+             g_get_monotonic_time () - start_time);
 }
 
 static void
@@ -652,7 +1222,8 @@ _cogl_pango_ensure_glyph_cache_for_layout_line_internal (PangoLayoutLine *line)
              settled */
           cogl_pango_renderer_get_cached_glyph (renderer, TRUE,
                                                 run->item->analysis.font,
-                                                gi->glyph);
+                                                gi->glyph,
+                                                NULL);
         }
     }
 }
@@ -664,6 +1235,9 @@ _cogl_pango_set_dirty_glyphs (CoglPangoRenderer *priv)
     (priv->mipmap_caches.glyph_cache, cogl_pango_renderer_set_dirty_glyph);
   _cogl_pango_glyph_cache_set_dirty_glyphs
     (priv->no_mipmap_caches.glyph_cache, cogl_pango_renderer_set_dirty_glyph);
+  _cogl_pango_glyph_cache_set_dirty_glyphs
+    (priv->distance_field_glyph_cache,
+     cogl_pango_renderer_set_dirty_distance_field_glyph);
 }
 
 static void
@@ -845,6 +1419,7 @@ cogl_pango_renderer_draw_glyphs (PangoRenderer    *renderer,
   for (i = 0; i < glyphs->num_glyphs; i++)
     {
       PangoGlyphInfo *gi = glyphs->glyphs + i;
+      float distance_field_scale;
       float x, y;
 
       cogl_pango_renderer_set_color_for_part (renderer,
@@ -885,7 +1460,8 @@ cogl_pango_renderer_draw_glyphs (PangoRenderer    *renderer,
             cogl_pango_renderer_get_cached_glyph (renderer,
                                                   FALSE,
                                                   font,
-                                                  gi->glyph);
+                                                  gi->glyph,
+                                                  &distance_field_scale);
 
           /* cogl_pango_ensure_glyph_cache_for_layout should always be
              called before rendering a layout so we should never have
@@ -902,8 +1478,11 @@ cogl_pango_renderer_draw_glyphs (PangoRenderer    *renderer,
             }
 	  else if (cache_value->texture)
 	    {
-	      x += (float)(cache_value->draw_x);
-	      y += (float)(cache_value->draw_y);
+              float scale = (distance_field_scale > 0.0f ?
+                             distance_field_scale : 1.0f);
+
+	      x += (float)(cache_value->draw_x) * scale;
+	      y += (float)(cache_value->draw_y) * scale;
 
               /* Do not override color if the glyph/font provide its own */
               if (cache_value->has_color)
@@ -918,7 +1497,8 @@ cogl_pango_renderer_draw_glyphs (PangoRenderer    *renderer,
                   _cogl_pango_display_list_set_color_override (priv->display_list, &color);
                 }
 
-              cogl_pango_renderer_draw_glyph (priv, cache_value, x, y);
+              cogl_pango_renderer_draw_glyph (priv, cache_value, x, y,
+                                              distance_field_scale);
 	    }
 	}
 
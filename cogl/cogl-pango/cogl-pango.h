@@ -160,6 +160,42 @@ cogl_pango_font_map_set_use_mipmapping (CoglPangoFontMap *font_map,
 COGL_EXPORT gboolean
 cogl_pango_font_map_get_use_mipmapping (CoglPangoFontMap *font_map);
 
+/**
+ * cogl_pango_font_map_set_use_distance_fields:
+ * @font_map: a #CoglPangoFontMap
+ * @value: %TRUE to enable the use of distance fields
+ *
+ * Sets whether the renderer for the passed font map should draw the
+ * glyphs of large fonts from signed distance fields when the
+ * transformation of the framebuffer scales the text. A single texture
+ * per glyph is then shared by all sizes of a font and stays sharp while
+ * the text is magnified or zoomed. Text drawn at its own size keeps
+ * using the hinted bitmaps, as distance fields are rasterized without
+ * hinting and slightly round sharp corners.
+ *
+ * Small fonts and fonts with color glyphs are always rendered from
+ * bitmaps, and so are fonts rotated or sheared by the transformation
+ * set on the #PangoContext, as their glyphs aren't scaled copies of
+ * the untransformed ones.
+ *
+ * This is disabled by default.
+ */
+COGL_EXPORT void
+cogl_pango_font_map_set_use_distance_fields (CoglPangoFontMap *font_map,
+                                             gboolean          value);
+
+/**
+ * cogl_pango_font_map_get_use_distance_fields:
+ * @font_map: a #CoglPangoFontMap
+ *
+ * Retrieves whether the #CoglPangoRenderer used by @font_map will use
+ * distance fields when rendering the glyphs of large scaled fonts.
+ *
+ * Return value: %TRUE if distance fields are used, %FALSE otherwise.
+ */
+COGL_EXPORT gboolean
+cogl_pango_font_map_get_use_distance_fields (CoglPangoFontMap *font_map);
+
 /**
  * cogl_pango_font_map_get_renderer:
  * @font_map: a #CoglPangoFontMap
@@ -42,9 +42,23 @@
 #include "cogl-framebuffer-private.h"
 #include "cogl-blit.h"
 #include "cogl-private.h"
+#include "cogl-poll-private.h"
 
 #include <stdlib.h>
 
+#include <test-fixtures/test-unit.h>
+
+/* Atlases are meant for lots of small textures so there's no point in
+   letting a single one grow up to the maximum texture size. Once an
+   atlas reaches this size new rectangles have to go in another atlas
+   instead */
+#define COGL_ATLAS_MAX_TEXTURE_BYTES (16 * 1024 * 1024)
+
+/* If less than this percentage of an atlas is in use after removing a
+   rectangle then it will be rebuilt in a smaller texture the next
+   time the renderer is idle */
+#define COGL_ATLAS_COMPACT_OCCUPANCY 25
+
 static void _cogl_atlas_free (CoglAtlas *atlas);
 
 COGL_OBJECT_INTERNAL_DEFINE (Atlas, atlas);
@@ -63,6 +77,8 @@ _cogl_atlas_new (CoglPixelFormat texture_format,
   atlas->texture_format = texture_format;
   g_hook_list_init (&atlas->pre_reorganize_callbacks, sizeof (GHook));
   g_hook_list_init (&atlas->post_reorganize_callbacks, sizeof (GHook));
+  atlas->compact_idle = NULL;
+  atlas->stats = (CoglAtlasStats) { 0 };
 
   return _cogl_atlas_object_new (atlas);
 }
@@ -72,6 +88,8 @@ _cogl_atlas_free (CoglAtlas *atlas)
 {
   COGL_NOTE (ATLAS, "%p: Atlas destroyed", atlas);
 
+  g_clear_pointer (&atlas->compact_idle, _cogl_closure_disconnect);
+
   if (atlas->texture)
     cogl_object_unref (atlas->texture);
   if (atlas->map)
@@ -83,6 +101,35 @@ _cogl_atlas_free (CoglAtlas *atlas)
   g_free (atlas);
 }
 
+static void
+_cogl_atlas_note_stats (CoglAtlas *atlas)
+{
+  unsigned int width, height;
+  int bpp;
+
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_ATLAS)) || !atlas->map)
+    return;
+
+  width = _cogl_rectangle_map_get_width (atlas->map);
+  height = _cogl_rectangle_map_get_height (atlas->map);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (atlas->texture_format, 0);
+
+  COGL_NOTE (ATLAS,
+             "%p: Atlas is %ux%u (%u bytes), has %u textures and is "
+             "%u%% occupied; %u reorganizations, %u compactions, "
+             "%u rectangles (%" G_GUINT64_FORMAT " bytes) migrated",
+             atlas,
+             width, height,
+             width * height * bpp,
+             _cogl_rectangle_map_get_n_rectangles (atlas->map),
+             100 - (_cogl_rectangle_map_get_remaining_space (atlas->map) *
+                    100 / (width * height)),
+             atlas->stats.n_reorganizations,
+             atlas->stats.n_compactions,
+             atlas->stats.n_migrated_rectangles,
+             atlas->stats.migrated_bytes);
+}
+
 typedef struct _CoglAtlasRepositionData
 {
   /* The current user data for this texture */
@@ -114,6 +161,9 @@ _cogl_atlas_migrate (CoglAtlas               *atlas,
                                  &textures[i].new_position);
   else
     {
+      int bpp = cogl_pixel_format_get_bytes_per_pixel (atlas->texture_format,
+                                                       0);
+
       _cogl_blit_begin (&blit_data, new_texture, old_texture);
 
       for (i = 0; i < n_textures; i++)
@@ -121,13 +171,20 @@ _cogl_atlas_migrate (CoglAtlas               *atlas,
           /* Skip the texture that is being added because it doesn't contain
              any data yet */
           if (textures[i].user_data != skip_user_data)
-            _cogl_blit (&blit_data,
-                        textures[i].old_position.x,
-                        textures[i].old_position.y,
-                        textures[i].new_position.x,
-                        textures[i].new_position.y,
-                        textures[i].new_position.width,
-                        textures[i].new_position.height);
+            {
+              _cogl_blit (&blit_data,
+                          textures[i].old_position.x,
+                          textures[i].old_position.y,
+                          textures[i].new_position.x,
+                          textures[i].new_position.y,
+                          textures[i].new_position.width,
+                          textures[i].new_position.height);
+
+              atlas->stats.n_migrated_rectangles++;
+              atlas->stats.migrated_bytes +=
+                (uint64_t) textures[i].new_position.width *
+                textures[i].new_position.height * bpp;
+            }
 
           /* Update the texture position */
           atlas->update_position_cb (textures[i].user_data,
@@ -224,6 +281,7 @@ _cogl_atlas_create_map (CoglPixelFormat          format,
   GLenum gl_intformat;
   GLenum gl_format;
   GLenum gl_type;
+  int bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
 
   _COGL_GET_CONTEXT (ctx, NULL);
 
@@ -235,7 +293,9 @@ _cogl_atlas_create_map (CoglPixelFormat          format,
 
   /* Keep trying increasingly larger atlases until we can fit all of
      the textures */
-  while (ctx->texture_driver->size_supported (ctx,
+  while ((size_t) map_width * map_height * bpp <=
+         COGL_ATLAS_MAX_TEXTURE_BYTES &&
+         ctx->texture_driver->size_supported (ctx,
                                               GL_TEXTURE_2D,
                                               gl_intformat,
                                               gl_format,
@@ -356,6 +416,28 @@ _cogl_atlas_compare_size_cb (const void *a,
   return a_size < b_size ? 1 : a_size > b_size ? -1 : 0;
 }
 
+static void
+_cogl_atlas_replace (CoglAtlas               *atlas,
+                     CoglRectangleMap        *new_map,
+                     CoglTexture             *new_texture,
+                     unsigned int             n_textures,
+                     CoglAtlasRepositionData *textures,
+                     void                    *skip_user_data)
+{
+  _cogl_atlas_migrate (atlas,
+                       n_textures,
+                       textures,
+                       atlas->texture,
+                       new_texture,
+                       skip_user_data);
+
+  _cogl_rectangle_map_free (atlas->map);
+  cogl_object_unref (atlas->texture);
+
+  atlas->map = new_map;
+  atlas->texture = new_texture;
+}
+
 static void
 _cogl_atlas_notify_pre_reorganize (CoglAtlas *atlas)
 {
@@ -387,15 +469,7 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                                user_data,
                                &new_position))
     {
-      COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-                 atlas,
-                 _cogl_rectangle_map_get_width (atlas->map),
-                 _cogl_rectangle_map_get_height (atlas->map),
-                 _cogl_rectangle_map_get_n_rectangles (atlas->map),
-                 /* waste as a percentage */
-                 _cogl_rectangle_map_get_remaining_space (atlas->map) *
-                 100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                        _cogl_rectangle_map_get_height (atlas->map)));
+      _cogl_atlas_note_stats (atlas);
 
       atlas->update_position_cb (user_data,
                                  atlas->texture,
@@ -481,8 +555,6 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
     }
   else
     {
-      int waste;
-
       COGL_NOTE (ATLAS,
                  "%p: Atlas %s with size %ix%i",
                  atlas,
@@ -497,37 +569,30 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
 
       if (atlas->map)
         {
+          atlas->stats.n_reorganizations++;
+
           /* Move all the textures to the right position in the new
              texture. This will also update the texture's rectangle */
-          _cogl_atlas_migrate (atlas,
+          _cogl_atlas_replace (atlas,
+                               new_map,
+                               COGL_TEXTURE (new_tex),
                                data.n_textures,
                                data.textures,
-                               atlas->texture,
-                               COGL_TEXTURE (new_tex),
                                user_data);
-          _cogl_rectangle_map_free (atlas->map);
-          cogl_object_unref (atlas->texture);
         }
       else
-        /* We know there's only one texture so we can just directly
-           update the rectangle from its new position */
-        atlas->update_position_cb (data.textures[0].user_data,
-                                   COGL_TEXTURE (new_tex),
-                                   &data.textures[0].new_position);
-
-      atlas->map = new_map;
-      atlas->texture = COGL_TEXTURE (new_tex);
-
-      waste = (_cogl_rectangle_map_get_remaining_space (atlas->map) *
-               100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                      _cogl_rectangle_map_get_height (atlas->map)));
+        {
+          /* We know there's only one texture so we can just directly
+             update the rectangle from its new position */
+          atlas->update_position_cb (data.textures[0].user_data,
+                                     COGL_TEXTURE (new_tex),
+                                     &data.textures[0].new_position);
+
+          atlas->map = new_map;
+          atlas->texture = COGL_TEXTURE (new_tex);
+        }
 
-      COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-                 atlas,
-                 _cogl_rectangle_map_get_width (atlas->map),
-                 _cogl_rectangle_map_get_height (atlas->map),
-                 _cogl_rectangle_map_get_n_rectangles (atlas->map),
-                 waste);
+      _cogl_atlas_note_stats (atlas);
 
       ret = TRUE;
     }
@@ -539,6 +604,138 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
   return ret;
 }
 
+static void
+_cogl_atlas_compact (CoglAtlas *atlas)
+{
+  CoglAtlasGetRectanglesData data;
+  CoglRectangleMap *new_map;
+  CoglTexture2D *new_tex = NULL;
+  unsigned int old_width, old_height;
+  unsigned int map_width, map_height;
+  unsigned int used_space;
+
+  if (atlas->map == NULL ||
+      _cogl_rectangle_map_get_n_rectangles (atlas->map) == 0)
+    return;
+
+  old_width = _cogl_rectangle_map_get_width (atlas->map);
+  old_height = _cogl_rectangle_map_get_height (atlas->map);
+  used_space = (old_width * old_height -
+                _cogl_rectangle_map_get_remaining_space (atlas->map));
+
+  data.n_textures = 0;
+  data.textures = g_new (CoglAtlasRepositionData,
+                         _cogl_rectangle_map_get_n_rectangles (atlas->map));
+  _cogl_rectangle_map_foreach (atlas->map,
+                               _cogl_atlas_get_rectangles_cb,
+                               &data);
+
+  qsort (data.textures, data.n_textures,
+         sizeof (CoglAtlasRepositionData),
+         _cogl_atlas_compare_size_cb);
+
+  /* Leave at least as much free space as is used so that adding a few
+     more rectangles doesn't immediately grow the atlas again */
+  _cogl_atlas_get_initial_size (atlas->texture_format,
+                                &map_width, &map_height);
+  while (map_width * map_height < used_space * 2)
+    _cogl_atlas_get_next_size (&map_width, &map_height);
+
+  if (map_width * map_height >= old_width * old_height)
+    {
+      g_free (data.textures);
+      return;
+    }
+
+  new_map = _cogl_atlas_create_map (atlas->texture_format,
+                                    map_width, map_height,
+                                    data.n_textures, data.textures);
+
+  if (new_map == NULL ||
+      (_cogl_rectangle_map_get_width (new_map) *
+       _cogl_rectangle_map_get_height (new_map) >= old_width * old_height) ||
+      (new_tex = _cogl_atlas_create_texture
+       (atlas,
+        _cogl_rectangle_map_get_width (new_map),
+        _cogl_rectangle_map_get_height (new_map))) == NULL)
+    {
+      COGL_NOTE (ATLAS, "%p: Atlas could not be compacted", atlas);
+      g_clear_pointer (&new_map, _cogl_rectangle_map_free);
+      g_free (data.textures);
+      return;
+    }
+
+  COGL_NOTE (ATLAS, "%p: Atlas compacted from %ux%u to %ux%u",
+             atlas,
+             old_width, old_height,
+             _cogl_rectangle_map_get_width (new_map),
+             _cogl_rectangle_map_get_height (new_map));
+
+  _cogl_atlas_notify_pre_reorganize (atlas);
+
+  atlas->stats.n_compactions++;
+
+  _cogl_atlas_replace (atlas,
+                       new_map,
+                       COGL_TEXTURE (new_tex),
+                       data.n_textures,
+                       data.textures,
+                       NULL);
+
+  g_free (data.textures);
+
+  _cogl_atlas_note_stats (atlas);
+
+  _cogl_atlas_notify_post_reorganize (atlas);
+}
+
+static void
+_cogl_atlas_compact_idle_cb (void *user_data)
+{
+  CoglAtlas *atlas = user_data;
+
+  g_clear_pointer (&atlas->compact_idle, _cogl_closure_disconnect);
+
+  /* Migrating can cause the last reference to the atlas to be dropped
+     by its users so keep it alive until we're done */
+  cogl_object_ref (atlas);
+  _cogl_atlas_compact (atlas);
+  cogl_object_unref (atlas);
+}
+
+static void
+_cogl_atlas_maybe_queue_compaction (CoglAtlas *atlas)
+{
+  unsigned int width, height;
+  unsigned int initial_width, initial_height;
+  unsigned int used_space;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (atlas->compact_idle ||
+      _cogl_rectangle_map_get_n_rectangles (atlas->map) == 0)
+    return;
+
+  width = _cogl_rectangle_map_get_width (atlas->map);
+  height = _cogl_rectangle_map_get_height (atlas->map);
+  used_space = (width * height -
+                _cogl_rectangle_map_get_remaining_space (atlas->map));
+
+  if (used_space * 100 >= width * height * COGL_ATLAS_COMPACT_OCCUPANCY)
+    return;
+
+  _cogl_atlas_get_initial_size (atlas->texture_format,
+                                &initial_width, &initial_height);
+  if (width * height <= initial_width * initial_height)
+    return;
+
+  atlas->compact_idle =
+    _cogl_poll_renderer_add_idle (ctx->display->renderer,
+                                  _cogl_atlas_compact_idle_cb,
+                                  atlas,
+                                  NULL);
+}
+
 void
 _cogl_atlas_remove (CoglAtlas *atlas,
                     const CoglRectangleMapEntry *rectangle)
@@ -549,14 +746,9 @@ _cogl_atlas_remove (CoglAtlas *atlas,
              atlas,
              rectangle->width,
              rectangle->height);
-  COGL_NOTE (ATLAS, "%p: Atlas is %ix%i, has %i textures and is %i%% waste",
-             atlas,
-             _cogl_rectangle_map_get_width (atlas->map),
-             _cogl_rectangle_map_get_height (atlas->map),
-             _cogl_rectangle_map_get_n_rectangles (atlas->map),
-             _cogl_rectangle_map_get_remaining_space (atlas->map) *
-             100 / (_cogl_rectangle_map_get_width (atlas->map) *
-                    _cogl_rectangle_map_get_height (atlas->map)));
+  _cogl_atlas_note_stats (atlas);
+
+  _cogl_atlas_maybe_queue_compaction (atlas);
 };
 
 static CoglTexture *
@@ -684,3 +876,66 @@ _cogl_atlas_remove_reorganize_callback (CoglAtlas            *atlas,
         g_hook_destroy_link (&atlas->post_reorganize_callbacks, hook);
     }
 }
+
+static void
+check_atlas_update_position_cb (void                        *user_data,
+                                CoglTexture                 *new_texture,
+                                const CoglRectangleMapEntry *rect)
+{
+  CoglRectangleMapEntry *position = user_data;
+
+  *position = *rect;
+}
+
+UNIT_TEST (check_atlas_compaction,
+           0 /* no requirements */,
+           0 /* no known failures */)
+{
+  CoglRectangleMapEntry positions[64];
+  CoglAtlas *atlas;
+  unsigned int initial_width, initial_height;
+  unsigned int i;
+
+  atlas = _cogl_atlas_new (COGL_PIXEL_FORMAT_RGBA_8888,
+                           COGL_ATLAS_DISABLE_MIGRATION,
+                           check_atlas_update_position_cb);
+
+  for (i = 0; i < G_N_ELEMENTS (positions); i++)
+    g_assert_true (_cogl_atlas_reserve_space (atlas, 100, 100, &positions[i]));
+
+  _cogl_atlas_get_initial_size (COGL_PIXEL_FORMAT_RGBA_8888,
+                                &initial_width, &initial_height);
+  g_assert_cmpuint (_cogl_rectangle_map_get_width (atlas->map) *
+                    _cogl_rectangle_map_get_height (atlas->map),
+                    >,
+                    initial_width * initial_height);
+  g_assert_null (atlas->compact_idle);
+
+  /* Removing almost everything should queue a compaction */
+  for (i = 2; i < G_N_ELEMENTS (positions); i++)
+    _cogl_atlas_remove (atlas, &positions[i]);
+
+  g_assert_nonnull (atlas->compact_idle);
+
+  _cogl_atlas_compact_idle_cb (atlas);
+
+  g_assert_null (atlas->compact_idle);
+  g_assert_cmpuint (atlas->stats.n_compactions, ==, 1);
+  g_assert_cmpuint (_cogl_rectangle_map_get_width (atlas->map), ==,
+                    initial_width);
+  g_assert_cmpuint (_cogl_rectangle_map_get_height (atlas->map), ==,
+                    initial_height);
+  g_assert_cmpuint (_cogl_rectangle_map_get_n_rectangles (atlas->map), ==, 2);
+
+  /* The remaining rectangles must have been told about their new
+     positions */
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_cmpuint (positions[i].x + positions[i].width, <=,
+                        initial_width);
+      g_assert_cmpuint (positions[i].y + positions[i].height, <=,
+                        initial_height);
+    }
+
+  cogl_object_unref (atlas);
+}
@@ -30,6 +30,7 @@
 #define __COGL_ATLAS_H
 
 #include "cogl-rectangle-map.h"
+#include "cogl-closure-list-private.h"
 #include "cogl-object-private.h"
 #include "cogl-texture.h"
 
@@ -44,6 +45,19 @@ typedef enum
   COGL_ATLAS_DISABLE_MIGRATION = (1 << 1)
 } CoglAtlasFlags;
 
+typedef struct _CoglAtlasStats
+{
+  /* Number of times the atlas was rebuilt to make room for a new
+     rectangle */
+  unsigned int n_reorganizations;
+  /* Number of times the atlas was rebuilt in a smaller texture after
+     rectangles were removed */
+  unsigned int n_compactions;
+  /* Rectangles copied on the GPU while rebuilding the atlas */
+  unsigned int n_migrated_rectangles;
+  uint64_t migrated_bytes;
+} CoglAtlasStats;
+
 typedef struct _CoglAtlas CoglAtlas;
 
 #define COGL_ATLAS(object) ((CoglAtlas *) object)
@@ -62,6 +76,10 @@ struct _CoglAtlas
 
   GHookList pre_reorganize_callbacks;
   GHookList post_reorganize_callbacks;
+
+  CoglClosure *compact_idle;
+
+  CoglAtlasStats stats;
 };
 
 COGL_EXPORT CoglAtlas *
@@ -30,9 +30,12 @@
 
 #include "cogl-config.h"
 
+#include <test-fixtures/test-unit.h>
+
 #include "cogl-private.h"
 #include "cogl-bitmap-private.h"
 #include "cogl-context-private.h"
+#include "cogl-debug.h"
 #include "cogl-texture-private.h"
 
 #include <string.h>
@@ -129,133 +132,403 @@ _cogl_premult_alpha_first (uint8_t *dst)
 
 #undef MULT
 
-/* Use the SSE optimized version to premult four pixels at once when
-   it is available. The same assembler code works for x86 and x86-64
-   because it doesn't refer to any non-SSE registers directly */
-#if defined(__SSE2__) && defined(__GNUC__) \
-  && (defined(__x86_64) || defined(__i386))
-#define COGL_USE_PREMULT_SSE2
+/* Vectorized implementations of the 8-bit per component spans. SSE2 is
+ * always used when the compiler targets it, the SSSE3 and AVX2 versions
+ * are picked at runtime depending on the CPU. */
+#if defined(__GNUC__) && defined(__SSE2__) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define COGL_BITMAP_USE_SSE2
+#include <immintrin.h>
 #endif
 
-#ifdef COGL_USE_PREMULT_SSE2
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define COGL_BITMAP_USE_NEON
+#include <arm_neon.h>
+#endif
 
-inline static void
-_cogl_premult_alpha_last_four_pixels_sse2 (uint8_t *p)
-{
-  /* 8 copies of 128 used below */
-  static const int16_t eight_halves[8] __attribute__ ((aligned (16))) =
-    { 128, 128, 128, 128, 128, 128, 128, 128 };
-  /* Mask of the rgb components of the four pixels */
-  static const int8_t just_rgb[16] __attribute__ ((aligned (16))) =
-    { 0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00 };
-  /* Each SSE register only holds two pixels because we need to work
-     with 16-bit intermediate values. We still do four pixels by
-     interleaving two registers in the hope that it will pipeline
-     better */
-  asm (/* Load eight_halves into xmm5 for later */
-       "movdqa (%1), %%xmm5\n"
-       /* Clear xmm3 */
-       "pxor %%xmm3, %%xmm3\n"
-       /* Load two pixels from p into the low half of xmm0 */
-       "movlps (%0), %%xmm0\n"
-       /* Load the next set of two pixels from p into the low half of xmm1 */
-       "movlps 8(%0), %%xmm1\n"
-       /* Unpack 8 bytes from the low quad-words in each register to 8
-          16-bit values */
-       "punpcklbw %%xmm3, %%xmm0\n"
-       "punpcklbw %%xmm3, %%xmm1\n"
-       /* Copy alpha values of the first pixel in xmm0 to all
-          components of the first pixel in xmm2 */
-       "pshuflw $255, %%xmm0, %%xmm2\n"
-       /* same for xmm1 and xmm3 */
-       "pshuflw $255, %%xmm1, %%xmm3\n"
-       /* The above also copies the second pixel directly so we now
-          want to replace the RGB components with copies of the alpha
-          components */
-       "pshufhw $255, %%xmm2, %%xmm2\n"
-       "pshufhw $255, %%xmm3, %%xmm3\n"
-       /* Multiply the rgb components by the alpha */
-       "pmullw %%xmm2, %%xmm0\n"
-       "pmullw %%xmm3, %%xmm1\n"
-       /* Add 128 to each component */
-       "paddw %%xmm5, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Copy the results to temporary registers xmm4 and xmm5 */
-       "movdqa %%xmm0, %%xmm4\n"
-       "movdqa %%xmm1, %%xmm5\n"
-       /* Divide the results by 256 */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Add the temporaries back in */
-       "paddw %%xmm4, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Divide again */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Pack the results back as bytes */
-       "packuswb %%xmm1, %%xmm0\n"
-       /* Load just_rgb into xmm3 for later */
-       "movdqa (%2), %%xmm3\n"
-       /* Reload all four pixels into xmm2 */
-       "movups (%0), %%xmm2\n"
-       /* Mask out the alpha from the results */
-       "andps %%xmm3, %%xmm0\n"
-       /* Mask out the RGB from the original four pixels */
-       "andnps %%xmm2, %%xmm3\n"
-       /* Combine the two to get the right alpha values */
-       "orps %%xmm3, %%xmm0\n"
-       /* Write to memory */
-       "movdqu %%xmm0, (%0)\n"
-       : /* no outputs */
-       : "r" (p), "r" (eight_halves), "r" (just_rgb)
-       : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5");
-}
-
-#endif /* COGL_USE_PREMULT_SSE2 */
+static inline gboolean
+use_simd (void)
+{
+  return !COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FAST_CONVERSION);
+}
 
-static void
-_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
-                                      int width)
+#ifdef COGL_BITMAP_USE_SSE2
+
+typedef enum
+{
+  COGL_CPU_FEATURE_SSSE3 = 1 << 0,
+  COGL_CPU_FEATURE_AVX2 = 1 << 1,
+} CoglCpuFeatures;
+
+static CoglCpuFeatures
+get_cpu_features (void)
 {
-#ifdef COGL_USE_PREMULT_SSE2
+  static gsize features = 0;
 
-  /* Process 4 pixels at a time */
-  while (width >= 4)
+  if (g_once_init_enter (&features))
     {
-      _cogl_premult_alpha_last_four_pixels_sse2 (data);
-      data += 4 * 4;
-      width -= 4;
+      gsize detected = (gsize) 1 << 31; /* never zero */
+
+      __builtin_cpu_init ();
+      if (__builtin_cpu_supports ("ssse3"))
+        detected |= COGL_CPU_FEATURE_SSSE3;
+      if (__builtin_cpu_supports ("avx2"))
+        detected |= COGL_CPU_FEATURE_AVX2;
+
+      g_once_init_leave (&features, detected);
     }
 
-  /* If there are any pixels left we will fall through and
-     handle them below */
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FAST_CONVERSION)))
+    return 0;
+
+  return features;
+}
+
+/* Multiplies two pixels unpacked to 16-bit components by their alpha,
+ * leaving the alpha itself untouched. Same rounding as MULT. */
+static inline __m128i
+premult_two_pixels_sse2 (__m128i pixels,
+                         int     alpha_index)
+{
+  const __m128i alpha_lanes = alpha_index == 0 ?
+    _mm_set_epi16 (0, 0, 0, -1, 0, 0, 0, -1) :
+    _mm_set_epi16 (-1, 0, 0, 0, -1, 0, 0, 0);
+  __m128i alpha;
+  __m128i t;
+
+  if (alpha_index == 0)
+    alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (pixels, 0x00), 0x00);
+  else
+    alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (pixels, 0xff), 0xff);
+
+  /* Multiplying the alpha by 255 gives back the alpha exactly */
+  alpha = _mm_or_si128 (_mm_andnot_si128 (alpha_lanes, alpha),
+                        _mm_and_si128 (alpha_lanes, _mm_set1_epi16 (255)));
+
+  t = _mm_add_epi16 (_mm_mullo_epi16 (pixels, alpha), _mm_set1_epi16 (128));
+
+  return _mm_srli_epi16 (_mm_add_epi16 (_mm_srli_epi16 (t, 8), t), 8);
+}
+
+static int
+premult_span_sse2 (uint8_t *data,
+                   int      width,
+                   int      alpha_index)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4, data += 16)
+    {
+      __m128i pixels = _mm_loadu_si128 ((__m128i *) data);
+      __m128i lo = _mm_unpacklo_epi8 (pixels, zero);
+      __m128i hi = _mm_unpackhi_epi8 (pixels, zero);
+
+      lo = premult_two_pixels_sse2 (lo, alpha_index);
+      hi = premult_two_pixels_sse2 (hi, alpha_index);
+
+      _mm_storeu_si128 ((__m128i *) data, _mm_packus_epi16 (lo, hi));
+    }
+
+  return x;
+}
+
+/* Divides one pixel unpacked to 32-bit components by its alpha. Doing
+ * the division in single precision gives the exact same results as the
+ * integer division for all 8-bit inputs. */
+static inline __m128i
+unpremult_pixel_sse2 (__m128i pixel,
+                      int     alpha_index)
+{
+  const __m128i alpha_lane = alpha_index == 0 ?
+    _mm_set_epi32 (0, 0, 0, -1) :
+    _mm_set_epi32 (-1, 0, 0, 0);
+  __m128i alpha;
+  __m128i result;
+  __m128 quotient;
+
+  if (alpha_index == 0)
+    alpha = _mm_shuffle_epi32 (pixel, 0x00);
+  else
+    alpha = _mm_shuffle_epi32 (pixel, 0xff);
+
+  quotient = _mm_div_ps (_mm_mul_ps (_mm_cvtepi32_ps (pixel),
+                                     _mm_set1_ps (255.0f)),
+                         _mm_cvtepi32_ps (alpha));
+  result = _mm_and_si128 (_mm_cvttps_epi32 (quotient), _mm_set1_epi32 (0xff));
+
+  /* Fully transparent pixels become transparent black */
+  result = _mm_andnot_si128 (_mm_cmpeq_epi32 (alpha, _mm_setzero_si128 ()),
+                             result);
+
+  return _mm_or_si128 (_mm_andnot_si128 (alpha_lane, result),
+                       _mm_and_si128 (alpha_lane, pixel));
+}
 
-#endif /* COGL_USE_PREMULT_SSE2 */
+static int
+unpremult_span_sse2 (uint8_t *data,
+                     int      width,
+                     int      alpha_index)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4, data += 16)
+    {
+      __m128i pixels = _mm_loadu_si128 ((__m128i *) data);
+      __m128i lo = _mm_unpacklo_epi8 (pixels, zero);
+      __m128i hi = _mm_unpackhi_epi8 (pixels, zero);
+      __m128i p0 = unpremult_pixel_sse2 (_mm_unpacklo_epi16 (lo, zero),
+                                         alpha_index);
+      __m128i p1 = unpremult_pixel_sse2 (_mm_unpackhi_epi16 (lo, zero),
+                                         alpha_index);
+      __m128i p2 = unpremult_pixel_sse2 (_mm_unpacklo_epi16 (hi, zero),
+                                         alpha_index);
+      __m128i p3 = unpremult_pixel_sse2 (_mm_unpackhi_epi16 (hi, zero),
+                                         alpha_index);
+
+      _mm_storeu_si128 ((__m128i *) data,
+                        _mm_packus_epi16 (_mm_packs_epi32 (p0, p1),
+                                          _mm_packs_epi32 (p2, p3)));
+    }
+
+  return x;
+}
+
+__attribute__ ((target ("avx2")))
+static int
+premult_span_avx2 (uint8_t *data,
+                   int      width,
+                   int      alpha_index)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i alpha_lanes = alpha_index == 0 ?
+    _mm256_set1_epi64x (0x000000000000ffffLL) :
+    _mm256_set1_epi64x ((long long) 0xffff000000000000ULL);
+  int x;
+
+  for (x = 0; x + 8 <= width; x += 8, data += 32)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((__m256i *) data);
+      __m256i halves[2];
+      int i;
+
+      /* Unpacking and packing both work per 128-bit lane, so the
+       * pixels end up back in their original order */
+      halves[0] = _mm256_unpacklo_epi8 (pixels, zero);
+      halves[1] = _mm256_unpackhi_epi8 (pixels, zero);
+
+      for (i = 0; i < 2; i++)
+        {
+          __m256i alpha;
+          __m256i t;
+
+          if (alpha_index == 0)
+            alpha = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (halves[i],
+                                                                    0x00),
+                                            0x00);
+          else
+            alpha = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (halves[i],
+                                                                    0xff),
+                                            0xff);
+
+          alpha = _mm256_or_si256 (_mm256_andnot_si256 (alpha_lanes, alpha),
+                                   _mm256_and_si256 (alpha_lanes,
+                                                     _mm256_set1_epi16 (255)));
+
+          t = _mm256_add_epi16 (_mm256_mullo_epi16 (halves[i], alpha),
+                                _mm256_set1_epi16 (128));
+          halves[i] = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_srli_epi16 (t, 8),
+                                                           t),
+                                         8);
+        }
+
+      _mm256_storeu_si256 ((__m256i *) data,
+                           _mm256_packus_epi16 (halves[0], halves[1]));
+    }
+
+  return x;
+}
+
+__attribute__ ((target ("ssse3")))
+static int
+swizzle_span_ssse3 (const uint8_t *shuffle,
+                    const uint8_t *src,
+                    uint8_t       *dst,
+                    int            width)
+{
+  const __m128i mask = _mm_loadu_si128 ((const __m128i *) shuffle);
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4, src += 16, dst += 16)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) src);
+
+      _mm_storeu_si128 ((__m128i *) dst, _mm_shuffle_epi8 (pixels, mask));
+    }
+
+  return x;
+}
+
+__attribute__ ((target ("avx2")))
+static int
+swizzle_span_avx2 (const uint8_t *shuffle,
+                   const uint8_t *src,
+                   uint8_t       *dst,
+                   int            width)
+{
+  const __m256i mask =
+    _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) shuffle));
+  int x;
+
+  for (x = 0; x + 8 <= width; x += 8, src += 32, dst += 32)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) src);
+
+      _mm256_storeu_si256 ((__m256i *) dst,
+                           _mm256_shuffle_epi8 (pixels, mask));
+    }
+
+  return x;
+}
+
+#endif /* COGL_BITMAP_USE_SSE2 */
+
+#ifdef COGL_BITMAP_USE_NEON
+
+static inline uint8x16_t
+premult_component_neon (uint8x16_t component,
+                        uint8x16_t alpha)
+{
+  const uint16x8_t half = vdupq_n_u16 (128);
+  uint16x8_t lo, hi;
+
+  lo = vaddq_u16 (vmull_u8 (vget_low_u8 (component), vget_low_u8 (alpha)),
+                  half);
+  hi = vaddq_u16 (vmull_u8 (vget_high_u8 (component), vget_high_u8 (alpha)),
+                  half);
+
+  return vcombine_u8 (vshrn_n_u16 (vsraq_n_u16 (lo, lo, 8), 8),
+                      vshrn_n_u16 (vsraq_n_u16 (hi, hi, 8), 8));
+}
+
+static int
+premult_span_neon (uint8_t *data,
+                   int      width,
+                   int      alpha_index)
+{
+  int x;
+
+  for (x = 0; x + 16 <= width; x += 16, data += 64)
+    {
+      uint8x16x4_t pixels = vld4q_u8 (data);
+      uint8x16_t alpha = pixels.val[alpha_index];
+      int i;
+
+      for (i = 0; i < 4; i++)
+        {
+          if (i != alpha_index)
+            pixels.val[i] = premult_component_neon (pixels.val[i], alpha);
+        }
+
+      vst4q_u8 (data, pixels);
+    }
+
+  return x;
+}
+
+static int
+swizzle_span_neon (const uint8_t *shuffle,
+                   const uint8_t *src,
+                   uint8_t       *dst,
+                   int            width)
+{
+  const uint8x16_t mask = vld1q_u8 (shuffle);
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4, src += 16, dst += 16)
+    vst1q_u8 (dst, vqtbl1q_u8 (vld1q_u8 (src), mask));
+
+  return x;
+}
+
+#endif /* COGL_BITMAP_USE_NEON */
+
+/* Premultiplies a span of 8888 pixels in place. @alpha_index is the
+ * byte offset of the alpha component within a pixel, 0 or 3 */
+static void
+_cogl_bitmap_premult_span_8888 (uint8_t *data,
+                                int      width,
+                                int      alpha_index)
+{
+  int done = 0;
+
+#ifdef COGL_BITMAP_USE_SSE2
+  if (get_cpu_features () & COGL_CPU_FEATURE_AVX2)
+    done = premult_span_avx2 (data, width, alpha_index);
+  if (use_simd ())
+    done += premult_span_sse2 (data + done * 4, width - done, alpha_index);
+#elif defined (COGL_BITMAP_USE_NEON)
+  if (use_simd ())
+    done = premult_span_neon (data, width, alpha_index);
+#endif
+
+  data += done * 4;
+  width -= done;
 
   while (width-- > 0)
     {
-      _cogl_premult_alpha_last (data);
+      if (alpha_index == 0)
+        _cogl_premult_alpha_first (data);
+      else
+        _cogl_premult_alpha_last (data);
       data += 4;
     }
 }
 
+/* Unpremultiplies a span of 8888 pixels in place, see
+ * _cogl_bitmap_premult_span_8888() */
 static void
-_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
-                                        int width)
+_cogl_bitmap_unpremult_span_8888 (uint8_t *data,
+                                  int      width,
+                                  int      alpha_index)
 {
-  int x;
+  int done = 0;
+
+#ifdef COGL_BITMAP_USE_SSE2
+  if (use_simd ())
+    done = unpremult_span_sse2 (data, width, alpha_index);
+#endif
+
+  data += done * 4;
+  width -= done;
 
-  for (x = 0; x < width; x++)
+  while (width-- > 0)
     {
-      if (data[3] == 0)
+      if (data[alpha_index] == 0)
         _cogl_unpremult_alpha_0 (data);
+      else if (alpha_index == 0)
+        _cogl_unpremult_alpha_first (data);
       else
         _cogl_unpremult_alpha_last (data);
       data += 4;
     }
 }
 
+static void
+_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
+                                      int width)
+{
+  _cogl_bitmap_premult_span_8888 (data, width, 3);
+}
+
+static void
+_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
+                                        int width)
+{
+  _cogl_bitmap_unpremult_span_8888 (data, width, 3);
+}
+
 static void
 _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
                                          int width)
@@ -370,6 +643,365 @@ _cogl_bitmap_needs_short_temp_buffer (CoglPixelFormat format)
   return FALSE;
 }
 
+/* Direct conversions to 8888 formats, skipping the temporary RGBA row */
+
+typedef struct _CoglFastConversion CoglFastConversion;
+
+typedef void (* CoglFastConversionFunc) (const CoglFastConversion *conversion,
+                                         const uint8_t            *src,
+                                         uint8_t                  *dst,
+                                         int                       width);
+
+struct _CoglFastConversion
+{
+  CoglFastConversionFunc convert;
+
+  /* Byte offset of the red, green, blue and alpha components in a
+   * destination pixel */
+  int dst_index[4];
+
+  /* Source byte of each destination byte for four pixels, for 8888
+   * sources */
+  uint8_t shuffle[16];
+
+  /* Position and width of the red, green, blue and alpha components
+   * in the source word for packed sources. A width of 0 means the
+   * component is missing and will be opaque */
+  int src_shift[4];
+  int src_bits[4];
+
+  void (* premult) (uint8_t *data,
+                    int      width,
+                    int      alpha_index);
+};
+
+static gboolean
+get_8888_layout (CoglPixelFormat  format,
+                 int             *index)
+{
+  static const int layouts[][4] = {
+    { 0, 1, 2, 3 }, /* RGBA */
+    { 2, 1, 0, 3 }, /* BGRA */
+    { 1, 2, 3, 0 }, /* ARGB */
+    { 3, 2, 1, 0 }, /* ABGR */
+  };
+  int layout;
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      layout = 0;
+      break;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      layout = 1;
+      break;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      layout = 2;
+      break;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      layout = 3;
+      break;
+    default:
+      return FALSE;
+    }
+
+  memcpy (index, layouts[layout], sizeof (layouts[layout]));
+
+  return TRUE;
+}
+
+static gboolean
+get_packed_layout (CoglPixelFormat  format,
+                   int             *shift,
+                   int             *bits)
+{
+  /* Shift and width of red, green, blue and alpha, matching the
+   * unpack functions in cogl-bitmap-packing.h, which also read the
+   * padding bits of the X formats as alpha */
+  static const struct
+  {
+    CoglPixelFormat format;
+    int shift[4];
+    int bits[4];
+  } layouts[] = {
+    { COGL_PIXEL_FORMAT_RGB_565, { 11, 5, 0, 0 }, { 5, 6, 5, 0 } },
+    { COGL_PIXEL_FORMAT_RGBA_1010102, { 22, 12, 2, 0 }, { 10, 10, 10, 2 } },
+    { COGL_PIXEL_FORMAT_BGRA_1010102, { 2, 12, 22, 0 }, { 10, 10, 10, 2 } },
+    { COGL_PIXEL_FORMAT_XRGB_2101010, { 20, 10, 0, 30 }, { 10, 10, 10, 2 } },
+    { COGL_PIXEL_FORMAT_ARGB_2101010, { 20, 10, 0, 30 }, { 10, 10, 10, 2 } },
+    { COGL_PIXEL_FORMAT_XBGR_2101010, { 0, 10, 20, 30 }, { 10, 10, 10, 2 } },
+    { COGL_PIXEL_FORMAT_ABGR_2101010, { 0, 10, 20, 30 }, { 10, 10, 10, 2 } },
+  };
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (layouts); i++)
+    {
+      if (layouts[i].format == (format & ~COGL_PREMULT_BIT))
+        {
+          memcpy (shift, layouts[i].shift, sizeof (layouts[i].shift));
+          memcpy (bits, layouts[i].bits, sizeof (layouts[i].bits));
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+convert_swizzle (const CoglFastConversion *conversion,
+                 const uint8_t            *src,
+                 uint8_t                  *dst,
+                 int                       width)
+{
+  int done = 0;
+
+#ifdef COGL_BITMAP_USE_SSE2
+  CoglCpuFeatures features = get_cpu_features ();
+
+  if (features & COGL_CPU_FEATURE_AVX2)
+    done = swizzle_span_avx2 (conversion->shuffle, src, dst, width);
+  if (features & COGL_CPU_FEATURE_SSSE3)
+    done += swizzle_span_ssse3 (conversion->shuffle,
+                                src + done * 4, dst + done * 4,
+                                width - done);
+#elif defined (COGL_BITMAP_USE_NEON)
+  if (use_simd ())
+    done = swizzle_span_neon (conversion->shuffle, src, dst, width);
+#endif
+
+  src += done * 4;
+  dst += done * 4;
+  width -= done;
+
+  while (width-- > 0)
+    {
+      /* Copy through a temporary so converting in place works */
+      uint8_t pixel[4];
+
+      pixel[0] = src[conversion->shuffle[0]];
+      pixel[1] = src[conversion->shuffle[1]];
+      pixel[2] = src[conversion->shuffle[2]];
+      pixel[3] = src[conversion->shuffle[3]];
+      memcpy (dst, pixel, 4);
+
+      src += 4;
+      dst += 4;
+    }
+}
+
+static inline uint32_t
+unpack_component (uint32_t value,
+                  int      shift,
+                  int      bits)
+{
+  uint32_t max = (1 << bits) - 1;
+
+  if (bits == 0)
+    return 255;
+
+  /* Same as the UNPACK_* macros in cogl-bitmap-packing.h */
+  return (((value >> shift) & max) * 255 + (max >> 1)) / max;
+}
+
+#ifdef COGL_BITMAP_USE_SSE2
+
+/* Unpacks 16 or 32-bit pixels to 8888, four at a time. Rounding and
+ * scaling a component is (value * 255 + max / 2) / max, as for the
+ * scalar version. That quotient is an integer or at least 1 / max away
+ * from the next one, so adding 0.5 to the dividend and multiplying by
+ * the reciprocal in single precision always truncates to the exact same
+ * result for components of up to 10 bits */
+static int
+unpack_span_sse2 (const CoglFastConversion *conversion,
+                  const uint8_t            *src,
+                  uint8_t                  *dst,
+                  int                       width,
+                  int                       bytes_per_pixel)
+{
+  __m128i shift[4], mask[4], dst_shift[4];
+  __m128 bias[4], scale[4];
+  __m128i opaque = _mm_setzero_si128 ();
+  int n_components = 0;
+  int x, i;
+
+  for (i = 0; i < 4; i++)
+    {
+      int bits = conversion->src_bits[i];
+      int max = (1 << bits) - 1;
+
+      if (bits == 0)
+        {
+          opaque = _mm_or_si128 (opaque,
+                                 _mm_set1_epi32 (0xff << (conversion->dst_index[i] * 8)));
+          continue;
+        }
+
+      shift[n_components] = _mm_cvtsi32_si128 (conversion->src_shift[i]);
+      mask[n_components] = _mm_set1_epi32 (max);
+      dst_shift[n_components] = _mm_cvtsi32_si128 (conversion->dst_index[i] * 8);
+      bias[n_components] = _mm_set1_ps ((max >> 1) + 0.5f);
+      scale[n_components] = _mm_set1_ps (1.0f / max);
+      n_components++;
+    }
+
+  for (x = 0; x + 4 <= width; x += 4)
+    {
+      __m128i pixels;
+      __m128i result = opaque;
+
+      if (bytes_per_pixel == 2)
+        pixels = _mm_unpacklo_epi16 (_mm_loadl_epi64 ((const __m128i *) src),
+                                     _mm_setzero_si128 ());
+      else
+        pixels = _mm_loadu_si128 ((const __m128i *) src);
+
+      for (i = 0; i < n_components; i++)
+        {
+          __m128i component;
+          __m128 scaled;
+
+          component = _mm_and_si128 (_mm_srl_epi32 (pixels, shift[i]),
+                                     mask[i]);
+          scaled = _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (component),
+                                           _mm_set1_ps (255.0f)),
+                               bias[i]);
+          component = _mm_cvttps_epi32 (_mm_mul_ps (scaled, scale[i]));
+
+          result = _mm_or_si128 (result, _mm_sll_epi32 (component,
+                                                        dst_shift[i]));
+        }
+
+      _mm_storeu_si128 ((__m128i *) dst, result);
+
+      src += 4 * bytes_per_pixel;
+      dst += 16;
+    }
+
+  return x;
+}
+
+#endif /* COGL_BITMAP_USE_SSE2 */
+
+static void
+convert_unpack_16 (const CoglFastConversion *conversion,
+                   const uint8_t            *src,
+                   uint8_t                  *dst,
+                   int                       width)
+{
+  int x = 0;
+  int i;
+
+#ifdef COGL_BITMAP_USE_SSE2
+  if (use_simd ())
+    {
+      x = unpack_span_sse2 (conversion, src, dst, width, 2);
+      src += x * 2;
+      dst += x * 4;
+    }
+#endif
+
+  for (; x < width; x++, src += 2, dst += 4)
+    {
+      uint16_t v = *(const uint16_t *) src;
+
+      for (i = 0; i < 4; i++)
+        dst[conversion->dst_index[i]] =
+          unpack_component (v,
+                            conversion->src_shift[i],
+                            conversion->src_bits[i]);
+    }
+}
+
+static void
+convert_unpack_32 (const CoglFastConversion *conversion,
+                   const uint8_t            *src,
+                   uint8_t                  *dst,
+                   int                       width)
+{
+  int x = 0;
+  int i;
+
+#ifdef COGL_BITMAP_USE_SSE2
+  if (use_simd ())
+    {
+      x = unpack_span_sse2 (conversion, src, dst, width, 4);
+      src += x * 4;
+      dst += x * 4;
+    }
+#endif
+
+  for (; x < width; x++, src += 4, dst += 4)
+    {
+      uint32_t v = *(const uint32_t *) src;
+
+      for (i = 0; i < 4; i++)
+        dst[conversion->dst_index[i]] =
+          unpack_component (v,
+                            conversion->src_shift[i],
+                            conversion->src_bits[i]);
+    }
+}
+
+static gboolean
+_cogl_bitmap_get_fast_conversion (CoglPixelFormat     src_format,
+                                  CoglPixelFormat     dst_format,
+                                  gboolean            need_premult,
+                                  CoglFastConversion *conversion)
+{
+  int src_index[4];
+  int i;
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FAST_CONVERSION)))
+    return FALSE;
+
+  memset (conversion, 0, sizeof (CoglFastConversion));
+
+  if (!get_8888_layout (dst_format, conversion->dst_index))
+    return FALSE;
+
+  if (get_8888_layout (src_format, src_index))
+    {
+      for (i = 0; i < 16; i++)
+        {
+          int pixel = i / 4;
+          int component;
+
+          for (component = 0; component < 4; component++)
+            {
+              if (conversion->dst_index[component] == i % 4)
+                break;
+            }
+
+          conversion->shuffle[i] = pixel * 4 + src_index[component];
+        }
+
+      conversion->convert = convert_swizzle;
+    }
+  else if (get_packed_layout (src_format,
+                              conversion->src_shift,
+                              conversion->src_bits))
+    {
+      if (src_format == COGL_PIXEL_FORMAT_RGB_565)
+        conversion->convert = convert_unpack_16;
+      else
+        conversion->convert = convert_unpack_32;
+    }
+  else
+    {
+      return FALSE;
+    }
+
+  if (need_premult)
+    {
+      if (dst_format & COGL_PREMULT_BIT)
+        conversion->premult = _cogl_bitmap_premult_span_8888;
+      else
+        conversion->premult = _cogl_bitmap_unpremult_span_8888;
+    }
+
+  return TRUE;
+}
+
 gboolean
 _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
                                   CoglBitmap *dst_bmp,
@@ -388,6 +1020,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
   CoglPixelFormat dst_format;
   gboolean use_16;
   gboolean need_premult;
+  CoglFastConversion fast_conversion;
 
   src_format = cogl_bitmap_get_format (src_bmp);
   src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
@@ -447,13 +1080,34 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       return FALSE;
     }
 
+  if (_cogl_bitmap_get_fast_conversion (src_format, dst_format,
+                                        need_premult,
+                                        &fast_conversion))
+    {
+      for (y = 0; y < height; y++)
+        {
+          src = src_data + y * src_rowstride;
+          dst = dst_data + y * dst_rowstride;
+
+          fast_conversion.convert (&fast_conversion, src, dst, width);
+
+          if (fast_conversion.premult)
+            fast_conversion.premult (dst, width,
+                                     fast_conversion.dst_index[3]);
+        }
+
+      _cogl_bitmap_unmap (src_bmp);
+      _cogl_bitmap_unmap (dst_bmp);
+
+      return TRUE;
+    }
+
   use_16 = _cogl_bitmap_needs_short_temp_buffer (dst_format);
 
   /* Allocate a buffer to hold a temporary RGBA row */
   tmp_row = g_malloc (width *
                       (use_16 ? sizeof (uint16_t) : sizeof (uint8_t)) * 4);
 
-  /* FIXME: Optimize */
   for (y = 0; y < height; y++)
     {
       src = src_data + y * src_rowstride;
@@ -632,7 +1286,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -669,19 +1323,8 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
         }
       else
         {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
+          _cogl_bitmap_unpremult_span_8888 (p, width,
+                                            format & COGL_AFIRST_BIT ? 0 : 3);
         }
     }
 
@@ -700,7 +1343,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -736,16 +1379,8 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
         }
       else
         {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_premult_unpacked_span_8 (p, width);
+          _cogl_bitmap_premult_span_8888 (p, width,
+                                          format & COGL_AFIRST_BIT ? 0 : 3);
         }
     }
 
@@ -757,3 +1392,129 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 
   return TRUE;
 }
+
+#ifdef ENABLE_UNIT_TESTS
+
+static const CoglPixelFormat fast_conversion_src_formats[] = {
+  COGL_PIXEL_FORMAT_RGBA_8888,
+  COGL_PIXEL_FORMAT_BGRA_8888_PRE,
+  COGL_PIXEL_FORMAT_ARGB_8888,
+  COGL_PIXEL_FORMAT_ABGR_8888_PRE,
+  COGL_PIXEL_FORMAT_RGB_565,
+  COGL_PIXEL_FORMAT_RGBA_1010102,
+  COGL_PIXEL_FORMAT_BGRA_1010102_PRE,
+  COGL_PIXEL_FORMAT_XRGB_2101010,
+  COGL_PIXEL_FORMAT_ARGB_2101010_PRE,
+  COGL_PIXEL_FORMAT_XBGR_2101010,
+  COGL_PIXEL_FORMAT_ABGR_2101010,
+};
+
+static const CoglPixelFormat fast_conversion_dst_formats[] = {
+  COGL_PIXEL_FORMAT_RGBA_8888,
+  COGL_PIXEL_FORMAT_BGRA_8888,
+  COGL_PIXEL_FORMAT_ARGB_8888_PRE,
+  COGL_PIXEL_FORMAT_ABGR_8888_PRE,
+};
+
+static int64_t
+convert_and_time (CoglBitmap *src_bmp,
+                  CoglBitmap *dst_bmp,
+                  gboolean    fast,
+                  int         n_runs)
+{
+  int64_t start_time_us;
+  int i;
+
+  if (fast)
+    COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_FAST_CONVERSION);
+  else
+    COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_FAST_CONVERSION);
+
+  start_time_us = g_get_monotonic_time ();
+
+  for (i = 0; i < n_runs; i++)
+    g_assert_true (_cogl_bitmap_convert_into_bitmap (src_bmp, dst_bmp, NULL));
+
+  return g_get_monotonic_time () - start_time_us;
+}
+
+/* Checks that the fast paths produce the exact same results as the
+ * generic unpack and pack functions. An odd width makes sure the
+ * scalar tails of the vectorized loops get exercised as well. When
+ * running verbosely, both paths are also timed on a larger bitmap */
+UNIT_TEST (check_bitmap_fast_conversion,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  gboolean fast_conversion_disabled =
+    COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FAST_CONVERSION);
+  int width = cogl_test_verbose () ? 1021 : 61;
+  int height = cogl_test_verbose () ? 1024 : 7;
+  int n_runs = cogl_test_verbose () ? 10 : 1;
+  unsigned int i, j;
+  int k;
+
+  for (i = 0; i < G_N_ELEMENTS (fast_conversion_src_formats); i++)
+    {
+      CoglPixelFormat src_format = fast_conversion_src_formats[i];
+      int src_bpp = cogl_pixel_format_get_bytes_per_pixel (src_format, 0);
+      uint8_t *src_data = g_malloc (width * height * src_bpp);
+      CoglBitmap *src_bmp;
+
+      for (k = 0; k < width * height * src_bpp; k++)
+        src_data[k] = g_test_rand_int_range (0, 256);
+
+      src_bmp = cogl_bitmap_new_for_data (test_ctx,
+                                          width, height,
+                                          src_format,
+                                          width * src_bpp,
+                                          src_data);
+
+      for (j = 0; j < G_N_ELEMENTS (fast_conversion_dst_formats); j++)
+        {
+          CoglPixelFormat dst_format = fast_conversion_dst_formats[j];
+          uint8_t *fast_data = g_malloc (width * height * 4);
+          uint8_t *generic_data = g_malloc (width * height * 4);
+          CoglBitmap *fast_bmp, *generic_bmp;
+          int64_t fast_us, generic_us;
+
+          fast_bmp = cogl_bitmap_new_for_data (test_ctx,
+                                               width, height,
+                                               dst_format,
+                                               width * 4,
+                                               fast_data);
+          generic_bmp = cogl_bitmap_new_for_data (test_ctx,
+                                                  width, height,
+                                                  dst_format,
+                                                  width * 4,
+                                                  generic_data);
+
+          fast_us = convert_and_time (src_bmp, fast_bmp, TRUE, n_runs);
+          generic_us = convert_and_time (src_bmp, generic_bmp, FALSE, n_runs);
+
+          g_assert_cmpmem (fast_data, width * height * 4,
+                           generic_data, width * height * 4);
+
+          if (cogl_test_verbose ())
+            g_print ("0x%03x -> 0x%03x: %7.3f ms fast, %7.3f ms generic\n",
+                     src_format, dst_format,
+                     fast_us / 1000.0 / n_runs,
+                     generic_us / 1000.0 / n_runs);
+
+          cogl_object_unref (generic_bmp);
+          cogl_object_unref (fast_bmp);
+          g_free (generic_data);
+          g_free (fast_data);
+        }
+
+      cogl_object_unref (src_bmp);
+      g_free (src_data);
+    }
+
+  if (fast_conversion_disabled)
+    COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_FAST_CONVERSION);
+  else
+    COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_FAST_CONVERSION);
+}
+
+#endif /* ENABLE_UNIT_TESTS */
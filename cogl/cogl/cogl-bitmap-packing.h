@@ -265,7 +265,7 @@ G_PASTE (_cogl_unpack_rgba_1010102_, component_size) (const uint8_t *src,
       dst[2] = UNPACK_10 ((v >> 2) & 0x3ff);
       dst[3] = UNPACK_2 (v & 3);
       dst += 4;
-      src += 2;
+      src += 4;
     }
 }
 
@@ -283,7 +283,7 @@ G_PASTE (_cogl_unpack_bgra_1010102_, component_size) (const uint8_t *src,
       dst[0] = UNPACK_10 ((v >> 2) & 0x3ff);
       dst[3] = UNPACK_2 (v & 3);
       dst += 4;
-      src += 2;
+      src += 4;
     }
 }
 
@@ -301,7 +301,7 @@ G_PASTE (_cogl_unpack_argb_2101010_, component_size) (const uint8_t *src,
       dst[1] = UNPACK_10 ((v >> 10) & 0x3ff);
       dst[2] = UNPACK_10 (v & 0x3ff);
       dst += 4;
-      src += 2;
+      src += 4;
     }
 }
 
@@ -319,7 +319,7 @@ G_PASTE (_cogl_unpack_abgr_2101010_, component_size) (const uint8_t *src,
       dst[1] = UNPACK_10 ((v >> 10) & 0x3ff);
       dst[0] = UNPACK_10 (v & 0x3ff);
       dst += 4;
-      src += 2;
+      src += 4;
     }
 }
 
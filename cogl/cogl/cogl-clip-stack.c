@@ -161,7 +161,6 @@ _cogl_clip_stack_push_rectangle (CoglClipStack *stack,
   CoglClipStackRect *entry;
   graphene_matrix_t modelview;
   graphene_matrix_t projection;
-  graphene_matrix_t modelview_projection;
 
   /* Corners of the given rectangle in an clockwise order:
    *  (0, 1)     (2, 3)
@@ -192,8 +191,6 @@ _cogl_clip_stack_push_rectangle (CoglClipStack *stack,
   cogl_matrix_entry_get (modelview_entry, &modelview);
   cogl_matrix_entry_get (projection_entry, &projection);
 
-  graphene_matrix_multiply (&modelview, &projection, &modelview_projection);
-
   /* Technically we could avoid the viewport transform at this point
    * if we want to make this a bit faster. */
   _cogl_transform_point (&modelview, &projection, viewport, &rect[0], &rect[1]);
@@ -146,6 +146,9 @@ struct _CoglContext
   /* Global journal buffers */
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
+  GArray           *journal_reorder_batches;
+  GArray           *journal_reorder_indices;
+  GArray           *journal_reorder_entries;
 
   /* Some simple caching, to minimize state changes... */
   CoglPipeline     *current_pipeline;
@@ -164,6 +167,12 @@ struct _CoglContext
 
   gboolean              legacy_depth_test_enabled;
 
+  /* Number of GL state changes issued and skipped because the cached
+     state already matched since the last frame was swapped. These are
+     only logged with COGL_DEBUG=gl-state */
+  unsigned int      gl_state_changes_issued;
+  unsigned int      gl_state_changes_elided;
+
   CoglBuffer       *current_buffer[COGL_BUFFER_BIND_TARGET_COUNT];
 
   /* Framebuffers */
@@ -317,4 +326,21 @@ void
 _cogl_context_set_current_modelview_entry (CoglContext *context,
                                            CoglMatrixEntry *entry);
 
+/* Accounts for a GL state change that is only issued if @changed is
+ * TRUE, and returns @changed. */
+static inline gboolean
+_cogl_context_gl_state_changed (CoglContext *context,
+                                gboolean     changed)
+{
+  if (changed)
+    context->gl_state_changes_issued++;
+  else
+    context->gl_state_changes_elided++;
+
+  return changed;
+}
+
+void
+_cogl_context_note_frame_gl_state_changes (CoglContext *context);
+
 #endif /* __COGL_CONTEXT_PRIVATE_H */
@@ -252,6 +252,9 @@ cogl_context_new (CoglDisplay *display,
   context->journal_flush_attributes_array =
     g_array_new (TRUE, FALSE, sizeof (CoglAttribute *));
   context->journal_clip_bounds = NULL;
+  context->journal_reorder_batches = NULL;
+  context->journal_reorder_indices = NULL;
+  context->journal_reorder_entries = NULL;
 
   context->current_pipeline = NULL;
   context->current_pipeline_changes_since_flush = 0;
@@ -278,6 +281,9 @@ cogl_context_new (CoglDisplay *display,
 
   context->legacy_depth_test_enabled = FALSE;
 
+  context->gl_state_changes_issued = 0;
+  context->gl_state_changes_elided = 0;
+
   context->pipeline_cache = _cogl_pipeline_cache_new ();
 
   for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
@@ -350,6 +356,12 @@ _cogl_context_free (CoglContext *context)
     g_array_free (context->journal_flush_attributes_array, TRUE);
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
+  if (context->journal_reorder_batches)
+    g_array_free (context->journal_reorder_batches, TRUE);
+  if (context->journal_reorder_indices)
+    g_array_free (context->journal_reorder_indices, TRUE);
+  if (context->journal_reorder_entries)
+    g_array_free (context->journal_reorder_entries, TRUE);
 
   if (context->rectangle_byte_indices)
     cogl_object_unref (context->rectangle_byte_indices);
@@ -461,6 +473,21 @@ _cogl_context_set_current_modelview_entry (CoglContext *context,
   context->current_modelview_entry = entry;
 }
 
+void
+_cogl_context_note_frame_gl_state_changes (CoglContext *context)
+{
+  unsigned int total = (context->gl_state_changes_issued +
+                        context->gl_state_changes_elided);
+
+  COGL_NOTE (GL_STATE, "%u GL state changes issued, %u elided (%.1f%%)",
+             context->gl_state_changes_issued,
+             context->gl_state_changes_elided,
+             total ? 100.0 * context->gl_state_changes_elided / total : 0.0);
+
+  context->gl_state_changes_issued = 0;
+  context->gl_state_changes_elided = 0;
+}
+
 CoglGraphicsResetStatus
 cogl_get_graphics_reset_status (CoglContext *context)
 {
@@ -527,3 +554,22 @@ cogl_context_get_gpu_time_ns (CoglContext *context)
 
   return context->driver_vtable->get_gpu_time_ns (context);
 }
+
+gboolean
+cogl_context_warm_up_programs (CoglContext *context,
+                               int64_t      budget_us)
+{
+  if (!context->driver_vtable->warm_up_programs)
+    return FALSE;
+
+  return context->driver_vtable->warm_up_programs (context, budget_us);
+}
+
+void
+cogl_context_save_program_list (CoglContext *context)
+{
+  if (!context->driver_vtable->save_program_list)
+    return;
+
+  context->driver_vtable->save_program_list (context);
+}
@@ -393,6 +393,39 @@ cogl_context_timestamp_query_get_time_ns (CoglContext        *context,
 COGL_EXPORT int64_t
 cogl_context_get_gpu_time_ns (CoglContext *context);
 
+/**
+ * cogl_context_warm_up_programs:
+ * @context: a #CoglContext pointer
+ * @budget_us: the time in microseconds that may be spent in this call
+ *
+ * Loads some of the GPU programs that were used during the previous
+ * session ahead of time, so that drawing with the corresponding
+ * pipelines for the first time doesn't stall on linking them. At least
+ * one program is loaded per call, more as long as @budget_us allows.
+ *
+ * This is meant to be called repeatedly from an idle handler once the
+ * first frame has been drawn, until it returns %FALSE. The list of
+ * programs used in this session is saved at that point; use
+ * cogl_context_save_program_list() to save it again later.
+ *
+ * Return value: %TRUE if there are programs left to load
+ */
+COGL_EXPORT gboolean
+cogl_context_warm_up_programs (CoglContext *context,
+                               int64_t      budget_us);
+
+/**
+ * cogl_context_save_program_list:
+ * @context: a #CoglContext pointer
+ *
+ * Saves the list of GPU programs used in this session, so that the
+ * next session loads them ahead of time with
+ * cogl_context_warm_up_programs(). This is cheap if no program was used
+ * for the first time since the list was last saved.
+ */
+COGL_EXPORT void
+cogl_context_save_program_list (CoglContext *context);
+
 G_END_DECLS
 
 #endif /* __COGL_CONTEXT_H__ */
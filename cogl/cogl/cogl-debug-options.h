@@ -161,6 +161,24 @@ OPT (DISABLE_FAST_READ_PIXEL,
      N_("Disable read pixel optimization"),
      N_("Disable optimization for reading 1px for simple "
         "scenes of opaque rectangles"))
+OPT (DISABLE_FAST_CONVERSION,
+     N_("Root Cause"),
+     "disable-fast-conversion",
+     N_("Disable fast pixel conversions"),
+     N_("Always convert bitmaps through the generic unpack and pack "
+        "functions instead of the vectorized fast paths"))
+OPT (DISABLE_UNIFORM_BUFFERS,
+     N_("Root Cause"),
+     "disable-uniform-buffers",
+     N_("Disable uniform buffers"),
+     N_("Upload the transform uniforms to each GLSL program instead of "
+        "sharing them through a uniform buffer"))
+OPT (DISABLE_JOURNAL_REORDERING,
+     N_("Root Cause"),
+     "disable-journal-reordering",
+     N_("Disable journal reordering"),
+     N_("Flush the journal in the order the rectangles were logged instead "
+        "of moving non-overlapping rectangles together to batch better"))
 OPT (CLIPPING,
      N_("Cogl Tracing"),
      "clipping",
@@ -189,6 +207,12 @@ OPT (TEXTURES,
      "textures",
      N_("Debug texture management"),
      N_("Logs information about texture management"))
+OPT (GL_STATE,
+     N_("Cogl Tracing"),
+     "gl-state",
+     N_("Trace redundant GL state changes"),
+     N_("Logs the number of GL state changes issued and skipped because "
+        "the state was already set for each frame"))
 OPT (STENCILLING,
      N_("Root Cause"),
      "stencilling",
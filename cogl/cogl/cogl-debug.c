@@ -65,6 +65,7 @@ static const GDebugKey cogl_log_debug_keys[] = {
   { "winsys", COGL_DEBUG_WINSYS },
   { "performance", COGL_DEBUG_PERFORMANCE },
   { "textures", COGL_DEBUG_TEXTURES },
+  { "gl-state", COGL_DEBUG_GL_STATE },
 };
 static const int n_cogl_log_debug_keys =
   G_N_ELEMENTS (cogl_log_debug_keys);
@@ -83,6 +84,9 @@ static const GDebugKey cogl_behavioural_debug_keys[] = {
   { "disable-software-clip", COGL_DEBUG_DISABLE_SOFTWARE_CLIP},
   { "disable-program-caches", COGL_DEBUG_DISABLE_PROGRAM_CACHES},
   { "disable-fast-read-pixel", COGL_DEBUG_DISABLE_FAST_READ_PIXEL},
+  { "disable-fast-conversion", COGL_DEBUG_DISABLE_FAST_CONVERSION},
+  { "disable-uniform-buffers", COGL_DEBUG_DISABLE_UNIFORM_BUFFERS},
+  { "disable-journal-reordering", COGL_DEBUG_DISABLE_JOURNAL_REORDERING},
   { "sync-primitive", COGL_DEBUG_SYNC_PRIMITIVE },
   { "sync-frame", COGL_DEBUG_SYNC_FRAME},
   { "stencilling", COGL_DEBUG_STENCILLING },
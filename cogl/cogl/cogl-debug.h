@@ -69,6 +69,9 @@ typedef enum
   COGL_DEBUG_DISABLE_SOFTWARE_CLIP,
   COGL_DEBUG_DISABLE_PROGRAM_CACHES,
   COGL_DEBUG_DISABLE_FAST_READ_PIXEL,
+  COGL_DEBUG_DISABLE_FAST_CONVERSION,
+  COGL_DEBUG_DISABLE_UNIFORM_BUFFERS,
+  COGL_DEBUG_DISABLE_JOURNAL_REORDERING,
   COGL_DEBUG_CLIPPING,
   COGL_DEBUG_WINSYS,
   COGL_DEBUG_PERFORMANCE,
@@ -76,6 +79,7 @@ typedef enum
   COGL_DEBUG_SYNC_FRAME,
   COGL_DEBUG_TEXTURES,
   COGL_DEBUG_STENCILLING,
+  COGL_DEBUG_GL_STATE,
 
   COGL_DEBUG_N_FLAGS
 } CoglDebugFlags;
@@ -245,6 +245,13 @@ struct _CoglDriverVtable
 
   int64_t
   (* get_gpu_time_ns) (CoglContext *context);
+
+  gboolean
+  (* warm_up_programs) (CoglContext *context,
+                        int64_t      budget_us);
+
+  void
+  (* save_program_list) (CoglContext *context);
 };
 
 #define COGL_DRIVER_ERROR (_cogl_driver_error_quark ())
@@ -44,6 +44,9 @@
 #include "cogl-onscreen-template-private.h"
 #include "cogl-clip-stack.h"
 #include "cogl-journal-private.h"
+#include "cogl-buffer-private.h"
+#include "cogl-pixel-buffer.h"
+#include "cogl-poll-private.h"
 #include "cogl-pipeline-state-private.h"
 #include "cogl-primitive-private.h"
 #include "cogl-offscreen.h"
@@ -1579,6 +1582,177 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
   return ret;
 }
 
+typedef struct _CoglReadPixelsAsync
+{
+  CoglFramebuffer *framebuffer;
+  CoglPixelBuffer *pixel_buffer;
+  int rowstride;
+  int height;
+  gboolean flip;
+  GError *error;
+
+  CoglClosure *idle;
+
+  CoglReadPixelsCallback callback;
+  void *user_data;
+} CoglReadPixelsAsync;
+
+static void
+read_pixels_async_free (void *user_data)
+{
+  CoglReadPixelsAsync *async = user_data;
+
+  g_clear_error (&async->error);
+  cogl_clear_object (&async->pixel_buffer);
+  g_object_unref (async->framebuffer);
+  g_free (async);
+}
+
+static void
+read_pixels_async_complete (CoglReadPixelsAsync *async)
+{
+  CoglBuffer *buffer = NULL;
+  CoglBufferAccess access = COGL_BUFFER_ACCESS_READ;
+  uint8_t *pixels = NULL;
+
+  if (async->flip)
+    access |= COGL_BUFFER_ACCESS_WRITE;
+
+  if (!async->error)
+    {
+      buffer = COGL_BUFFER (async->pixel_buffer);
+      pixels = _cogl_buffer_map (buffer, access, 0, &async->error);
+    }
+
+  /* The read was issued without flipping so that it wouldn't have to
+   * map the buffer before the GPU is done with it. Now that the fence
+   * has signalled the rows can be flipped without stalling. */
+  if (pixels && async->flip)
+    {
+      int rowstride = async->rowstride;
+      uint8_t *temprow = g_alloca (rowstride);
+      int y;
+
+      for (y = 0; y < async->height / 2; y++)
+        {
+          uint8_t *top = pixels + y * rowstride;
+          uint8_t *bottom = pixels + (async->height - y - 1) * rowstride;
+
+          memcpy (temprow, top, rowstride);
+          memcpy (top, bottom, rowstride);
+          memcpy (bottom, temprow, rowstride);
+        }
+    }
+
+  async->callback (async->framebuffer,
+                   pixels,
+                   async->rowstride,
+                   async->error,
+                   async->user_data);
+
+  if (pixels)
+    cogl_buffer_unmap (buffer);
+}
+
+static void
+read_pixels_async_fence_cb (CoglFence *fence,
+                            void *user_data)
+{
+  CoglReadPixelsAsync *async = user_data;
+
+  read_pixels_async_complete (async);
+  read_pixels_async_free (async);
+}
+
+static void
+read_pixels_async_idle_cb (void *user_data)
+{
+  CoglReadPixelsAsync *async = user_data;
+
+  read_pixels_async_complete (async);
+  g_clear_pointer (&async->idle, _cogl_closure_disconnect);
+}
+
+void
+cogl_framebuffer_read_pixels_async (CoglFramebuffer        *framebuffer,
+                                    int                     x,
+                                    int                     y,
+                                    int                     width,
+                                    int                     height,
+                                    CoglPixelFormat         format,
+                                    CoglReadPixelsCallback  callback,
+                                    void                   *user_data)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  CoglContext *ctx = priv->context;
+  CoglReadPixelsFlags source = COGL_READ_PIXELS_COLOR_BUFFER;
+  CoglReadPixelsAsync *async;
+  CoglBitmap *bitmap;
+  int bpp;
+
+  g_return_if_fail (cogl_is_framebuffer (framebuffer));
+  g_return_if_fail (cogl_pixel_format_get_n_planes (format) == 1);
+  g_return_if_fail (callback != NULL);
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+  async = g_new0 (CoglReadPixelsAsync, 1);
+  async->framebuffer = g_object_ref (framebuffer);
+  async->rowstride = bpp * width;
+  async->height = height;
+  async->callback = callback;
+  async->user_data = user_data;
+
+  /* Without the pack invert extension the driver flips the rows in
+   * place after reading them, which would map the pixel buffer and
+   * wait for the read to finish, so defer the flip to the callback */
+  if (!cogl_framebuffer_is_y_flipped (framebuffer) &&
+      !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_MESA_PACK_INVERT))
+    {
+      source |= COGL_READ_PIXELS_NO_FLIP;
+      async->flip = TRUE;
+    }
+
+  async->pixel_buffer = cogl_pixel_buffer_new (ctx,
+                                               async->rowstride * height,
+                                               NULL);
+  cogl_buffer_set_update_hint (COGL_BUFFER (async->pixel_buffer),
+                               COGL_BUFFER_UPDATE_HINT_STREAM);
+
+  bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (async->pixel_buffer),
+                                        format,
+                                        width, height,
+                                        async->rowstride,
+                                        0 /* offset */);
+
+  /* With a pixel buffer object this only queues the read on the GPU */
+  if (!_cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  x, y,
+                                                  source,
+                                                  bitmap,
+                                                  &async->error) &&
+      !async->error)
+    {
+      g_set_error_literal (&async->error,
+                           COGL_SYSTEM_ERROR,
+                           COGL_SYSTEM_ERROR_UNSUPPORTED,
+                           "Failed to read pixels from the framebuffer");
+    }
+  cogl_object_unref (bitmap);
+
+  if (!async->error &&
+      cogl_framebuffer_add_fence_callback (framebuffer,
+                                           read_pixels_async_fence_cb,
+                                           async))
+    return;
+
+  async->idle = _cogl_poll_renderer_add_idle (ctx->display->renderer,
+                                              read_pixels_async_idle_cb,
+                                              async,
+                                              read_pixels_async_free);
+}
+
 gboolean
 cogl_framebuffer_is_y_flipped (CoglFramebuffer *framebuffer)
 {
@@ -1460,6 +1460,63 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
                               CoglPixelFormat format,
                               uint8_t *pixels);
 
+/**
+ * CoglReadPixelsCallback:
+ * @framebuffer: The #CoglFramebuffer the pixels were read from
+ * @pixels: (nullable): The pixel data, or %NULL if the read failed
+ * @rowstride: The rowstride of @pixels in bytes
+ * @error: (nullable): The reason the read failed, or %NULL
+ * @user_data: The private data passed to
+ *             cogl_framebuffer_read_pixels_async()
+ *
+ * The callback prototype used with cogl_framebuffer_read_pixels_async().
+ * @pixels is mapped for the duration of the callback only and must be
+ * copied if it is needed afterwards.
+ */
+typedef void (* CoglReadPixelsCallback) (CoglFramebuffer *framebuffer,
+                                         const uint8_t   *pixels,
+                                         int              rowstride,
+                                         const GError    *error,
+                                         void            *user_data);
+
+/**
+ * cogl_framebuffer_read_pixels_async:
+ * @framebuffer: A #CoglFramebuffer
+ * @x: The x position to read from
+ * @y: The y position to read from
+ * @width: The width of the region of rectangles to read
+ * @height: The height of the region of rectangles to read
+ * @format: The pixel format to store the data in
+ * @callback: (scope async): A #CoglReadPixelsCallback to call once the
+ *            pixels are available
+ * @user_data: (closure): Private data that will be passed to @callback
+ *
+ * Queues a read of a rectangle of pixels from the color buffer of
+ * @framebuffer, like cogl_framebuffer_read_pixels(), but without
+ * waiting for the GPU to finish rendering. The pixels are read into a
+ * #CoglPixelBuffer and @callback is called from the Cogl main loop
+ * source once a fence placed after the read has signalled, so mapping
+ * the buffer no longer blocks.
+ *
+ * @callback is always called exactly once, and never before this
+ * function returns. If the driver doesn't support fences the read
+ * happens synchronously and @callback is called from an idle. The
+ * framebuffer is kept alive until @callback has been called.
+ *
+ * To avoid a conversion on the CPU, which needs the pixels to be
+ * mapped straight away, @format should match the internal format of
+ * @framebuffer.
+ */
+COGL_EXPORT void
+cogl_framebuffer_read_pixels_async (CoglFramebuffer        *framebuffer,
+                                    int                     x,
+                                    int                     y,
+                                    int                     width,
+                                    int                     height,
+                                    CoglPixelFormat         format,
+                                    CoglReadPixelsCallback  callback,
+                                    void                   *user_data);
+
 COGL_EXPORT uint32_t
 cogl_framebuffer_error_quark (void);
 
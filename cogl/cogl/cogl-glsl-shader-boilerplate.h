@@ -35,11 +35,27 @@
 
 #define _COGL_COMMON_SHADER_BOILERPLATE \
   "#define COGL_VERSION 100\n" \
-  "\n" \
+  "\n"
+
+/* One of these follows the vertex or fragment boilerplate. When the
+ * driver supports uniform buffers the transform is shared by all of
+ * the generated programs through a uniform block. The flip vector is
+ * then always part of the block because the same matrices are used
+ * for programs with and without vertex snippets */
+#define _COGL_TRANSFORM_UNIFORMS_BOILERPLATE \
   "uniform mat4 cogl_modelview_matrix;\n" \
   "uniform mat4 cogl_modelview_projection_matrix;\n"  \
   "uniform mat4 cogl_projection_matrix;\n"
 
+#define _COGL_TRANSFORM_UNIFORM_BLOCK_BOILERPLATE \
+  "layout(std140) uniform _cogl_transform_block\n" \
+  "{\n" \
+  "  mat4 cogl_modelview_matrix;\n" \
+  "  mat4 cogl_modelview_projection_matrix;\n" \
+  "  mat4 cogl_projection_matrix;\n" \
+  "  vec4 _cogl_flip_vector;\n" \
+  "};\n"
+
 /* This declares all of the variables that we might need. This is
  * working on the assumption that the compiler will optimise them out
  * if they are not actually used. The GLSL spec at least implies that
@@ -96,6 +96,10 @@
    to do the clip */
 #define COGL_JOURNAL_HARDWARE_CLIP_THRESHOLD 8
 
+/* The maximum number of earlier batches that are considered when
+   looking for a batch that an entry could be moved into */
+#define COGL_JOURNAL_REORDER_MAX_LOOKBACK 32
+
 typedef struct _CoglJournalFlushState
 {
   CoglContext *ctx;
@@ -1114,6 +1118,294 @@ compare_entry_viewports (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
   return memcmp (entry0->viewport, entry1->viewport, sizeof (float) * 4) == 0;
 }
 
+typedef struct
+{
+  CoglJournalEntry *first_entry;
+  /* Union of the bounds of all the entries in the batch */
+  ClipBounds bounds;
+  /* The last pipelines found to be compatible and incompatible with
+   * the batch, so runs of entries sharing a pipeline only compare it
+   * once */
+  CoglPipeline *last_merged_pipeline;
+  CoglPipeline *last_rejected_pipeline;
+  int n_entries;
+  int next_entry;
+} ReorderBatch;
+
+/* Calculates the bounds of the entry in normalized device
+ * coordinates. Returns FALSE if the bounds can't be determined, e.g.
+ * because part of the rectangle is behind the viewer */
+static gboolean
+get_entry_device_bounds (CoglJournal             *journal,
+                         CoglJournalEntry        *entry,
+                         const graphene_matrix_t *transform,
+                         ClipBounds              *bounds)
+{
+  size_t array_stride =
+    GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  const float *verts = &g_array_index (journal->vertices, float,
+                                       entry->array_offset + 1);
+  float points[8];
+  float projected[16];
+  int i;
+
+  points[0] = verts[0];
+  points[1] = verts[1];
+  points[2] = verts[0];
+  points[3] = verts[array_stride + 1];
+  points[4] = verts[array_stride];
+  points[5] = verts[array_stride + 1];
+  points[6] = verts[array_stride];
+  points[7] = verts[1];
+
+  cogl_graphene_matrix_project_points (transform,
+                                       2, /* n_components */
+                                       sizeof (float) * 2, /* stride_in */
+                                       points, /* points_in */
+                                       sizeof (float) * 4, /* stride_out */
+                                       projected, /* points_out */
+                                       4 /* n_points */);
+
+  bounds->x_1 = bounds->y_1 = G_MAXFLOAT;
+  bounds->x_2 = bounds->y_2 = -G_MAXFLOAT;
+
+  for (i = 0; i < 4; i++)
+    {
+      float w = projected[4 * i + 3];
+      float x, y;
+
+      if (w <= 0.0f)
+        return FALSE;
+
+      x = projected[4 * i] / w;
+      y = projected[4 * i + 1] / w;
+
+      bounds->x_1 = MIN (bounds->x_1, x);
+      bounds->y_1 = MIN (bounds->y_1, y);
+      bounds->x_2 = MAX (bounds->x_2, x);
+      bounds->y_2 = MAX (bounds->y_2, y);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+bounds_overlap (const ClipBounds *bounds0,
+                const ClipBounds *bounds1)
+{
+  return (bounds0->x_1 < bounds1->x_2 && bounds1->x_1 < bounds0->x_2 &&
+          bounds0->y_1 < bounds1->y_2 && bounds1->y_1 < bounds0->y_2);
+}
+
+static gboolean
+can_merge_entries (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
+{
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)) &&
+      !compare_entry_modelviews (entry0, entry1))
+    return FALSE;
+
+  return (compare_entry_strides (entry0, entry1) &&
+          compare_entry_layer_numbers (entry0, entry1) &&
+          compare_entry_pipelines (entry0, entry1));
+}
+
+static gboolean
+can_merge_into_batch (ReorderBatch     *batch,
+                      CoglJournalEntry *entry,
+                      int              *n_comparisons)
+{
+  CoglPipeline *pipeline = entry->pipeline;
+
+  /* The stride and number of layers only depend on the pipeline, so
+   * an entry with a pipeline that was already checked against the
+   * batch gives the same answer. With software transforms disabled
+   * the modelviews have to be compared too, so don't take the
+   * shortcut then */
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
+    {
+      if (pipeline == batch->first_entry->pipeline ||
+          pipeline == batch->last_merged_pipeline)
+        return TRUE;
+      if (pipeline == batch->last_rejected_pipeline)
+        return FALSE;
+    }
+
+  (*n_comparisons)++;
+
+  if (can_merge_entries (batch->first_entry, entry))
+    {
+      batch->last_merged_pipeline = pipeline;
+      return TRUE;
+    }
+  else
+    {
+      batch->last_rejected_pipeline = pipeline;
+      return FALSE;
+    }
+}
+
+/* At this point we have a run of entries sharing the viewport, dither
+ * state and clip stack. The flush code can only draw runs of
+ * consecutive entries with compatible pipelines in a single call, so
+ * interleaved rectangles, e.g. the glyphs and backgrounds of several
+ * labels, end up with a draw call each. This moves every entry back
+ * to the last earlier batch it is compatible with, as long as it
+ * doesn't overlap any of the entries it would then be drawn before,
+ * so the order of overlapping rectangles is always preserved */
+static void
+reorder_entries (CoglJournalEntry      *batch_start,
+                 int                    batch_len,
+                 CoglJournalFlushState *state)
+{
+  CoglContext *ctx = state->ctx;
+  CoglJournal *journal = state->journal;
+  CoglMatrixStack *projection_stack;
+  CoglMatrixEntry *last_modelview_entry = NULL;
+  graphene_matrix_t projection;
+  graphene_matrix_t transform;
+  CoglJournalEntry *reordered;
+  ReorderBatch *batches;
+  int *batch_indices;
+  int n_batches = 0;
+  int n_comparisons = 0;
+  int entry_num;
+  int i;
+
+  if (batch_len < 3)
+    return;
+
+  projection_stack =
+    _cogl_framebuffer_get_projection_stack (journal->framebuffer);
+  cogl_matrix_stack_get (projection_stack, &projection);
+
+  if (ctx->journal_reorder_batches == NULL)
+    ctx->journal_reorder_batches =
+      g_array_new (FALSE, FALSE, sizeof (ReorderBatch));
+  g_array_set_size (ctx->journal_reorder_batches, batch_len);
+  batches = (ReorderBatch *) ctx->journal_reorder_batches->data;
+
+  if (ctx->journal_reorder_indices == NULL)
+    ctx->journal_reorder_indices = g_array_new (FALSE, FALSE, sizeof (int));
+  g_array_set_size (ctx->journal_reorder_indices, batch_len);
+  batch_indices = (int *) ctx->journal_reorder_indices->data;
+
+  for (entry_num = 0; entry_num < batch_len; entry_num++)
+    {
+      CoglJournalEntry *entry = batch_start + entry_num;
+      ClipBounds bounds;
+      int batch_index = -1;
+
+      if (entry->modelview_entry != last_modelview_entry)
+        {
+          graphene_matrix_t modelview;
+
+          last_modelview_entry = entry->modelview_entry;
+          cogl_matrix_entry_get (last_modelview_entry, &modelview);
+          graphene_matrix_multiply (&modelview, &projection, &transform);
+        }
+
+      if (!get_entry_device_bounds (journal, entry, &transform, &bounds))
+        {
+          bounds.x_1 = bounds.y_1 = -G_MAXFLOAT;
+          bounds.x_2 = bounds.y_2 = G_MAXFLOAT;
+        }
+
+      for (i = n_batches - 1;
+           i >= 0 && i >= n_batches - COGL_JOURNAL_REORDER_MAX_LOOKBACK;
+           i--)
+        {
+          if (can_merge_into_batch (&batches[i], entry, &n_comparisons))
+            {
+              batch_index = i;
+              break;
+            }
+
+          if (bounds_overlap (&batches[i].bounds, &bounds))
+            break;
+        }
+
+      if (batch_index == -1)
+        {
+          batch_index = n_batches++;
+          batches[batch_index].first_entry = entry;
+          batches[batch_index].bounds = bounds;
+          batches[batch_index].last_merged_pipeline = NULL;
+          batches[batch_index].last_rejected_pipeline = NULL;
+          batches[batch_index].n_entries = 0;
+        }
+      else
+        {
+          ClipBounds *batch_bounds = &batches[batch_index].bounds;
+
+          batch_bounds->x_1 = MIN (batch_bounds->x_1, bounds.x_1);
+          batch_bounds->y_1 = MIN (batch_bounds->y_1, bounds.y_1);
+          batch_bounds->x_2 = MAX (batch_bounds->x_2, bounds.x_2);
+          batch_bounds->y_2 = MAX (batch_bounds->y_2, bounds.y_2);
+        }
+
+      batches[batch_index].n_entries++;
+      batch_indices[entry_num] = batch_index;
+    }
+
+  if (n_batches < batch_len)
+    {
+      int next_entry = 0;
+
+      if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+        g_print ("BATCHING:  reordered %d entries into %d batches "
+                 "(%d pipeline comparisons)\n",
+                 batch_len, n_batches, n_comparisons);
+
+      for (i = 0; i < n_batches; i++)
+        {
+          batches[i].next_entry = next_entry;
+          next_entry += batches[i].n_entries;
+        }
+
+      /* Entries within a batch keep their relative order */
+      if (ctx->journal_reorder_entries == NULL)
+        ctx->journal_reorder_entries =
+          g_array_new (FALSE, FALSE, sizeof (CoglJournalEntry));
+      g_array_set_size (ctx->journal_reorder_entries, batch_len);
+      reordered = (CoglJournalEntry *) ctx->journal_reorder_entries->data;
+
+      for (entry_num = 0; entry_num < batch_len; entry_num++)
+        {
+          ReorderBatch *batch = &batches[batch_indices[entry_num]];
+
+          reordered[batch->next_entry++] = batch_start[entry_num];
+        }
+
+      memcpy (batch_start, reordered, sizeof (CoglJournalEntry) * batch_len);
+    }
+}
+
+static void
+_cogl_journal_reorder_entries (CoglJournalEntry *batch_start,
+                               int               batch_len,
+                               void             *data)
+{
+  COGL_STATIC_TIMER (time_reorder_entries,
+                     "Journal Flush", /* parent */
+                     "flush: reordering",
+                     "Time spent reordering entries to batch better",
+                     0 /* no application private data */);
+
+  COGL_TIMER_START (_cogl_uprof_context, time_reorder_entries);
+
+  reorder_entries (batch_start, batch_len, data);
+
+  COGL_TIMER_STOP (_cogl_uprof_context, time_reorder_entries);
+}
+
+static gboolean
+compare_entry_draw_states (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
+{
+  return (compare_entry_viewports (entry0, entry1) &&
+          compare_entry_dither_states (entry0, entry1) &&
+          compare_entry_clip_stacks (entry0, entry1));
+}
+
 /* Gets a new vertex array from the pool. A reference is taken on the
    array so it can be treated as if it was just newly allocated */
 static CoglAttributeBuffer *
@@ -1159,6 +1451,8 @@ upload_vertices (CoglJournal *journal,
   int i;
   CoglMatrixEntry *last_modelview_entry = NULL;
   graphene_matrix_t modelview;
+  gboolean modelview_is_2d_translation = FALSE;
+  float tx = 0.f, ty = 0.f;
 
   g_assert (needed_vbo_len);
 
@@ -1169,9 +1463,9 @@ upload_vertices (CoglJournal *journal,
   vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
                                                       0, /* offset */
                                                       needed_vbo_len * 4);
-  vin = &g_array_index (vertices, float, 0);
-
-  /* Expand the number of vertices from 2 to 4 while uploading */
+  /* Expand the number of vertices from 2 to 4 while uploading. The
+     entries may have been reordered so the logged vertices are looked
+     up for each entry */
   for (entry_num = 0; entry_num < n_entries; entry_num++)
     {
       const CoglJournalEntry *entry = entries + entry_num;
@@ -1179,6 +1473,8 @@ upload_vertices (CoglJournal *journal,
       size_t array_stride =
         GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
 
+      vin = &g_array_index (vertices, float, entry->array_offset);
+
       /* Copy the color to all four of the vertices */
       for (i = 0; i < 4; i++)
         memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
@@ -1209,15 +1505,35 @@ upload_vertices (CoglJournal *journal,
           v[7] = vin[1];
 
           if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-          cogl_graphene_matrix_transform_points (&modelview,
-                                                 2, /* n_components */
-                                                 sizeof (float) * 2, /* stride_in */
-                                                 v, /* points_in */
-                                                 /* strideout */
-                                                 vb_stride * sizeof (float),
-                                                 vout, /* points_out */
-                                                 4 /* n_points */);
+            {
+              last_modelview_entry = entry->modelview_entry;
+              modelview_is_2d_translation =
+                cogl_matrix_entry_is_2d_translation (last_modelview_entry,
+                                                     &tx, &ty);
+              if (!modelview_is_2d_translation)
+                cogl_matrix_entry_get (last_modelview_entry, &modelview);
+            }
+
+          if (modelview_is_2d_translation)
+            {
+              for (i = 0; i < 4; i++)
+                {
+                  vout[vb_stride * i] = v[i * 2] + tx;
+                  vout[vb_stride * i + 1] = v[i * 2 + 1] + ty;
+                  vout[vb_stride * i + 2] = 0.f;
+                }
+            }
+          else
+            {
+              cogl_graphene_matrix_transform_points (&modelview,
+                                                     2, /* n_components */
+                                                     sizeof (float) * 2, /* stride_in */
+                                                     v, /* points_in */
+                                                     /* strideout */
+                                                     vb_stride * sizeof (float),
+                                                     vout, /* points_out */
+                                                     4 /* n_points */);
+            }
         }
 
       for (i = 0; i < entry->n_layers; i++)
@@ -1235,7 +1551,6 @@ upload_vertices (CoglJournal *journal,
           tout[vb_stride * 3 + 1 + i * 2] = tin[i * 2 + 1];
         }
 
-      vin += array_stride * 2;
       vout += vb_stride * 4;
     }
 
@@ -1425,6 +1740,18 @@ _cogl_journal_flush (CoglJournal *journal)
                       &state); /* data */
     }
 
+  /* Move compatible entries that don't overlap anything drawn in
+     between next to each other. This is done after software clipping
+     because that can join clip stack batches */
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_JOURNAL_REORDERING)))
+    {
+      batch_and_call ((CoglJournalEntry *)journal->entries->data,
+                      journal->entries->len,
+                      compare_entry_draw_states,
+                      _cogl_journal_reorder_entries,
+                      &state);
+    }
+
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
   state.attribute_buffer =
@@ -1648,6 +1975,7 @@ entry_to_screen_polygon (CoglFramebuffer *framebuffer,
   CoglMatrixStack *projection_stack;
   graphene_matrix_t projection;
   graphene_matrix_t modelview;
+  float tx, ty;
   int i;
   const float *viewport = entry->viewport;
 
@@ -1675,15 +2003,27 @@ entry_to_screen_polygon (CoglFramebuffer *framebuffer,
    * _cogl_transform_points utility...
    */
 
-  cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-  cogl_graphene_matrix_transform_points (&modelview,
-                                         2, /* n_components */
-                                         sizeof (float) * 4, /* stride_in */
-                                         poly, /* points_in */
-                                         /* strideout */
-                                         sizeof (float) * 4,
-                                         poly, /* points_out */
-                                         4 /* n_points */);
+  if (cogl_matrix_entry_is_2d_translation (entry->modelview_entry,
+                                           &tx, &ty))
+    {
+      for (i = 0; i < 4; i++)
+        {
+          poly[4 * i] += tx;
+          poly[4 * i + 1] += ty;
+        }
+    }
+  else
+    {
+      cogl_matrix_entry_get (entry->modelview_entry, &modelview);
+      cogl_graphene_matrix_transform_points (&modelview,
+                                             2, /* n_components */
+                                             sizeof (float) * 4, /* stride_in */
+                                             poly, /* points_in */
+                                             /* strideout */
+                                             sizeof (float) * 4,
+                                             poly, /* points_out */
+                                             4 /* n_points */);
+    }
 
   projection_stack =
     _cogl_framebuffer_get_projection_stack (framebuffer);
@@ -58,10 +58,17 @@ struct _CoglMatrixEntry
   CoglMatrixOp op;
   unsigned int ref_count;
 
-#ifdef COGL_DEBUG_ENABLED
-  /* used for performance tracing */
-  int composite_gets;
-#endif
+  unsigned int classified : 1;
+  unsigned int is_2d_translation : 1;
+
+  float translate_x;
+  float translate_y;
+
+  /* Entries are immutable once pushed so the transform of the whole
+   * chain up to this entry is composed lazily the first time it's
+   * needed and then reused. It is allocated separately, so only the
+   * entries that are actually queried pay for a matrix. */
+  graphene_matrix_t *composed;
 };
 
 typedef struct _CoglMatrixEntryTranslate
@@ -118,9 +125,6 @@ typedef struct _CoglMatrixEntrySave
 {
   CoglMatrixEntry _parent_data;
 
-  graphene_matrix_t cache;
-  gboolean cache_valid;
-
 } CoglMatrixEntrySave;
 
 typedef union _CoglMatrixEntryFull
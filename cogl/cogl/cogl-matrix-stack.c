@@ -42,6 +42,8 @@
 #include "cogl-magazine-private.h"
 #include "cogl-gtype-private.h"
 
+#include <test-fixtures/test-unit.h>
+
 static void _cogl_matrix_stack_free (CoglMatrixStack *stack);
 
 COGL_OBJECT_DEFINE (MatrixStack, matrix_stack);
@@ -51,6 +53,7 @@ COGL_GTYPE_DEFINE_BOXED (MatrixEntry, matrix_entry,
                          cogl_matrix_entry_unref);
 
 static CoglMagazine *cogl_matrix_stack_magazine;
+static CoglMagazine *cogl_matrix_composed_magazine;
 
 /* XXX: Note: this leaves entry->parent uninitialized! */
 static CoglMatrixEntry *
@@ -61,10 +64,8 @@ _cogl_matrix_entry_new (CoglMatrixOp operation)
 
   entry->ref_count = 1;
   entry->op = operation;
-
-#ifdef COGL_DEBUG_ENABLED
-  entry->composite_gets = 0;
-#endif
+  entry->composed = NULL;
+  entry->classified = FALSE;
 
   return entry;
 }
@@ -134,9 +135,8 @@ _cogl_matrix_entry_identity_init (CoglMatrixEntry *entry)
   entry->ref_count = 1;
   entry->op = COGL_MATRIX_OP_LOAD_IDENTITY;
   entry->parent = NULL;
-#ifdef COGL_DEBUG_ENABLED
-  entry->composite_gets = 0;
-#endif
+  entry->composed = NULL;
+  entry->classified = FALSE;
 }
 
 void
@@ -283,11 +283,7 @@ cogl_matrix_stack_orthographic (CoglMatrixStack *stack,
 void
 cogl_matrix_stack_push (CoglMatrixStack *stack)
 {
-  CoglMatrixEntrySave *entry;
-
-  entry = _cogl_matrix_stack_push_operation (stack, COGL_MATRIX_OP_SAVE);
-
-  entry->cache_valid = FALSE;
+  _cogl_matrix_stack_push_operation (stack, COGL_MATRIX_OP_SAVE);
 }
 
 CoglMatrixEntry *
@@ -309,6 +305,9 @@ cogl_matrix_entry_unref (CoglMatrixEntry *entry)
   for (; entry && --entry->ref_count <= 0; entry = parent)
     {
       parent = entry->parent;
+      if (entry->composed)
+        _cogl_magazine_chunk_free (cogl_matrix_composed_magazine,
+                                   entry->composed);
       _cogl_magazine_chunk_free (cogl_matrix_stack_magazine, entry);
     }
 }
@@ -373,14 +372,45 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
                        graphene_matrix_t *matrix)
 {
   CoglMatrixEntry *current;
-  int depth;
+
+  if (entry->composed)
+    {
+      graphene_matrix_init_from_matrix (matrix, entry->composed);
+      return entry->composed;
+    }
+
+  /* These don't depend on the rest of the chain, so there is nothing
+   * worth keeping around */
+  switch (entry->op)
+    {
+    case COGL_MATRIX_OP_LOAD_IDENTITY:
+      graphene_matrix_init_identity (matrix);
+      return NULL;
+
+    case COGL_MATRIX_OP_LOAD:
+      {
+        CoglMatrixEntryLoad *load = (CoglMatrixEntryLoad *) entry;
+        graphene_matrix_init_from_matrix (matrix, &load->matrix);
+        return &load->matrix;
+      }
+
+    default:
+      break;
+    }
 
   graphene_matrix_init_identity (matrix);
 
-  for (current = entry, depth = 0;
-       current;
-       current = current->parent, depth++)
+  for (current = entry; current; current = current->parent)
     {
+      /* Any ancestor that has already been composed terminates the
+       * walk, which makes repeatedly querying entries that share a
+       * common parent cheap. */
+      if (current->composed)
+        {
+          graphene_matrix_multiply (matrix, current->composed, matrix);
+          goto applied;
+        }
+
       switch (current->op)
         {
         case COGL_MATRIX_OP_TRANSLATE:
@@ -430,65 +460,98 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
           }
         case COGL_MATRIX_OP_SAVE:
           {
-            CoglMatrixEntrySave *save = (CoglMatrixEntrySave *) current;
-            if (!save->cache_valid)
+            /* Make sure the transform at the save point is kept
+             * around so that anything pushed after it can reuse it
+             * even after this entry has been popped. */
+            if (current != entry)
               {
-                cogl_matrix_entry_get (current->parent, &save->cache);
-                save->cache_valid = TRUE;
+                graphene_matrix_t parent_matrix;
+
+                cogl_matrix_entry_get (current, &parent_matrix);
+                graphene_matrix_multiply (matrix, &parent_matrix, matrix);
+                goto applied;
               }
-            graphene_matrix_multiply (matrix, &save->cache, matrix);
-            goto applied;
+            break;
           }
         }
     }
 
-applied:
+  g_warning ("Inconsistent matrix stack");
+  return NULL;
 
-#ifdef COGL_ENABLE_DEBUG
-  if (!current)
-    {
-      g_warning ("Inconsistent matrix stack");
-      return NULL;
-    }
+applied:
+  entry->composed = _cogl_magazine_chunk_alloc (cogl_matrix_composed_magazine);
+  graphene_matrix_init_from_matrix (entry->composed, matrix);
 
-  entry->composite_gets++;
+  return entry->composed;
+}
 
-  if (COGL_DEBUG_ENABLED (COGL_DEBUG_PERFORMANCE) &&
-      entry->composite_gets >= 2)
+gboolean
+cogl_matrix_entry_is_2d_translation (CoglMatrixEntry *entry,
+                                     float           *x,
+                                     float           *y)
+{
+  if (!entry->classified)
     {
-      COGL_NOTE (PERFORMANCE,
-                 "Re-composing a matrix stack entry multiple times");
-    }
-#endif
+      CoglMatrixEntry *parent = entry->parent;
 
-  if (depth == 0)
-    {
-      switch (entry->op)
+      if (parent && parent->classified &&
+          (entry->op == COGL_MATRIX_OP_SAVE ||
+           (entry->op == COGL_MATRIX_OP_TRANSLATE &&
+            ((CoglMatrixEntryTranslate *) entry)->translate.z == 0.f)))
         {
-        case COGL_MATRIX_OP_LOAD_IDENTITY:
-        case COGL_MATRIX_OP_TRANSLATE:
-        case COGL_MATRIX_OP_ROTATE:
-        case COGL_MATRIX_OP_ROTATE_EULER:
-        case COGL_MATRIX_OP_SCALE:
-        case COGL_MATRIX_OP_MULTIPLY:
-          return NULL;
-
-        case COGL_MATRIX_OP_LOAD:
-          {
-            CoglMatrixEntryLoad *load = (CoglMatrixEntryLoad *)entry;
-            return &load->matrix;
-          }
-        case COGL_MATRIX_OP_SAVE:
-          {
-            CoglMatrixEntrySave *save = (CoglMatrixEntrySave *)entry;
-            return &save->cache;
-          }
+          /* Translations commute so a translation on top of a 2D
+           * translation can be classified without composing */
+          entry->is_2d_translation = parent->is_2d_translation;
+          entry->translate_x = parent->translate_x;
+          entry->translate_y = parent->translate_y;
+
+          if (entry->op == COGL_MATRIX_OP_TRANSLATE)
+            {
+              CoglMatrixEntryTranslate *translate =
+                (CoglMatrixEntryTranslate *) entry;
+
+              entry->translate_x += translate->translate.x;
+              entry->translate_y += translate->translate.y;
+            }
         }
-      g_warn_if_reached ();
-      return NULL;
+      else if (entry->op == COGL_MATRIX_OP_LOAD_IDENTITY)
+        {
+          entry->is_2d_translation = TRUE;
+          entry->translate_x = 0.f;
+          entry->translate_y = 0.f;
+        }
+      else
+        {
+          graphene_matrix_t matrix;
+          float v[16];
+
+          cogl_matrix_entry_get (entry, &matrix);
+          graphene_matrix_to_float (&matrix, v);
+
+          entry->is_2d_translation = (v[0] == 1.f && v[1] == 0.f &&
+                                      v[2] == 0.f && v[3] == 0.f &&
+                                      v[4] == 0.f && v[5] == 1.f &&
+                                      v[6] == 0.f && v[7] == 0.f &&
+                                      v[8] == 0.f && v[9] == 0.f &&
+                                      v[10] == 1.f && v[11] == 0.f &&
+                                      v[14] == 0.f && v[15] == 1.f);
+          entry->translate_x = v[12];
+          entry->translate_y = v[13];
+        }
+
+      entry->classified = TRUE;
     }
 
-  return NULL;
+  if (!entry->is_2d_translation)
+    return FALSE;
+
+  if (x)
+    *x = entry->translate_x;
+  if (y)
+    *y = entry->translate_y;
+
+  return TRUE;
 }
 
 CoglMatrixEntry *
@@ -525,6 +588,8 @@ cogl_matrix_stack_new (CoglContext *ctx)
     {
       cogl_matrix_stack_magazine =
         _cogl_magazine_new (sizeof (CoglMatrixEntryFull), 20);
+      cogl_matrix_composed_magazine =
+        _cogl_magazine_new (sizeof (graphene_matrix_t), 20);
     }
 
   stack->context = ctx;
@@ -920,3 +985,59 @@ _cogl_matrix_entry_cache_destroy (CoglMatrixEntryCache *cache)
   if (cache->entry)
     cogl_matrix_entry_unref (cache->entry);
 }
+
+UNIT_TEST (check_matrix_entry_composition,
+           0 /* no requirements */,
+           0 /* no known failures */)
+{
+  CoglMatrixStack *stack = cogl_matrix_stack_new (test_ctx);
+  CoglMatrixEntry *translated;
+  CoglMatrixEntry *rotated;
+  graphene_matrix_t matrix;
+  graphene_matrix_t expected;
+  graphene_point3d_t point;
+  float x, y;
+
+  cogl_matrix_stack_translate (stack, 10.f, 20.f, 0.f);
+  cogl_matrix_stack_push (stack);
+  cogl_matrix_stack_translate (stack, 1.f, 2.f, 0.f);
+
+  translated = cogl_matrix_entry_ref (cogl_matrix_stack_get_entry (stack));
+
+  g_assert_true (cogl_matrix_entry_is_2d_translation (translated, &x, &y));
+  g_assert_cmpfloat (x, ==, 11.f);
+  g_assert_cmpfloat (y, ==, 22.f);
+
+  cogl_matrix_stack_rotate (stack, 90.f, 0.f, 0.f, 1.f);
+  rotated = cogl_matrix_entry_ref (cogl_matrix_stack_get_entry (stack));
+
+  g_assert_false (cogl_matrix_entry_is_2d_translation (rotated, NULL, NULL));
+
+  /* Popping must not affect the transform cached at the save point */
+  cogl_matrix_stack_pop (stack);
+  cogl_matrix_stack_scale (stack, 2.f, 2.f, 1.f);
+
+  g_assert_false (cogl_matrix_entry_is_2d_translation (
+    cogl_matrix_stack_get_entry (stack), NULL, NULL));
+
+  graphene_matrix_init_rotate (&expected, 90.f, graphene_vec3_z_axis ());
+  graphene_matrix_translate (&expected,
+                             &GRAPHENE_POINT3D_INIT (11.f, 22.f, 0.f));
+
+  /* Querying twice must return the memoized result */
+  cogl_matrix_entry_get (rotated, &matrix);
+  g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+  cogl_matrix_entry_get (rotated, &matrix);
+  g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+
+  cogl_matrix_entry_get (cogl_matrix_stack_get_entry (stack), &matrix);
+  graphene_matrix_transform_point3d (&matrix,
+                                     &GRAPHENE_POINT3D_INIT (1.f, 1.f, 0.f),
+                                     &point);
+  g_assert_cmpfloat_with_epsilon (point.x, 12.f, 0.0001f);
+  g_assert_cmpfloat_with_epsilon (point.y, 22.f, 0.0001f);
+
+  cogl_matrix_entry_unref (rotated);
+  cogl_matrix_entry_unref (translated);
+  cogl_object_unref (stack);
+}
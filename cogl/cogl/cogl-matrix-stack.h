@@ -463,9 +463,6 @@ cogl_matrix_stack_get_entry (CoglMatrixStack *stack);
  * if the function returns %NULL then @matrix will be initialized
  * to match the current transform of @stack.
  *
- * <note>@matrix will be left untouched if a direct pointer is
- * returned.</note>
- *
  * Return value: A direct pointer to the current transform or %NULL
  *               and in that case @matrix will be initialized with
  *               the value of the current transform.
@@ -494,8 +491,8 @@ cogl_matrix_stack_get (CoglMatrixStack   *stack,
  * if the function returns %NULL then @matrix will be initialized
  * to match the transform of @entry.
  *
- * <note>@matrix will be left untouched if a direct pointer is
- * returned.</note>
+ * The composed transform is cached in @entry, so querying the same
+ * entry, or entries derived from it, multiple times is cheap.
  *
  * Return value: A direct pointer to a #graphene_matrix_t transform or %NULL
  *               and in that case @matrix will be initialized with
@@ -574,6 +571,26 @@ cogl_matrix_entry_calculate_translation (CoglMatrixEntry *entry0,
 COGL_EXPORT gboolean
 cogl_matrix_entry_is_identity (CoglMatrixEntry *entry);
 
+/**
+ * cogl_matrix_entry_is_2d_translation:
+ * @entry: A #CoglMatrixEntry
+ * @x: (out) (optional): The destination for the x-component of the
+ *   translation
+ * @y: (out) (optional): The destination for the y-component of the
+ *   translation
+ *
+ * Determines whether the transform represented by @entry only
+ * translates along the x and y axes and if so returns the
+ * translation. The result is computed once and cached in @entry.
+ *
+ * Return value: %TRUE if @entry is a pure 2D translation, otherwise
+ *               %FALSE.
+ */
+COGL_EXPORT gboolean
+cogl_matrix_entry_is_2d_translation (CoglMatrixEntry *entry,
+                                     float           *x,
+                                     float           *y);
+
 /**
  * cogl_matrix_entry_equal:
  * @entry0: The first #CoglMatrixEntry to compare
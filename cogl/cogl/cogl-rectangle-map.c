@@ -44,6 +44,12 @@
    structure. The algorithm for this is based on the description here:
 
    http://www.blackpawn.com/texts/lightmaps/default.html
+
+   Every split is a guillotine cut so the tree doubles as a guillotine
+   packer. New rectangles are placed in the free leaf that they fill
+   best rather than in the first one found, which keeps large free
+   areas intact for longer, and removing a rectangle coalesces empty
+   siblings back into a single free leaf.
 */
 
 #ifdef COGL_ENABLE_DEBUG
@@ -357,6 +363,8 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
   /* Stack of nodes to search in */
   GArray *stack = map->stack;
   CoglRectangleMapNode *found_node = NULL;
+  unsigned int best_area_waste = G_MAXUINT;
+  unsigned int best_side_waste = G_MAXUINT;
 
   /* Zero-sized rectangles break the algorithm for removing rectangles
      so we'll disallow them */
@@ -366,7 +374,7 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
   g_array_set_size (stack, 0);
   _cogl_rectangle_map_stack_push (stack, map->root, FALSE);
 
-  /* Depth-first search for an empty node that is big enough */
+  /* Depth-first search for the empty node that is the best fit */
   while (stack->len > 0)
     {
       CoglRectangleMapStackEntry *stack_top;
@@ -388,9 +396,26 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
         {
           if (node->type == COGL_RECTANGLE_MAP_EMPTY_LEAF)
             {
-              /* We've found a node we can use */
-              found_node = node;
-              break;
+              unsigned int area_waste = node->largest_gap - rectangle_size;
+              unsigned int side_waste =
+                MIN (node->rectangle.width - width,
+                     node->rectangle.height - height);
+
+              /* Prefer the node that leaves the least space unused,
+                 and of those the one with the shortest leftover
+                 side */
+              if (area_waste < best_area_waste ||
+                  (area_waste == best_area_waste &&
+                   side_waste < best_side_waste))
+                {
+                  found_node = node;
+                  best_area_waste = area_waste;
+                  best_side_waste = side_waste;
+
+                  /* It can't get any better than an exact fit */
+                  if (area_waste == 0)
+                    break;
+                }
             }
           else if (node->type == COGL_RECTANGLE_MAP_BRANCH)
             {
@@ -89,6 +89,10 @@ typedef struct
   int ref_count;
 
   GLuint gl_shader;
+  /* The shader is only compiled once a program needs to be linked
+   * from it, see _cogl_pipeline_fragend_glsl_get_shader() */
+  gboolean gl_shader_compiled;
+  char *source_hash;
   GString *header, *source;
   UnitState *unit_state;
 
@@ -144,6 +148,8 @@ destroy_shader_state (void *user_data,
       if (shader_state->gl_shader)
         GE( ctx, glDeleteShader (shader_state->gl_shader) );
 
+      g_free (shader_state->source_hash);
+
       g_free (shader_state->unit_state);
 
       g_free (shader_state);
@@ -184,10 +190,29 @@ _cogl_pipeline_fragend_glsl_get_shader (CoglPipeline *pipeline)
 {
   CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
 
+  _COGL_GET_CONTEXT (ctx, 0);
+
+  if (!shader_state || !shader_state->gl_shader)
+    return 0;
+
+  if (!shader_state->gl_shader_compiled)
+    {
+      _cogl_glsl_shader_compile (ctx, shader_state->gl_shader);
+      shader_state->gl_shader_compiled = TRUE;
+    }
+
+  return shader_state->gl_shader;
+}
+
+const char *
+_cogl_pipeline_fragend_glsl_get_source_hash (CoglPipeline *pipeline)
+{
+  CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
+
   if (shader_state)
-    return shader_state->gl_shader;
+    return shader_state->source_hash;
   else
-    return 0;
+    return NULL;
 }
 
 static CoglPipelineSnippetList *
@@ -347,6 +372,8 @@ _cogl_pipeline_fragend_glsl_start (CoglPipeline *pipeline,
             {
               GE( ctx, glDeleteShader (shader_state->gl_shader) );
               shader_state->gl_shader = 0;
+              shader_state->gl_shader_compiled = FALSE;
+              g_clear_pointer (&shader_state->source_hash, g_free);
             }
           return;
         }
@@ -982,7 +1009,6 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
 
@@ -1044,29 +1070,20 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
       lengths[1] = shader_state->source->len;
       source_strings[1] = shader_state->source->str;
 
+      /* Compiling is deferred until the program is linked, as it is not
+       * needed at all if the program binary is found in the cache */
+      g_clear_pointer (&shader_state->source_hash, g_free);
       _cogl_glsl_shader_set_source_with_boilerplate (ctx,
                                                      shader, GL_FRAGMENT_SHADER,
                                                      pipeline,
                                                      2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+                                                     source_strings, lengths,
+                                                     &shader_state->source_hash);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
       shader_state->gl_shader = shader;
+      shader_state->gl_shader_compiled = FALSE;
     }
 
   return TRUE;
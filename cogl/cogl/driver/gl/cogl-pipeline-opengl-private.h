@@ -84,6 +84,9 @@ typedef struct _CoglTextureUnit
    */
   gboolean           dirty_gl_texture;
 
+  /* The sampler object last bound to the unit with glBindSampler */
+  GLuint             gl_sampler;
+
   /* A matrix stack giving us the means to associate a texture
    * transform matrix with the texture unit. */
   CoglMatrixStack   *matrix_stack;
@@ -153,7 +156,12 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in);
+                                               const GLint *lengths_in,
+                                               char **source_hash_out);
+
+void
+_cogl_glsl_shader_compile (CoglContext *ctx,
+                           GLuint shader_gl_handle);
 
 void
 _cogl_sampler_gl_init (CoglContext *context,
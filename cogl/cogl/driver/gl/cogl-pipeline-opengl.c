@@ -75,6 +75,7 @@ texture_unit_init (CoglContext *ctx,
   unit->gl_texture = 0;
   unit->gl_target = 0;
   unit->dirty_gl_texture = FALSE;
+  unit->gl_sampler = 0;
   unit->matrix_stack = cogl_matrix_stack_new (ctx);
 
   unit->layer = NULL;
@@ -135,7 +136,8 @@ _cogl_set_active_texture_unit (int unit_index)
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
   CoglGLContext *glctx = _cogl_driver_gl_context(ctx);
 
-  if (glctx->active_texture_unit != unit_index)
+  if (_cogl_context_gl_state_changed (ctx,
+                                      glctx->active_texture_unit != unit_index))
     {
       GE (ctx, glActiveTexture (GL_TEXTURE0 + unit_index));
       glctx->active_texture_unit = unit_index;
@@ -264,7 +266,9 @@ flush_depth_state (CoglContext *ctx,
         cogl_framebuffer_get_depth_write_enabled (ctx->current_draw_buffer);
     }
 
-  if (ctx->depth_test_enabled_cache != depth_state->test_enabled)
+  if (_cogl_context_gl_state_changed (ctx,
+                                      ctx->depth_test_enabled_cache !=
+                                      depth_state->test_enabled))
     {
       if (depth_state->test_enabled == TRUE)
         {
@@ -277,22 +281,29 @@ flush_depth_state (CoglContext *ctx,
       ctx->depth_test_enabled_cache = depth_state->test_enabled;
     }
 
-  if (ctx->depth_test_function_cache != depth_state->test_function &&
-      depth_state->test_enabled == TRUE)
+  if (depth_state->test_enabled == TRUE &&
+      _cogl_context_gl_state_changed (ctx,
+                                      ctx->depth_test_function_cache !=
+                                      depth_state->test_function))
     {
       GE (ctx, glDepthFunc (depth_state->test_function));
       ctx->depth_test_function_cache = depth_state->test_function;
     }
 
-  if (ctx->depth_writing_enabled_cache != depth_writing_enabled)
+  if (_cogl_context_gl_state_changed (ctx,
+                                      ctx->depth_writing_enabled_cache !=
+                                      depth_writing_enabled))
     {
       GE (ctx, glDepthMask (depth_writing_enabled ?
                             GL_TRUE : GL_FALSE));
       ctx->depth_writing_enabled_cache = depth_writing_enabled;
     }
 
-  if ((ctx->depth_range_near_cache != depth_state->range_near ||
-       ctx->depth_range_far_cache != depth_state->range_far))
+  if (_cogl_context_gl_state_changed (ctx,
+                                      ctx->depth_range_near_cache !=
+                                      depth_state->range_near ||
+                                      ctx->depth_range_far_cache !=
+                                      depth_state->range_far))
     {
       if (ctx->driver == COGL_DRIVER_GLES2)
         GE (ctx, glDepthRangef (depth_state->range_near,
@@ -338,6 +349,36 @@ UNIT_TEST (check_gl_blend_enable,
   g_assert_cmpint (test_ctx->gl_blend_enable_cache, ==, 0);
 }
 
+UNIT_TEST (check_gl_state_shadowing,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  CoglGLContext *glctx = _cogl_driver_gl_context (test_ctx);
+  CoglPipeline *pipeline = cogl_pipeline_new (test_ctx);
+  unsigned int n_elided;
+
+  cogl_pipeline_set_blend (pipeline, "RGBA=ADD(SRC_COLOR, DST_COLOR)", NULL);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline, 0, 0, 1, 1);
+  _cogl_framebuffer_flush_journal (test_fb);
+
+  g_assert_cmpint (glctx->blend_src_factor_rgb, ==, GL_ONE);
+  g_assert_cmpint (glctx->blend_dst_factor_rgb, ==, GL_ONE);
+
+  /* Force the blend state to be flushed again the same way a
+   * framebuffer change does. The shadowed state still matches so no
+   * blend calls should be issued */
+  n_elided = test_ctx->gl_state_changes_elided;
+  test_ctx->current_pipeline_changes_since_flush |= COGL_PIPELINE_STATE_BLEND;
+  test_ctx->current_pipeline_age--;
+
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline, 0, 0, 1, 1);
+  _cogl_framebuffer_flush_journal (test_fb);
+
+  g_assert_cmpuint (test_ctx->gl_state_changes_elided, >=, n_elided + 2);
+
+  cogl_object_unref (pipeline);
+}
+
 static void
 _cogl_pipeline_flush_color_blend_alpha_depth_state (
                                             CoglPipeline *pipeline,
@@ -345,6 +386,7 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
                                             gboolean      with_color_attrib)
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  CoglGLContext *glctx = _cogl_driver_gl_context (ctx);
 
   if (pipelines_difference & COGL_PIPELINE_STATE_BLEND)
     {
@@ -360,26 +402,58 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
           blend_factor_uses_constant (blend_state->blend_dst_factor_rgb) ||
           blend_factor_uses_constant (blend_state->blend_dst_factor_alpha))
         {
-          float red =
-            cogl_color_get_red_float (&blend_state->blend_constant);
-          float green =
-            cogl_color_get_green_float (&blend_state->blend_constant);
-          float blue =
-            cogl_color_get_blue_float (&blend_state->blend_constant);
-          float alpha =
-            cogl_color_get_alpha_float (&blend_state->blend_constant);
-
-
-          GE (ctx, glBlendColor (red, green, blue, alpha));
+          float blend_constant[4] = {
+            cogl_color_get_red_float (&blend_state->blend_constant),
+            cogl_color_get_green_float (&blend_state->blend_constant),
+            cogl_color_get_blue_float (&blend_state->blend_constant),
+            cogl_color_get_alpha_float (&blend_state->blend_constant),
+          };
+
+          if (_cogl_context_gl_state_changed (ctx,
+                                              memcmp (glctx->blend_constant,
+                                                      blend_constant,
+                                                      sizeof (blend_constant))))
+            {
+              GE (ctx, glBlendColor (blend_constant[0],
+                                     blend_constant[1],
+                                     blend_constant[2],
+                                     blend_constant[3]));
+              memcpy (glctx->blend_constant, blend_constant,
+                      sizeof (blend_constant));
+            }
         }
 
-      GE (ctx, glBlendEquationSeparate (blend_state->blend_equation_rgb,
-                                        blend_state->blend_equation_alpha));
+      if (_cogl_context_gl_state_changed (ctx,
+                                          glctx->blend_equation_rgb !=
+                                          blend_state->blend_equation_rgb ||
+                                          glctx->blend_equation_alpha !=
+                                          blend_state->blend_equation_alpha))
+        {
+          GE (ctx, glBlendEquationSeparate (blend_state->blend_equation_rgb,
+                                            blend_state->blend_equation_alpha));
+          glctx->blend_equation_rgb = blend_state->blend_equation_rgb;
+          glctx->blend_equation_alpha = blend_state->blend_equation_alpha;
+        }
 
-      GE (ctx, glBlendFuncSeparate (blend_state->blend_src_factor_rgb,
-                                    blend_state->blend_dst_factor_rgb,
-                                    blend_state->blend_src_factor_alpha,
-                                    blend_state->blend_dst_factor_alpha));
+      if (_cogl_context_gl_state_changed (ctx,
+                                          glctx->blend_src_factor_rgb !=
+                                          blend_state->blend_src_factor_rgb ||
+                                          glctx->blend_dst_factor_rgb !=
+                                          blend_state->blend_dst_factor_rgb ||
+                                          glctx->blend_src_factor_alpha !=
+                                          blend_state->blend_src_factor_alpha ||
+                                          glctx->blend_dst_factor_alpha !=
+                                          blend_state->blend_dst_factor_alpha))
+        {
+          GE (ctx, glBlendFuncSeparate (blend_state->blend_src_factor_rgb,
+                                        blend_state->blend_dst_factor_rgb,
+                                        blend_state->blend_src_factor_alpha,
+                                        blend_state->blend_dst_factor_alpha));
+          glctx->blend_src_factor_rgb = blend_state->blend_src_factor_rgb;
+          glctx->blend_dst_factor_rgb = blend_state->blend_dst_factor_rgb;
+          glctx->blend_src_factor_alpha = blend_state->blend_src_factor_alpha;
+          glctx->blend_dst_factor_alpha = blend_state->blend_dst_factor_alpha;
+        }
     }
 #endif
 
@@ -399,13 +473,25 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       CoglPipelineCullFaceState *cull_face_state
         = &authority->big_state->cull_face_state;
 
-      if (cull_face_state->mode == COGL_PIPELINE_CULL_FACE_MODE_NONE)
-        GE( ctx, glDisable (GL_CULL_FACE) );
-      else
+      gboolean cull_face_enabled =
+        cull_face_state->mode != COGL_PIPELINE_CULL_FACE_MODE_NONE;
+
+      if (_cogl_context_gl_state_changed (ctx,
+                                          glctx->cull_face_enabled !=
+                                          cull_face_enabled))
         {
-          gboolean invert_winding;
+          if (cull_face_enabled)
+            GE( ctx, glEnable (GL_CULL_FACE) );
+          else
+            GE( ctx, glDisable (GL_CULL_FACE) );
+          glctx->cull_face_enabled = cull_face_enabled;
+        }
 
-          GE( ctx, glEnable (GL_CULL_FACE) );
+      if (cull_face_enabled)
+        {
+          gboolean invert_winding;
+          GLenum cull_face_mode = GL_BACK;
+          GLenum front_face = GL_CCW;
 
           switch (cull_face_state->mode)
             {
@@ -413,35 +499,52 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
               g_assert_not_reached ();
 
             case COGL_PIPELINE_CULL_FACE_MODE_FRONT:
-              GE( ctx, glCullFace (GL_FRONT) );
+              cull_face_mode = GL_FRONT;
               break;
 
             case COGL_PIPELINE_CULL_FACE_MODE_BACK:
-              GE( ctx, glCullFace (GL_BACK) );
+              cull_face_mode = GL_BACK;
               break;
 
             case COGL_PIPELINE_CULL_FACE_MODE_BOTH:
-              GE( ctx, glCullFace (GL_FRONT_AND_BACK) );
+              cull_face_mode = GL_FRONT_AND_BACK;
               break;
             }
 
+          if (_cogl_context_gl_state_changed (ctx,
+                                              glctx->cull_face_mode !=
+                                              cull_face_mode))
+            {
+              GE( ctx, glCullFace (cull_face_mode) );
+              glctx->cull_face_mode = cull_face_mode;
+            }
+
           invert_winding =
             cogl_framebuffer_is_y_flipped (ctx->current_draw_buffer);
 
           switch (cull_face_state->front_winding)
             {
             case COGL_WINDING_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CCW : GL_CW) );
+              front_face = invert_winding ? GL_CCW : GL_CW;
               break;
 
             case COGL_WINDING_COUNTER_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CW : GL_CCW) );
+              front_face = invert_winding ? GL_CW : GL_CCW;
               break;
             }
+
+          if (_cogl_context_gl_state_changed (ctx,
+                                              glctx->front_face != front_face))
+            {
+              GE( ctx, glFrontFace (front_face) );
+              glctx->front_face = front_face;
+            }
         }
     }
 
-  if (pipeline->real_blend_enable != ctx->gl_blend_enable_cache)
+  if (_cogl_context_gl_state_changed (ctx,
+                                      pipeline->real_blend_enable !=
+                                      ctx->gl_blend_enable_cache))
     {
       if (pipeline->real_blend_enable)
         GE (ctx, glEnable (GL_BLEND));
@@ -590,7 +693,7 @@ flush_layers_common_gl_state_cb (CoglPipelineLayer *layer, void *user_data)
        * associated with the texture unit then we can't assume that we
        * aren't seeing a recycled texture name so we have to bind.
        */
-      if (unit->gl_texture != gl_texture)
+      if (_cogl_context_gl_state_changed (ctx, unit->gl_texture != gl_texture))
         {
           if (unit_index == 1)
             unit->dirty_gl_texture = TRUE;
@@ -614,7 +717,15 @@ flush_layers_common_gl_state_cb (CoglPipelineLayer *layer, void *user_data)
 
       sampler_state = _cogl_pipeline_layer_get_sampler_state (layer);
 
-      GE( ctx, glBindSampler (unit_index, sampler_state->sampler_object) );
+      /* Layers with different sampler state often end up sharing the
+       * same sampler object from the sampler cache */
+      if (_cogl_context_gl_state_changed (ctx,
+                                          unit->gl_sampler !=
+                                          sampler_state->sampler_object))
+        {
+          GE( ctx, glBindSampler (unit_index, sampler_state->sampler_object) );
+          unit->gl_sampler = sampler_state->sampler_object;
+        }
     }
 
   cogl_object_ref (layer);
@@ -734,7 +845,23 @@ _cogl_sampler_gl_free (CoglContext *context, CoglSamplerCacheEntry *entry)
 {
   if (_cogl_has_private_feature (context,
                                  COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS))
-    GE( context, glDeleteSamplers (1, &entry->sampler_object) );
+    {
+      CoglGLContext *glctx = _cogl_driver_gl_context (context);
+      int i;
+
+      GE( context, glDeleteSamplers (1, &entry->sampler_object) );
+
+      /* Deleting a sampler unbinds it from all units and its name may
+       * be reused for a new sampler */
+      for (i = 0; i < glctx->texture_units->len; i++)
+        {
+          CoglTextureUnit *unit =
+            &g_array_index (glctx->texture_units, CoglTextureUnit, i);
+
+          if (unit->gl_sampler == entry->sampler_object)
+            unit->gl_sampler = 0;
+        }
+    }
 }
 
 /* OpenGL associates the min/mag filters and repeat modes with the
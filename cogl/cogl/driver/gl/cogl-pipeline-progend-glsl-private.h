@@ -43,5 +43,8 @@ int
 _cogl_pipeline_progend_glsl_get_attrib_location (CoglPipeline *pipeline,
                                                  int name_index);
 
+gboolean
+_cogl_pipeline_progend_glsl_uses_transform_block (CoglPipeline *pipeline);
+
 #endif /* __COGL_PIPELINE_PROGEND_GLSL_PRIVATE_H */
 
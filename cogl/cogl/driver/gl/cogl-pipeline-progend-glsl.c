@@ -53,6 +53,23 @@
 #include "driver/gl/cogl-pipeline-progend-glsl-private.h"
 #include "deprecated/cogl-program-private.h"
 
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+
+/* The uniform buffer binding point of the transform block */
+#define TRANSFORM_BLOCK_BINDING 0
+
+/* Layout of _cogl_transform_block, see cogl-glsl-shader-boilerplate.h.
+   With std140 all of the members are tightly packed */
+typedef struct
+{
+  float modelview[16];
+  float modelview_projection[16];
+  float projection[16];
+  float flip_vector[4];
+} TransformBlock;
+
 /* These are used to generalise updating some uniforms that are
    required when building for drivers missing some fixed function
    state that we use */
@@ -112,6 +129,10 @@ typedef struct
   GLint projection_uniform;
   GLint mvp_uniform;
 
+  /* GL_INVALID_INDEX unless the matrices come from the transform
+     block, in which case the uniforms above are all -1 */
+  GLuint transform_block_index;
+
   CoglMatrixEntryCache projection_cache;
   CoglMatrixEntryCache modelview_cache;
 
@@ -124,6 +145,12 @@ typedef struct
      uniform is actually set */
   GArray *uniform_locations;
 
+  /* Array of the CoglBoxedValues last uploaded to the program, indexed
+     like uniform_locations. Uniforms belong to the GL program so this
+     lets us skip uploading the same value again when the program is
+     shared by different pipelines */
+  GArray *flushed_uniform_values;
+
   /* Array of attribute locations. */
   GArray *attribute_locations;
 
@@ -236,8 +263,10 @@ program_state_new (int n_layers,
   program_state->program = 0;
   program_state->unit_state = g_new (UnitState, n_layers);
   program_state->uniform_locations = NULL;
+  program_state->flushed_uniform_values = NULL;
   program_state->attribute_locations = NULL;
   program_state->cache_entry = cache_entry;
+  program_state->transform_block_index = GL_INVALID_INDEX;
   _cogl_matrix_entry_cache_init (&program_state->modelview_cache);
   _cogl_matrix_entry_cache_init (&program_state->projection_cache);
 
@@ -277,6 +306,8 @@ destroy_program_state (void *user_data,
 
       if (program_state->uniform_locations)
         g_array_free (program_state->uniform_locations, TRUE);
+      if (program_state->flushed_uniform_values)
+        g_array_free (program_state->flushed_uniform_values, TRUE);
 
       g_free (program_state);
     }
@@ -312,12 +343,12 @@ dirty_program_state (CoglPipeline *pipeline)
                              NULL);
 }
 
-static void
+static gboolean
 link_program (GLint gl_program)
 {
   GLint link_status;
 
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  _COGL_GET_CONTEXT (ctx, FALSE);
 
   GE( ctx, glLinkProgram (gl_program) );
 
@@ -341,6 +372,8 @@ link_program (GLint gl_program)
 
       g_free (log);
     }
+
+  return link_status;
 }
 
 typedef struct
@@ -521,9 +554,40 @@ flush_uniform_cb (int uniform_num, void *user_data)
         }
 
       if (uniform_location != -1)
-        _cogl_boxed_value_set_uniform (data->ctx,
-                                       uniform_location,
-                                       data->values + data->value_index);
+        {
+          const CoglBoxedValue *value = data->values + data->value_index;
+          GArray *flushed_values = data->program_state->flushed_uniform_values;
+          CoglBoxedValue *flushed_value;
+
+          if (flushed_values == NULL)
+            {
+              flushed_values = g_array_new (FALSE, TRUE,
+                                            sizeof (CoglBoxedValue));
+              g_array_set_clear_func (flushed_values,
+                                      (GDestroyNotify)
+                                      _cogl_boxed_value_destroy);
+              data->program_state->flushed_uniform_values = flushed_values;
+            }
+
+          /* The array is zero-filled which is the same as a
+             COGL_BOXED_NONE value */
+          if (flushed_values->len <= uniform_num)
+            g_array_set_size (flushed_values, uniform_num + 1);
+
+          flushed_value = &g_array_index (flushed_values, CoglBoxedValue,
+                                          uniform_num);
+
+          if (_cogl_context_gl_state_changed
+                (data->ctx, !_cogl_boxed_value_equal (flushed_value, value)))
+            {
+              _cogl_boxed_value_set_uniform (data->ctx,
+                                             uniform_location,
+                                             value);
+
+              _cogl_boxed_value_destroy (flushed_value);
+              _cogl_boxed_value_copy (flushed_value, value);
+            }
+        }
 
       data->n_differences--;
       COGL_FLAGS_SET (data->uniform_differences, uniform_num, FALSE);
@@ -568,9 +632,11 @@ _cogl_pipeline_progend_glsl_flush_uniforms (CoglPipeline *pipeline,
       if (program_changed)
         {
           /* The program has changed so all of the uniform locations
-             are invalid */
+             and values are invalid */
           if (program_state->uniform_locations)
             g_array_set_size (program_state->uniform_locations, 0);
+          if (program_state->flushed_uniform_values)
+            g_array_set_size (program_state->flushed_uniform_values, 0);
         }
 
       /* We need to flush everything so mark all of the uniforms as
@@ -687,6 +753,7 @@ _cogl_shader_compile_real (CoglHandle handle,
                                                  1,
                                                  (const char **)
                                                   &shader->source,
+                                                 NULL,
                                                  NULL);
   GE (ctx, glCompileShader (shader->gl_handle));
 
@@ -787,11 +854,43 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
 
   if (program_state->program == 0)
     {
+      CoglProgramBinaryCache *binary_cache =
+        _cogl_driver_gl_context (ctx)->program_binary_cache;
+      g_autofree char *binary_key = NULL;
       GLuint backend_shader;
       GSList *l;
 
+      /* Programs only made of generated shaders can be looked up in
+       * the binary cache, which avoids compiling the shaders at all */
+      if (binary_cache && !user_program)
+        {
+          const char *vertex_hash =
+            _cogl_pipeline_vertend_glsl_get_source_hash (pipeline);
+          const char *fragment_hash =
+            _cogl_pipeline_fragend_glsl_get_source_hash (pipeline);
+
+          if (vertex_hash && fragment_hash)
+            binary_key = _cogl_program_binary_cache_get_key (binary_cache,
+                                                             vertex_hash,
+                                                             fragment_hash);
+        }
+
+      /* The program might already have been loaded by the warm-up */
+      if (binary_key)
+        program_state->program =
+          _cogl_program_binary_cache_take_program (binary_cache, binary_key);
+
+      if (program_state->program)
+        goto linked;
+
       GE_RET( program_state->program, ctx, glCreateProgram () );
 
+      if (binary_key &&
+          _cogl_program_binary_cache_load (binary_cache,
+                                           binary_key,
+                                           program_state->program))
+        goto linked;
+
       /* Attach all of the shader from the user program */
       if (user_program)
         {
@@ -821,14 +920,23 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE( ctx, glBindAttribLocation (program_state->program,
                                      0, "cogl_position_in"));
 
-      link_program (program_state->program);
+      if (binary_key)
+        _cogl_program_binary_cache_prepare_program (binary_cache,
+                                                    program_state->program);
 
+      if (link_program (program_state->program) && binary_key)
+        _cogl_program_binary_cache_save (binary_cache,
+                                         binary_key,
+                                         program_state->program);
+
+    linked:
       program_changed = TRUE;
     }
 
   gl_program = program_state->program;
 
-  if (ctx->current_gl_program != gl_program)
+  if (_cogl_context_gl_state_changed (ctx,
+                                      ctx->current_gl_program != gl_program))
     {
       _cogl_gl_util_clear_gl_errors (ctx);
       ctx->glUseProgram (gl_program);
@@ -887,6 +995,18 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE_RET( program_state->mvp_uniform, ctx,
               glGetUniformLocation (gl_program,
                                     "cogl_modelview_projection_matrix") );
+
+      program_state->transform_block_index = GL_INVALID_INDEX;
+      if (_cogl_pipeline_progend_glsl_uses_transform_block (pipeline))
+        {
+          GE_RET( program_state->transform_block_index, ctx,
+                  glGetUniformBlockIndex (gl_program,
+                                          "_cogl_transform_block") );
+          if (program_state->transform_block_index != GL_INVALID_INDEX)
+            GE( ctx, glUniformBlockBinding (gl_program,
+                                            program_state->transform_block_index,
+                                            TRANSFORM_BLOCK_BINDING) );
+        }
     }
 
   if (program_changed ||
@@ -989,6 +1109,80 @@ _cogl_pipeline_progend_glsl_layer_pre_change_notify (
     unit->layer_changes_since_flush |= change;
 }
 
+gboolean
+_cogl_pipeline_progend_glsl_uses_transform_block (CoglPipeline *pipeline)
+{
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
+  /* Programs with a user program don't get the transform block
+     because the user shaders can't be relied upon to apply the flip
+     vector */
+  return (_cogl_driver_gl_context (ctx)->uniform_buffer_ring != NULL &&
+          _cogl_pipeline_get_user_program (pipeline) == NULL);
+}
+
+static void
+flush_transform_block (CoglContext     *ctx,
+                       CoglMatrixEntry *projection_entry,
+                       CoglMatrixEntry *modelview_entry,
+                       gboolean         needs_flip)
+{
+  static const float do_flip[4] = { 1.0f, -1.0f, 1.0f, 1.0f };
+  static const float dont_flip[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  CoglGLContext *glctx = _cogl_driver_gl_context (ctx);
+  gboolean projection_changed;
+  gboolean modelview_changed;
+  graphene_matrix_t modelview, projection;
+  TransformBlock block;
+
+  /* The block is shared by all of the programs so the matrices in it
+     are never flipped. The vertex shaders multiply by the flip vector
+     instead */
+  projection_changed =
+    _cogl_matrix_entry_cache_maybe_update (&glctx->transform_block_projection_cache,
+                                           projection_entry,
+                                           FALSE);
+  modelview_changed =
+    _cogl_matrix_entry_cache_maybe_update (&glctx->transform_block_modelview_cache,
+                                           modelview_entry,
+                                           FALSE);
+
+  if (!_cogl_context_gl_state_changed (ctx,
+                                       projection_changed ||
+                                       modelview_changed ||
+                                       glctx->transform_block_flip_state !=
+                                       needs_flip))
+    return;
+
+  cogl_matrix_entry_get (modelview_entry, &modelview);
+  cogl_matrix_entry_get (projection_entry, &projection);
+  graphene_matrix_to_float (&modelview, block.modelview);
+  graphene_matrix_to_float (&projection, block.projection);
+
+  /* The journal usually uses an identity matrix for the modelview so
+     we can avoid the matrix multiplication in the common case */
+  if (cogl_matrix_entry_is_identity (modelview_entry))
+    {
+      memcpy (block.modelview_projection, block.projection,
+              sizeof (block.projection));
+    }
+  else
+    {
+      graphene_matrix_t combined;
+
+      graphene_matrix_multiply (&modelview, &projection, &combined);
+      graphene_matrix_to_float (&combined, block.modelview_projection);
+    }
+
+  memcpy (block.flip_vector, needs_flip ? do_flip : dont_flip,
+          sizeof (block.flip_vector));
+
+  _cogl_uniform_buffer_ring_bind_data (glctx->uniform_buffer_ring,
+                                       TRANSFORM_BLOCK_BINDING,
+                                       &block, sizeof (block));
+  glctx->transform_block_flip_state = needs_flip;
+}
+
 static void
 _cogl_pipeline_progend_glsl_pre_paint (CoglPipeline *pipeline,
                                        CoglFramebuffer *framebuffer)
@@ -1018,6 +1212,15 @@ _cogl_pipeline_progend_glsl_pre_paint (CoglPipeline *pipeline,
 
   needs_flip = cogl_framebuffer_is_y_flipped (ctx->current_draw_buffer);
 
+  /* The matrices only have to be uploaded once for all of the programs
+     using the transform block */
+  if (program_state->transform_block_index != GL_INVALID_INDEX)
+    {
+      flush_transform_block (ctx, projection_entry, modelview_entry,
+                             needs_flip);
+      return;
+    }
+
   projection_changed =
     _cogl_matrix_entry_cache_maybe_update (&program_state->projection_cache,
                                            projection_entry,
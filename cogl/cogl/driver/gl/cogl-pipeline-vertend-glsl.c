@@ -47,6 +47,7 @@
 #include "cogl-pipeline-state-private.h"
 #include "cogl-glsl-shader-boilerplate.h"
 #include "driver/gl/cogl-pipeline-vertend-glsl-private.h"
+#include "driver/gl/cogl-pipeline-progend-glsl-private.h"
 #include "deprecated/cogl-program-private.h"
 
 const CoglPipelineVertend _cogl_pipeline_glsl_vertend;
@@ -56,6 +57,10 @@ typedef struct
   unsigned int ref_count;
 
   GLuint gl_shader;
+  /* The shader is only compiled once a program needs to be linked
+   * from it, see _cogl_pipeline_vertend_glsl_get_shader() */
+  gboolean gl_shader_compiled;
+  char *source_hash;
   GString *header, *source;
 
   CoglPipelineCacheEntry *cache_entry;
@@ -98,6 +103,8 @@ destroy_shader_state (void *user_data,
       if (shader_state->gl_shader)
         GE( ctx, glDeleteShader (shader_state->gl_shader) );
 
+      g_free (shader_state->source_hash);
+
       g_free (shader_state);
     }
 }
@@ -169,15 +176,17 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in)
+                                               const GLint *lengths_in,
+                                               char **source_hash_out)
 {
   const char *vertex_boilerplate;
   const char *fragment_boilerplate;
 
-  const char **strings = g_alloca (sizeof (char *) * (count_in + 4));
-  GLint *lengths = g_alloca (sizeof (GLint) * (count_in + 4));
+  const char **strings = g_alloca (sizeof (char *) * (count_in + 6));
+  GLint *lengths = g_alloca (sizeof (GLint) * (count_in + 6));
   char *version_string;
   int count = 0;
+  gboolean use_transform_block;
 
   int n_layers;
 
@@ -197,6 +206,18 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
       lengths[count++] = sizeof (image_external_extension) - 1;
     }
 
+  use_transform_block =
+    _cogl_pipeline_progend_glsl_uses_transform_block (pipeline);
+
+  /* Uniform blocks are only core since GLSL 1.40 */
+  if (use_transform_block && ctx->glsl_version_to_use < 140)
+    {
+      static const char uniform_buffer_extension[] =
+        "#extension GL_ARB_uniform_buffer_object : require\n";
+      strings[count] = uniform_buffer_extension;
+      lengths[count++] = sizeof (uniform_buffer_extension) - 1;
+    }
+
   if (shader_gl_type == GL_VERTEX_SHADER)
     {
       strings[count] = vertex_boilerplate;
@@ -208,6 +229,17 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
       lengths[count++] = strlen (fragment_boilerplate);
     }
 
+  if (use_transform_block)
+    {
+      strings[count] = _COGL_TRANSFORM_UNIFORM_BLOCK_BOILERPLATE;
+      lengths[count++] = strlen (_COGL_TRANSFORM_UNIFORM_BLOCK_BOILERPLATE);
+    }
+  else
+    {
+      strings[count] = _COGL_TRANSFORM_UNIFORMS_BOILERPLATE;
+      lengths[count++] = strlen (_COGL_TRANSFORM_UNIFORMS_BOILERPLATE);
+    }
+
   n_layers = cogl_pipeline_get_n_layers (pipeline);
   if (n_layers)
     {
@@ -274,17 +306,74 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
   GE( ctx, glShaderSource (shader_gl_handle, count,
                            (const char **) strings, lengths) );
 
+  /* The hash identifies the shader for the program binary cache */
+  if (source_hash_out)
+    {
+      GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA256);
+      int i;
+
+      for (i = 0; i < count; i++)
+        g_checksum_update (checksum,
+                           (const guchar *) strings[i],
+                           lengths[i]);
+
+      *source_hash_out = g_strdup (g_checksum_get_string (checksum));
+      g_checksum_free (checksum);
+    }
+
   g_free (version_string);
 }
+
+void
+_cogl_glsl_shader_compile (CoglContext *ctx,
+                           GLuint shader_gl_handle)
+{
+  GLint compile_status;
+
+  GE( ctx, glCompileShader (shader_gl_handle) );
+  GE( ctx, glGetShaderiv (shader_gl_handle, GL_COMPILE_STATUS,
+                          &compile_status) );
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE( ctx, glGetShaderiv (shader_gl_handle, GL_INFO_LOG_LENGTH, &len) );
+      shader_log = g_alloca (len);
+      GE( ctx, glGetShaderInfoLog (shader_gl_handle, len, &len, shader_log) );
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+    }
+}
+
 GLuint
 _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline)
 {
   CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
 
+  _COGL_GET_CONTEXT (ctx, 0);
+
+  if (!shader_state || !shader_state->gl_shader)
+    return 0;
+
+  if (!shader_state->gl_shader_compiled)
+    {
+      _cogl_glsl_shader_compile (ctx, shader_state->gl_shader);
+      shader_state->gl_shader_compiled = TRUE;
+    }
+
+  return shader_state->gl_shader;
+}
+
+const char *
+_cogl_pipeline_vertend_glsl_get_source_hash (CoglPipeline *pipeline)
+{
+  CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
+
   if (shader_state)
-    return shader_state->gl_shader;
+    return shader_state->source_hash;
   else
-    return 0;
+    return NULL;
 }
 
 static CoglPipelineSnippetList *
@@ -416,6 +505,8 @@ _cogl_pipeline_vertend_glsl_start (CoglPipeline *pipeline,
             {
               GE( ctx, glDeleteShader (shader_state->gl_shader) );
               shader_state->gl_shader = 0;
+              shader_state->gl_shader_compiled = FALSE;
+              g_clear_pointer (&shader_state->source_hash, g_free);
             }
           return;
         }
@@ -554,7 +645,6 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
       CoglPipelineSnippetList *vertex_snippets;
@@ -640,8 +730,14 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
       /* If there are any snippets then we can't rely on the
          projection matrix to flip the rendering for offscreen buffers
          so we'll need to flip it using an extra statement and a
-         uniform */
-      if (_cogl_pipeline_has_vertex_snippets (pipeline))
+         uniform. The transform block always contains the flip vector
+         so that its matrices can be shared by all programs */
+      if (_cogl_pipeline_progend_glsl_uses_transform_block (pipeline))
+        {
+          g_string_append (shader_state->source,
+                           "  cogl_position_out *= _cogl_flip_vector;\n");
+        }
+      else if (_cogl_pipeline_has_vertex_snippets (pipeline))
         {
           g_string_append (shader_state->header,
                            "uniform vec4 _cogl_flip_vector;\n");
@@ -659,29 +755,20 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
       lengths[1] = shader_state->source->len;
       source_strings[1] = shader_state->source->str;
 
+      /* Compiling is deferred until the program is linked, as it is not
+       * needed at all if the program binary is found in the cache */
+      g_clear_pointer (&shader_state->source_hash, g_free);
       _cogl_glsl_shader_set_source_with_boilerplate (ctx,
                                                      shader, GL_VERTEX_SHADER,
                                                      pipeline,
                                                      2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+                                                     source_strings, lengths,
+                                                     &shader_state->source_hash);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
       shader_state->gl_shader = shader;
+      shader_state->gl_shader_compiled = FALSE;
     }
 
   return TRUE;
@@ -0,0 +1,68 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef COGL_PROGRAM_BINARY_CACHE_PRIVATE_H
+#define COGL_PROGRAM_BINARY_CACHE_PRIVATE_H
+
+#include "cogl-context.h"
+#include "cogl-gl-header.h"
+
+typedef struct _CoglProgramBinaryCache CoglProgramBinaryCache;
+
+CoglProgramBinaryCache *
+_cogl_program_binary_cache_new (CoglContext *context);
+
+void
+_cogl_program_binary_cache_free (CoglProgramBinaryCache *cache);
+
+char *
+_cogl_program_binary_cache_get_key (CoglProgramBinaryCache *cache,
+                                    const char             *vertex_hash,
+                                    const char             *fragment_hash);
+
+void
+_cogl_program_binary_cache_prepare_program (CoglProgramBinaryCache *cache,
+                                            GLuint                  program);
+
+gboolean
+_cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  program);
+
+void
+_cogl_program_binary_cache_save (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  program);
+
+GLuint
+_cogl_program_binary_cache_take_program (CoglProgramBinaryCache *cache,
+                                         const char             *key);
+
+gboolean
+_cogl_program_binary_cache_warm_up (CoglProgramBinaryCache *cache,
+                                    int64_t                 budget_us);
+
+void
+_cogl_program_binary_cache_save_program_list (CoglProgramBinaryCache *cache);
+
+#endif /* COGL_PROGRAM_BINARY_CACHE_PRIVATE_H */
@@ -0,0 +1,685 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+/*
+ * Linked program binaries are stored in the user cache directory so
+ * that subsequent runs can skip compiling and linking the shaders
+ * generated by the GLSL backends. Every file is keyed by a hash of the
+ * generated shader sources and of the driver identity, so updating the
+ * driver implicitly invalidates the whole cache. Files that fail to
+ * validate or that the driver refuses to load are removed, and the
+ * least recently used files are evicted once the cache grows beyond
+ * COGL_PROGRAM_BINARY_CACHE_MAX_SIZE.
+ *
+ * The keys of the programs used during a session are also written to
+ * a warm-up list, once the warm-up is done and again whenever
+ * _cogl_program_binary_cache_save_program_list() is called after new
+ * programs were used. On the next run the listed programs are loaded ahead
+ * of time in small steps, see _cogl_program_binary_cache_warm_up(), and
+ * handed over when a pipeline needs them, so that the first use of a
+ * pipeline doesn't even need to go to the disk.
+ */
+
+#include "cogl-config.h"
+
+#include "driver/gl/cogl-program-binary-cache-private.h"
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "cogl-context-private.h"
+#include "cogl-debug.h"
+#include "driver/gl/cogl-util-gl-private.h"
+
+#include <test-fixtures/test-unit.h>
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+#define COGL_PROGRAM_BINARY_MAGIC 0x43504231 /* "CPB1" */
+#define COGL_PROGRAM_BINARY_SUFFIX ".bin"
+#define COGL_PROGRAM_BINARY_CACHE_MAX_SIZE (32 * 1024 * 1024)
+#define COGL_PROGRAM_WARM_UP_LIST "warm-up.list"
+#define COGL_PROGRAM_WARM_UP_MAX_PROGRAMS 256
+/* Temporary files older than this are left over from interrupted writes */
+#define COGL_PROGRAM_BINARY_TEMP_FILE_MAX_AGE (60 * 60)
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t format;
+  uint32_t length;
+  uint8_t checksum[32];
+} CoglProgramBinaryHeader;
+
+typedef struct
+{
+  char *path;
+  int64_t mtime;
+  goffset size;
+} CacheFile;
+
+struct _CoglProgramBinaryCache
+{
+  CoglContext *context;
+
+  char *path;
+  char *driver_id;
+
+  /* The size of the cache directory is only determined when saving
+   * the first binary, to avoid scanning it on startup */
+  gboolean size_known;
+  goffset size;
+
+  /* Keys of the programs used in this session, in order of first use */
+  GPtrArray *used_keys;
+  GHashTable *used_keys_set;
+  gboolean used_keys_changed;
+
+  /* Keys from the previous session that haven't been warmed up yet */
+  GQueue pending_keys;
+
+  /* Key -> GLuint of programs loaded ahead of time */
+  GHashTable *warm_programs;
+};
+
+static char *
+compute_driver_id (CoglContext *context)
+{
+  GChecksum *checksum;
+  const GLenum strings[] = {
+    GL_VENDOR,
+    GL_RENDERER,
+    GL_VERSION,
+    GL_SHADING_LANGUAGE_VERSION,
+  };
+  char *driver_id;
+  unsigned int i;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++)
+    {
+      const char *string = (const char *) context->glGetString (strings[i]);
+
+      if (string)
+        g_checksum_update (checksum, (const guchar *) string, -1);
+      /* Separate the strings so they can't be confused with each other */
+      g_checksum_update (checksum, (const guchar *) "", 1);
+    }
+
+  driver_id = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return driver_id;
+}
+
+static void
+read_warm_up_list (CoglProgramBinaryCache *cache)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  g_auto (GStrv) keys = NULL;
+  int i;
+
+  path = g_build_filename (cache->path, COGL_PROGRAM_WARM_UP_LIST, NULL);
+  if (!g_file_get_contents (path, &contents, NULL, NULL))
+    return;
+
+  keys = g_strsplit (contents, "\n", COGL_PROGRAM_WARM_UP_MAX_PROGRAMS + 1);
+  for (i = 0; keys[i] && i < COGL_PROGRAM_WARM_UP_MAX_PROGRAMS; i++)
+    {
+      if (strlen (keys[i]) != 64)
+        continue;
+
+      g_queue_push_tail (&cache->pending_keys, g_steal_pointer (&keys[i]));
+    }
+}
+
+static void
+write_warm_up_list (CoglProgramBinaryCache *cache)
+{
+  g_autofree char *path = NULL;
+  g_autoptr (GString) contents = NULL;
+  g_autoptr (GError) error = NULL;
+  unsigned int i;
+
+  if (!cache->used_keys_changed)
+    return;
+
+  contents = g_string_new (NULL);
+  for (i = 0; i < cache->used_keys->len; i++)
+    {
+      g_string_append (contents, g_ptr_array_index (cache->used_keys, i));
+      g_string_append_c (contents, '\n');
+    }
+
+  path = g_build_filename (cache->path, COGL_PROGRAM_WARM_UP_LIST, NULL);
+  if (!g_file_set_contents (path, contents->str, contents->len, &error))
+    {
+      g_warning ("Failed to save program warm-up list: %s", error->message);
+      return;
+    }
+
+  cache->used_keys_changed = FALSE;
+}
+
+static void
+mark_key_used (CoglProgramBinaryCache *cache,
+               const char             *key)
+{
+  char *key_copy;
+
+  if (g_hash_table_contains (cache->used_keys_set, key) ||
+      cache->used_keys->len >= COGL_PROGRAM_WARM_UP_MAX_PROGRAMS)
+    return;
+
+  key_copy = g_strdup (key);
+  g_ptr_array_add (cache->used_keys, key_copy);
+  g_hash_table_add (cache->used_keys_set, key_copy);
+  cache->used_keys_changed = TRUE;
+}
+
+CoglProgramBinaryCache *
+_cogl_program_binary_cache_new (CoglContext *context)
+{
+  CoglProgramBinaryCache *cache;
+  GLint n_formats = 0;
+  g_autofree char *path = NULL;
+
+  if (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES))
+    return NULL;
+
+  if (!context->glGetProgramBinary || !context->glProgramBinary)
+    return NULL;
+
+  /* Some drivers expose the entry points but no binary format, in
+   * which case there is nothing we could store */
+  GE (context, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats));
+  if (n_formats <= 0)
+    return NULL;
+
+  path = g_build_filename (g_get_user_cache_dir (),
+                           "mutter", "program-binaries", NULL);
+  if (g_mkdir_with_parents (path, 0700) != 0)
+    {
+      g_warning ("Failed to create program binary cache directory %s: %s",
+                 path, g_strerror (errno));
+      return NULL;
+    }
+
+  cache = g_new0 (CoglProgramBinaryCache, 1);
+  cache->context = context;
+  cache->path = g_steal_pointer (&path);
+  cache->driver_id = compute_driver_id (context);
+  cache->used_keys = g_ptr_array_new_with_free_func (g_free);
+  cache->used_keys_set = g_hash_table_new (g_str_hash, g_str_equal);
+  g_queue_init (&cache->pending_keys);
+  cache->warm_programs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, NULL);
+
+  read_warm_up_list (cache);
+
+  return cache;
+}
+
+void
+_cogl_program_binary_cache_free (CoglProgramBinaryCache *cache)
+{
+  CoglContext *ctx = cache->context;
+  GHashTableIter iter;
+  gpointer value;
+
+  write_warm_up_list (cache);
+
+  g_hash_table_iter_init (&iter, cache->warm_programs);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    GE (ctx, glDeleteProgram (GPOINTER_TO_UINT (value)));
+  g_hash_table_destroy (cache->warm_programs);
+
+  g_queue_clear_full (&cache->pending_keys, g_free);
+  g_hash_table_destroy (cache->used_keys_set);
+  g_ptr_array_free (cache->used_keys, TRUE);
+  g_free (cache->driver_id);
+  g_free (cache->path);
+  g_free (cache);
+}
+
+char *
+_cogl_program_binary_cache_get_key (CoglProgramBinaryCache *cache,
+                                    const char             *vertex_hash,
+                                    const char             *fragment_hash)
+{
+  GChecksum *checksum;
+  char *key;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) cache->driver_id, -1);
+  g_checksum_update (checksum, (const guchar *) vertex_hash, -1);
+  g_checksum_update (checksum, (const guchar *) fragment_hash, -1);
+
+  key = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return key;
+}
+
+static char *
+get_file_path (CoglProgramBinaryCache *cache,
+               const char             *key)
+{
+  g_autofree char *basename = NULL;
+
+  basename = g_strconcat (key, COGL_PROGRAM_BINARY_SUFFIX, NULL);
+
+  return g_build_filename (cache->path, basename, NULL);
+}
+
+static void
+compute_checksum (const uint8_t *data,
+                  size_t         length,
+                  uint8_t        digest[32])
+{
+  GChecksum *checksum;
+  gsize digest_length = 32;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, data, length);
+  g_checksum_get_digest (checksum, digest, &digest_length);
+  g_checksum_free (checksum);
+}
+
+void
+_cogl_program_binary_cache_prepare_program (CoglProgramBinaryCache *cache,
+                                            GLuint                  program)
+{
+  CoglContext *ctx = cache->context;
+
+  /* GLES 3 and GL_OES_get_program_binary don't have the hint and
+   * always allow retrieving the binary */
+  if (ctx->glProgramParameteri)
+    GE (ctx, glProgramParameteri (program,
+                                  GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                  GL_TRUE));
+}
+
+static gboolean
+load_program (CoglProgramBinaryCache *cache,
+              const char             *key,
+              GLuint                  program)
+{
+  CoglContext *ctx = cache->context;
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  CoglProgramBinaryHeader header;
+  uint8_t checksum[32];
+  gsize length;
+  GLint link_status = GL_FALSE;
+
+  path = get_file_path (cache, key);
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return FALSE;
+
+  if (length < sizeof (header))
+    goto invalid;
+
+  memcpy (&header, contents, sizeof (header));
+
+  if (header.magic != COGL_PROGRAM_BINARY_MAGIC ||
+      header.length != length - sizeof (header))
+    goto invalid;
+
+  compute_checksum ((const uint8_t *) contents + sizeof (header),
+                    header.length, checksum);
+  if (memcmp (checksum, header.checksum, sizeof (checksum)) != 0)
+    goto invalid;
+
+  /* Drivers are allowed to reject binaries at any time, e.g. after an
+   * update that didn't change any of the version strings, so failing
+   * here is not an error */
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glProgramBinary (program, header.format,
+                        contents + sizeof (header), header.length);
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR)
+    goto invalid;
+
+  GE (ctx, glGetProgramiv (program, GL_LINK_STATUS, &link_status));
+  if (!link_status)
+    goto invalid;
+
+  /* Keep track of the last use for evicting old binaries */
+  g_utime (path, NULL);
+
+  return TRUE;
+
+invalid:
+  COGL_NOTE (OPENGL, "Discarding invalid program binary %s", path);
+
+  if (g_unlink (path) == 0 && cache->size_known)
+    cache->size -= length;
+
+  return FALSE;
+}
+
+gboolean
+_cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  program)
+{
+  if (!load_program (cache, key, program))
+    return FALSE;
+
+  mark_key_used (cache, key);
+
+  return TRUE;
+}
+
+static int
+compare_cache_files (gconstpointer a,
+                     gconstpointer b)
+{
+  const CacheFile *file_a = a;
+  const CacheFile *file_b = b;
+
+  if (file_a->mtime < file_b->mtime)
+    return -1;
+  else if (file_a->mtime > file_b->mtime)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+clear_cache_file (gpointer data)
+{
+  CacheFile *file = data;
+
+  g_free (file->path);
+}
+
+/* g_file_set_contents() writes to "<name>.XXXXXX" and renames it */
+static gboolean
+is_temp_file (const char *name)
+{
+  const char *suffix = strrchr (name, '.');
+  g_autofree char *target = NULL;
+
+  if (!suffix || strlen (suffix) != strlen (".XXXXXX"))
+    return FALSE;
+
+  target = g_strndup (name, suffix - name);
+
+  return g_str_has_suffix (target, COGL_PROGRAM_BINARY_SUFFIX) ||
+         g_str_equal (target, COGL_PROGRAM_WARM_UP_LIST);
+}
+
+static void
+update_cache_size (CoglProgramBinaryCache *cache)
+{
+  g_autoptr (GArray) files = NULL;
+  const char *name;
+  GDir *dir;
+  goffset size = 0;
+  int64_t now;
+  unsigned int i;
+
+  dir = g_dir_open (cache->path, 0, NULL);
+  if (!dir)
+    return;
+
+  files = g_array_new (FALSE, FALSE, sizeof (CacheFile));
+  g_array_set_clear_func (files, clear_cache_file);
+
+  now = g_get_real_time () / G_USEC_PER_SEC;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      g_autofree char *path = NULL;
+      GStatBuf stat_buf;
+      CacheFile file;
+
+      path = g_build_filename (cache->path, name, NULL);
+
+      if (g_str_equal (name, COGL_PROGRAM_WARM_UP_LIST))
+        continue;
+
+      if (g_stat (path, &stat_buf) != 0)
+        continue;
+
+      /* Other processes sharing the cache may be writing temporary files
+       * right now, so only remove the ones interrupted writes left behind
+       */
+      if (is_temp_file (name))
+        {
+          if (now - stat_buf.st_mtime > COGL_PROGRAM_BINARY_TEMP_FILE_MAX_AGE)
+            g_unlink (path);
+          continue;
+        }
+
+      if (!g_str_has_suffix (name, COGL_PROGRAM_BINARY_SUFFIX))
+        continue;
+
+      size += stat_buf.st_size;
+
+      file.path = g_steal_pointer (&path);
+      file.mtime = stat_buf.st_mtime;
+      file.size = stat_buf.st_size;
+      g_array_append_val (files, file);
+    }
+
+  g_dir_close (dir);
+
+  if (size > COGL_PROGRAM_BINARY_CACHE_MAX_SIZE)
+    {
+      g_array_sort (files, compare_cache_files);
+
+      /* Evict more than strictly necessary so we don't have to scan the
+       * directory again on the next save */
+      for (i = 0;
+           i < files->len && size > COGL_PROGRAM_BINARY_CACHE_MAX_SIZE / 4 * 3;
+           i++)
+        {
+          CacheFile *file = &g_array_index (files, CacheFile, i);
+
+          if (g_unlink (file->path) == 0)
+            size -= file->size;
+        }
+    }
+
+  cache->size = size;
+  cache->size_known = TRUE;
+}
+
+void
+_cogl_program_binary_cache_save (CoglProgramBinaryCache *cache,
+                                 const char             *key,
+                                 GLuint                  program)
+{
+  CoglContext *ctx = cache->context;
+  CoglProgramBinaryHeader header = { 0 };
+  g_autofree char *path = NULL;
+  g_autofree uint8_t *contents = NULL;
+  g_autoptr (GError) error = NULL;
+  GLint length = 0;
+  GLsizei written = 0;
+  GLenum format;
+
+  GE (ctx, glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &length));
+  if (length <= 0)
+    return;
+
+  contents = g_malloc (sizeof (header) + length);
+
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glGetProgramBinary (program, length, &written, &format,
+                           contents + sizeof (header));
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR || written <= 0)
+    return;
+
+  header.magic = COGL_PROGRAM_BINARY_MAGIC;
+  header.format = format;
+  header.length = written;
+  compute_checksum (contents + sizeof (header), written, header.checksum);
+  memcpy (contents, &header, sizeof (header));
+
+  path = get_file_path (cache, key);
+
+  if (!g_file_set_contents (path, (const char *) contents,
+                            sizeof (header) + written, &error))
+    {
+      g_warning ("Failed to save program binary: %s", error->message);
+      return;
+    }
+
+  mark_key_used (cache, key);
+
+  if (!cache->size_known)
+    update_cache_size (cache);
+  else
+    cache->size += sizeof (header) + written;
+
+  if (cache->size > COGL_PROGRAM_BINARY_CACHE_MAX_SIZE)
+    update_cache_size (cache);
+}
+
+GLuint
+_cogl_program_binary_cache_take_program (CoglProgramBinaryCache *cache,
+                                         const char             *key)
+{
+  gpointer key_copy;
+  gpointer value;
+
+  if (!g_hash_table_steal_extended (cache->warm_programs, key,
+                                    &key_copy, &value))
+    return 0;
+
+  g_free (key_copy);
+  mark_key_used (cache, key);
+
+  return GPOINTER_TO_UINT (value);
+}
+
+gboolean
+_cogl_program_binary_cache_warm_up (CoglProgramBinaryCache *cache,
+                                    int64_t                 budget_us)
+{
+  CoglContext *ctx = cache->context;
+  int64_t start_us = g_get_monotonic_time ();
+
+  do
+    {
+      g_autofree char *key = NULL;
+      GLuint program;
+
+      key = g_queue_pop_head (&cache->pending_keys);
+      if (!key)
+        break;
+
+      /* Already loaded on demand before the warm-up reached it */
+      if (g_hash_table_contains (cache->used_keys_set, key) ||
+          g_hash_table_contains (cache->warm_programs, key))
+        continue;
+
+      GE_RET (program, ctx, glCreateProgram ());
+
+      if (load_program (cache, key, program))
+        {
+          g_hash_table_insert (cache->warm_programs,
+                               g_steal_pointer (&key),
+                               GUINT_TO_POINTER (program));
+        }
+      else
+        {
+          GE (ctx, glDeleteProgram (program));
+        }
+    }
+  while (g_get_monotonic_time () - start_us < budget_us);
+
+  if (g_queue_is_empty (&cache->pending_keys))
+    {
+      /* Programs used during startup are known by now; later calls only
+       * rewrite the list when new programs were used in the meantime */
+      write_warm_up_list (cache);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+void
+_cogl_program_binary_cache_save_program_list (CoglProgramBinaryCache *cache)
+{
+  write_warm_up_list (cache);
+}
+
+UNIT_TEST (check_program_binary_cache_rejects_corrupt_entries,
+           TEST_REQUIREMENT_GLSL,
+           0 /* no failure cases */)
+{
+  CoglProgramBinaryCache *cache =
+    _cogl_driver_gl_context (test_ctx)->program_binary_cache;
+  CoglProgramBinaryHeader header = { 0 };
+  g_autofree char *key = NULL;
+  g_autofree char *path = NULL;
+  uint8_t contents[sizeof (header) + 16] = { 0 };
+  GLuint program;
+
+  if (!cache)
+    {
+      if (cogl_test_verbose ())
+        g_print ("Program binaries are not supported\n");
+      return;
+    }
+
+  key = _cogl_program_binary_cache_get_key (cache,
+                                            "check-corrupt-vertex",
+                                            "check-corrupt-fragment");
+  path = get_file_path (cache, key);
+
+  GE_RET (program, test_ctx, glCreateProgram ());
+
+  /* Truncated file */
+  g_assert_true (g_file_set_contents (path, "CPB1", -1, NULL));
+  g_assert_false (_cogl_program_binary_cache_load (cache, key, program));
+  g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+
+  /* Valid header, but the contents don't match the checksum */
+  header.magic = COGL_PROGRAM_BINARY_MAGIC;
+  header.length = sizeof (contents) - sizeof (header);
+  memcpy (contents, &header, sizeof (header));
+  g_assert_true (g_file_set_contents (path, (const char *) contents,
+                                      sizeof (contents), NULL));
+  g_assert_false (_cogl_program_binary_cache_load (cache, key, program));
+  g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+
+  GE (test_ctx, glDeleteProgram (program));
+}
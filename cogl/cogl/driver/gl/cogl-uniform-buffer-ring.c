@@ -0,0 +1,136 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+/*
+ * A single GL buffer that uniform block data is streamed into. Every
+ * update is written to a new aligned slot after the previous one and
+ * bound with glBindBufferRange(), so data that is still being read by
+ * queued draw calls is never overwritten. Once the end of the buffer
+ * is reached its storage is orphaned and writing starts over from the
+ * beginning, which lets the driver hand out fresh memory instead of
+ * waiting for the GPU.
+ */
+
+#include "cogl-config.h"
+
+#include "driver/gl/cogl-uniform-buffer-ring-private.h"
+
+#include "cogl-context-private.h"
+#include "cogl-debug.h"
+#include "driver/gl/cogl-util-gl-private.h"
+
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+#define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8A34
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+
+#define COGL_UNIFORM_BUFFER_RING_SIZE (64 * 1024)
+
+struct _CoglUniformBufferRing
+{
+  CoglContext *context;
+
+  GLuint buffer;
+  size_t alignment;
+  size_t offset;
+};
+
+static void
+orphan_storage (CoglUniformBufferRing *ring)
+{
+  CoglContext *ctx = ring->context;
+
+  GE (ctx, glBufferData (GL_UNIFORM_BUFFER,
+                         COGL_UNIFORM_BUFFER_RING_SIZE,
+                         NULL,
+                         GL_STREAM_DRAW));
+  ring->offset = 0;
+}
+
+CoglUniformBufferRing *
+_cogl_uniform_buffer_ring_new (CoglContext *context)
+{
+  CoglUniformBufferRing *ring;
+  GLint alignment = 0;
+
+  if (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_UNIFORM_BUFFERS))
+    return NULL;
+
+  if (!context->glGetUniformBlockIndex ||
+      !context->glUniformBlockBinding ||
+      !context->glBindBufferRange)
+    return NULL;
+
+  GE (context, glGetIntegerv (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+  if (alignment <= 0)
+    alignment = 256;
+
+  ring = g_new0 (CoglUniformBufferRing, 1);
+  ring->context = context;
+  ring->alignment = alignment;
+
+  GE (context, glGenBuffers (1, &ring->buffer));
+  GE (context, glBindBuffer (GL_UNIFORM_BUFFER, ring->buffer));
+  orphan_storage (ring);
+
+  return ring;
+}
+
+void
+_cogl_uniform_buffer_ring_free (CoglUniformBufferRing *ring)
+{
+  CoglContext *ctx = ring->context;
+
+  GE (ctx, glDeleteBuffers (1, &ring->buffer));
+  g_free (ring);
+}
+
+void
+_cogl_uniform_buffer_ring_bind_data (CoglUniformBufferRing *ring,
+                                     GLuint                 binding,
+                                     const void            *data,
+                                     size_t                 size)
+{
+  CoglContext *ctx = ring->context;
+  size_t slot_size;
+
+  slot_size = (size + ring->alignment - 1) / ring->alignment * ring->alignment;
+  g_return_if_fail (slot_size <= COGL_UNIFORM_BUFFER_RING_SIZE);
+
+  GE (ctx, glBindBuffer (GL_UNIFORM_BUFFER, ring->buffer));
+
+  if (ring->offset + slot_size > COGL_UNIFORM_BUFFER_RING_SIZE)
+    orphan_storage (ring);
+
+  GE (ctx, glBufferSubData (GL_UNIFORM_BUFFER, ring->offset, size, data));
+  GE (ctx, glBindBufferRange (GL_UNIFORM_BUFFER, binding,
+                              ring->buffer, ring->offset, size));
+
+  ring->offset += slot_size;
+}
@@ -36,6 +36,9 @@
 #include "cogl-context.h"
 #include "cogl-gl-header.h"
 #include "cogl-texture.h"
+#include "cogl-matrix-stack-private.h"
+#include "driver/gl/cogl-program-binary-cache-private.h"
+#include "driver/gl/cogl-uniform-buffer-ring-private.h"
 
 /* In OpenGL ES context, GL_CONTEXT_LOST has a _KHR prefix */
 #ifndef GL_CONTEXT_LOST
@@ -83,6 +86,33 @@ typedef struct _CoglGLContext {
   /* This is used for generated fake unique sampler object numbers
    when the sampler object extension is not supported */
   GLuint next_fake_sampler_object_number;
+
+  /* Shadow of the GL blend and culling state. The pipeline flushing
+     code only knows which state differs between two pipelines, so this
+     lets it skip calls when a different pipeline already set the same
+     values, e.g. after the journal was flushed */
+  GLenum blend_equation_rgb;
+  GLenum blend_equation_alpha;
+  GLint blend_src_factor_rgb;
+  GLint blend_dst_factor_rgb;
+  GLint blend_src_factor_alpha;
+  GLint blend_dst_factor_alpha;
+  float blend_constant[4];
+  gboolean cull_face_enabled;
+  GLenum cull_face_mode;
+  GLenum front_face;
+
+  /* NULL if the driver can't retrieve program binaries */
+  CoglProgramBinaryCache *program_binary_cache;
+
+  /* NULL if the driver can't use uniform buffers. Otherwise the
+     transform uniforms of the generated GLSL programs are shared
+     through a uniform block, and these caches track what was last
+     written to it */
+  CoglUniformBufferRing *uniform_buffer_ring;
+  CoglMatrixEntryCache transform_block_projection_cache;
+  CoglMatrixEntryCache transform_block_modelview_cache;
+  int transform_block_flip_state;
 } CoglGLContext;
 
 CoglGLContext *
@@ -160,6 +190,13 @@ cogl_gl_timestamp_query_get_time_ns (CoglContext        *context,
 int64_t
 cogl_gl_get_gpu_time_ns (CoglContext *context);
 
+gboolean
+cogl_gl_warm_up_programs (CoglContext *context,
+                          int64_t      budget_us);
+
+void
+cogl_gl_save_program_list (CoglContext *context);
+
 #ifndef GL_FRAMEBUFFER
 #define GL_FRAMEBUFFER		0x8D40
 #endif
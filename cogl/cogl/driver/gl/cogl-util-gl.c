@@ -115,6 +115,17 @@ _cogl_driver_gl_context_init (CoglContext *context)
     return FALSE;
 
   gl_context->next_fake_sampler_object_number = 1;
+
+  /* The initial GL state */
+  gl_context->blend_equation_rgb = GL_FUNC_ADD;
+  gl_context->blend_equation_alpha = GL_FUNC_ADD;
+  gl_context->blend_src_factor_rgb = GL_ONE;
+  gl_context->blend_dst_factor_rgb = GL_ZERO;
+  gl_context->blend_src_factor_alpha = GL_ONE;
+  gl_context->blend_dst_factor_alpha = GL_ZERO;
+  gl_context->cull_face_enabled = FALSE;
+  gl_context->cull_face_mode = GL_BACK;
+  gl_context->front_face = GL_CCW;
   gl_context->texture_units =
     g_array_new (FALSE, FALSE, sizeof (CoglTextureUnit));
 
@@ -123,12 +134,27 @@ _cogl_driver_gl_context_init (CoglContext *context)
   gl_context->active_texture_unit = 1;
   GE (context, glActiveTexture (GL_TEXTURE1));
 
+  gl_context->program_binary_cache = _cogl_program_binary_cache_new (context);
+
+  gl_context->uniform_buffer_ring = _cogl_uniform_buffer_ring_new (context);
+  _cogl_matrix_entry_cache_init (&gl_context->transform_block_projection_cache);
+  _cogl_matrix_entry_cache_init (&gl_context->transform_block_modelview_cache);
+  gl_context->transform_block_flip_state = -1;
+
   return TRUE;
 }
 
 void
 _cogl_driver_gl_context_deinit (CoglContext *context)
 {
+  CoglGLContext *gl_context = _cogl_driver_gl_context (context);
+
+  g_clear_pointer (&gl_context->program_binary_cache,
+                   _cogl_program_binary_cache_free);
+  g_clear_pointer (&gl_context->uniform_buffer_ring,
+                   _cogl_uniform_buffer_ring_free);
+  _cogl_matrix_entry_cache_destroy (&gl_context->transform_block_projection_cache);
+  _cogl_matrix_entry_cache_destroy (&gl_context->transform_block_modelview_cache);
   _cogl_destroy_texture_units (context);
   g_free (context->driver_context);
 }
@@ -560,3 +586,27 @@ cogl_gl_get_gpu_time_ns (CoglContext *context)
   GE (context, glGetInteger64v (GL_TIMESTAMP, &gpu_time_ns));
   return gpu_time_ns;
 }
+
+gboolean
+cogl_gl_warm_up_programs (CoglContext *context,
+                          int64_t      budget_us)
+{
+  CoglGLContext *gl_context = _cogl_driver_gl_context (context);
+
+  if (!gl_context->program_binary_cache)
+    return FALSE;
+
+  return _cogl_program_binary_cache_warm_up (gl_context->program_binary_cache,
+                                             budget_us);
+}
+
+void
+cogl_gl_save_program_list (CoglContext *context)
+{
+  CoglGLContext *gl_context = _cogl_driver_gl_context (context);
+
+  if (!gl_context->program_binary_cache)
+    return;
+
+  _cogl_program_binary_cache_save_program_list (gl_context->program_binary_cache);
+}
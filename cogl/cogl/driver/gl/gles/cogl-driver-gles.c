@@ -493,4 +493,6 @@ _cogl_driver_gles =
     cogl_gl_free_timestamp_query,
     cogl_gl_timestamp_query_get_time_ns,
     cogl_gl_get_gpu_time_ns,
+    cogl_gl_warm_up_programs,
+    cogl_gl_save_program_list,
   };
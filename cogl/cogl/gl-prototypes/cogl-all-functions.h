@@ -275,3 +275,39 @@ COGL_EXT_FUNCTION (void, glGenQueries,
 COGL_EXT_FUNCTION (void, glDeleteQueries,
                    (GLsizei n, const GLuint *ids))
 COGL_EXT_END ()
+
+/* GLES 3 has uniform buffers too but only for GLSL ES 3.00, which
+ * Cogl doesn't generate */
+COGL_EXT_BEGIN (uniform_buffer_object, 3, 1,
+                0,
+                "ARB:\0",
+                "uniform_buffer_object\0")
+COGL_EXT_FUNCTION (GLuint, glGetUniformBlockIndex,
+                   (GLuint program, const GLchar *uniformBlockName))
+COGL_EXT_FUNCTION (void, glUniformBlockBinding,
+                   (GLuint program, GLuint uniformBlockIndex,
+                    GLuint uniformBlockBinding))
+COGL_EXT_FUNCTION (void, glBindBufferRange,
+                   (GLenum target, GLuint index, GLuint buffer,
+                    GLintptr offset, GLsizeiptr size))
+COGL_EXT_END ()
+
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program, GLsizei bufSize, GLsizei *length,
+                    GLenum *binaryFormat, void *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program, GLenum binaryFormat,
+                    const void *binary, GLsizei length))
+COGL_EXT_END ()
+
+COGL_EXT_BEGIN (program_parameteri, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glProgramParameteri,
+                   (GLuint program, GLenum pname, GLint value))
+COGL_EXT_END ()
@@ -99,6 +99,7 @@ main (int argc, char **argv)
 
   ADD_TEST (test_offscreen, 0, 0);
   ADD_TEST (test_journal_unref_flush, 0, 0);
+  ADD_TEST (test_journal_reorder, 0, 0);
   ADD_TEST (test_framebuffer_get_bits,
             TEST_REQUIREMENT_OFFSCREEN | TEST_REQUIREMENT_GL,
             0);
@@ -136,6 +137,7 @@ main (int argc, char **argv)
   ADD_TEST (test_color_hsl, 0, 0);
 
   ADD_TEST (test_fence, TEST_REQUIREMENT_FENCE, 0);
+  ADD_TEST (test_read_pixels_async, 0, 0);
 
   ADD_TEST (test_texture_no_allocate, 0, 0);
 
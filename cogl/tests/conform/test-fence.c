@@ -58,3 +58,59 @@ test_fence (void)
   if (cogl_test_verbose ())
     g_print ("OK\n");
 }
+
+static void
+read_pixels_callback (CoglFramebuffer *framebuffer,
+                      const uint8_t *pixels,
+                      int rowstride,
+                      const GError *error,
+                      void *user_data)
+{
+  g_assert_no_error (error);
+  g_assert (framebuffer == test_fb);
+  g_assert (user_data == MAGIC_CHUNK_O_DATA && "callback data not mangled");
+  g_assert_cmpint (rowstride, ==, 4);
+
+  /* The top row is red and the bottom one is still the clear color */
+  test_utils_compare_pixel (pixels, 0xff0000ff);
+  test_utils_compare_pixel (pixels + rowstride, 0x00ff00ff);
+
+  g_main_loop_quit (loop);
+}
+
+void
+test_read_pixels_async (void)
+{
+  GSource *cogl_source;
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+  CoglPipeline *pipeline;
+
+  cogl_source = cogl_glib_source_new (test_ctx, G_PRIORITY_DEFAULT);
+  g_source_attach (cogl_source, NULL);
+  loop = g_main_loop_new (NULL, TRUE);
+
+  cogl_framebuffer_orthographic (test_fb, 0, 0, fb_width, fb_height, -1, 100);
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR,
+                            0.0f, 1.0f, 0.0f, 1.0f);
+
+  pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (pipeline, 0xff, 0x00, 0x00, 0xff);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline,
+                                   0, 0, fb_width, fb_height / 2);
+  cogl_object_unref (pipeline);
+
+  cogl_framebuffer_read_pixels_async (test_fb,
+                                      0, fb_height / 2 - 1,
+                                      1, 2,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                      read_pixels_callback,
+                                      MAGIC_CHUNK_O_DATA);
+
+  g_timeout_add_seconds (5, timeout, NULL);
+
+  g_main_loop_run (loop);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -44,3 +44,67 @@ test_journal_unref_flush (void)
 
   cogl_object_unref (texture);
 }
+
+static void
+draw_colored_rectangle (CoglPipeline *pipeline,
+                        uint32_t      color,
+                        float         x1,
+                        float         x2)
+{
+  CoglPipeline *copy = cogl_pipeline_copy (pipeline);
+
+  cogl_pipeline_set_color4ub (copy,
+                              (color >> 24) & 0xff,
+                              (color >> 16) & 0xff,
+                              (color >> 8) & 0xff,
+                              color & 0xff);
+  cogl_framebuffer_draw_rectangle (test_fb, copy, x1, 0, x2, 100);
+  cogl_object_unref (copy);
+}
+
+void
+test_journal_reorder (void)
+{
+  CoglPipeline *pipeline;
+  CoglPipeline *other_pipeline;
+  graphene_matrix_t matrix;
+
+  graphene_matrix_init_ortho (&matrix,
+                              0.f, cogl_framebuffer_get_width (test_fb),
+                              cogl_framebuffer_get_height (test_fb), 0.f,
+                              -1.f, 1.f);
+  cogl_framebuffer_set_modelview_matrix (test_fb, &matrix);
+
+  /* The two pipelines can't be batched together. The blend string
+   * gives the same result as the default blending for opaque colors */
+  pipeline = cogl_pipeline_new (test_ctx);
+  other_pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_blend (other_pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  /* Each rectangle overlaps the previous one, so the journal must
+   * not draw the blue one before the green one even though it could
+   * be batched with the red one */
+  draw_colored_rectangle (pipeline, 0xff0000ff, 0, 100);
+  draw_colored_rectangle (other_pipeline, 0x00ff00ff, 50, 150);
+  draw_colored_rectangle (pipeline, 0x0000ffff, 100, 200);
+
+  /* These don't overlap anything drawn in between so they can be
+   * moved into the earlier batches */
+  draw_colored_rectangle (other_pipeline, 0xffff00ff, 250, 300);
+  draw_colored_rectangle (pipeline, 0x00ffffff, 300, 350);
+  draw_colored_rectangle (other_pipeline, 0xff00ffff, 350, 400);
+
+  test_utils_check_region (test_fb, 1, 1, 48, 98, 0xff0000ff);
+  test_utils_check_region (test_fb, 51, 1, 48, 98, 0x00ff00ff);
+  test_utils_check_region (test_fb, 101, 1, 98, 98, 0x0000ffff);
+  test_utils_check_region (test_fb, 201, 1, 48, 98, 0x000000ff);
+  test_utils_check_region (test_fb, 251, 1, 48, 98, 0xffff00ff);
+  test_utils_check_region (test_fb, 301, 1, 48, 98, 0x00ffffff);
+  test_utils_check_region (test_fb, 351, 1, 48, 98, 0xff00ffff);
+
+  cogl_object_unref (other_pipeline);
+  cogl_object_unref (pipeline);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -39,6 +39,8 @@
 
 #include "meta-private-enum-types.h"
 
+#define MAX_CACHED_KEYMAPS 8
+
 enum
 {
   PROP_0,
@@ -236,6 +238,7 @@ meta_seat_native_dispose (GObject *object)
   MetaSeatNative *seat = META_SEAT_NATIVE (object);
 
   g_clear_pointer (&seat->xkb_keymap, xkb_keymap_unref);
+  g_clear_pointer (&seat->xkb_keymaps, g_hash_table_unref);
   g_clear_object (&seat->core_pointer);
   g_clear_object (&seat->core_keyboard);
   g_clear_pointer (&seat->impl, meta_seat_impl_destroy);
@@ -425,6 +428,10 @@ static void
 meta_seat_native_init (MetaSeatNative *seat)
 {
   seat->reserved_virtual_slots = g_hash_table_new (NULL, NULL);
+  seat->xkb_keymaps =
+    g_hash_table_new_full (g_str_hash, g_str_equal,
+                           g_free,
+                           (GDestroyNotify) xkb_keymap_unref);
 }
 
 /**
@@ -518,18 +525,46 @@ meta_seat_native_set_keyboard_map (MetaSeatNative *seat,
                                    const char     *options)
 {
   struct xkb_keymap *keymap, *impl_keymap;
+  g_autofree char *names = NULL;
+
+  /* Switching between more layouts than fit in a single keymap sets the
+   * same configurations over and over; reuse the keymaps compiled for
+   * them, so that their users can cache anything derived from them.
+   */
+  names = g_strdup_printf ("%s\x1f%s\x1f%s",
+                           layouts ? layouts : "",
+                           variants ? variants : "",
+                           options ? options : "");
+
+  keymap = g_hash_table_lookup (seat->xkb_keymaps, names);
+  if (keymap)
+    {
+      xkb_keymap_ref (keymap);
+    }
+  else
+    {
+      keymap = create_keymap (layouts, variants, options);
+      if (keymap == NULL)
+        {
+          g_warning ("Unable to load configured keymap: rules=%s, model=%s, layout=%s, variant=%s, options=%s",
+                     DEFAULT_XKB_RULES_FILE, DEFAULT_XKB_MODEL, layouts,
+                     variants, options);
+          return;
+        }
 
-  keymap = create_keymap (layouts, variants, options);
-  impl_keymap = create_keymap (layouts, variants, options);
+      if (g_hash_table_size (seat->xkb_keymaps) >= MAX_CACHED_KEYMAPS)
+        g_hash_table_remove_all (seat->xkb_keymaps);
 
-  if (keymap == NULL)
-    {
-      g_warning ("Unable to load configured keymap: rules=%s, model=%s, layout=%s, variant=%s, options=%s",
-                 DEFAULT_XKB_RULES_FILE, DEFAULT_XKB_MODEL, layouts,
-                 variants, options);
-      return;
+      g_hash_table_insert (seat->xkb_keymaps,
+                           g_steal_pointer (&names),
+                           xkb_keymap_ref (keymap));
     }
 
+  /* The keymap is reference counted without locking, so the input thread
+   * gets its own
+   */
+  impl_keymap = create_keymap (layouts, variants, options);
+
   if (seat->xkb_keymap)
     xkb_keymap_unref (seat->xkb_keymap);
   seat->xkb_keymap = keymap;
@@ -50,6 +50,7 @@ struct _MetaSeatNative
   GList *devices;
   struct xkb_keymap *xkb_keymap;
   xkb_layout_index_t xkb_layout_index;
+  GHashTable *xkb_keymaps;
 
   ClutterInputDevice *core_pointer;
   ClutterInputDevice *core_keyboard;
@@ -21,9 +21,20 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <glib-unix.h>
+#include <poll.h>
+#include <sys/stat.h>
+
 #include "core/meta-selection-private.h"
 #include "meta/meta-selection.h"
 
+#define SPLICE_CHUNK_SIZE (64 * 1024)
+#define SPLICE_MAX_CHUNKS_PER_DISPATCH 4
+
 typedef struct TransferRequest TransferRequest;
 
 struct _MetaSelection
@@ -366,6 +377,177 @@ read_selection_source_async (GTask           *task,
                                    task);
 }
 
+static gboolean
+is_pipe (int fd)
+{
+  struct stat st;
+
+  if (fstat (fd, &st) != 0)
+    return FALSE;
+
+  return S_ISFIFO (st.st_mode);
+}
+
+static void
+finish_splice_transfer (GTask           *task,
+                        TransferRequest *request,
+                        GError          *error)
+{
+  /* Like g_output_stream_splice_async() with the CLOSE_SOURCE and
+   * CLOSE_TARGET flags, always close both ends so that the peers see EOF
+   * even if the transfer failed or was cancelled.
+   */
+  g_input_stream_close (request->istream, NULL, NULL);
+  g_output_stream_close (request->ostream, NULL, NULL);
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static void wait_splice_transfer (GTask        *task,
+                                  int           fd,
+                                  GIOCondition  condition);
+
+static gboolean
+splice_transfer_cb (int           fd,
+                    GIOCondition  condition,
+                    gpointer      user_data)
+{
+  GTask *task = user_data;
+  TransferRequest *request = g_task_get_task_data (task);
+  GError *error = NULL;
+  int in_fd, out_fd;
+  int n_chunks = 0;
+
+  if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task),
+                                            &error))
+    {
+      finish_splice_transfer (task, request, error);
+      return G_SOURCE_REMOVE;
+    }
+
+  in_fd = g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream));
+  out_fd = g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (request->ostream));
+
+  while (TRUE)
+    {
+      size_t chunk_size = SPLICE_CHUNK_SIZE;
+      struct pollfd pfd = { .fd = in_fd, .events = POLLIN };
+      ssize_t n_moved;
+
+      if (request->len == 0)
+        break;
+      else if (request->len > 0)
+        chunk_size = MIN (chunk_size, (size_t) request->len);
+
+      /* Don't starve the main loop while a large transfer keeps both
+       * ends ready; continue on the next dispatch instead.
+       */
+      if (n_chunks == SPLICE_MAX_CHUNKS_PER_DISPATCH)
+        return G_SOURCE_CONTINUE;
+
+      n_moved = splice (in_fd, NULL, out_fd, NULL, chunk_size,
+                        SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n_moved > 0)
+        {
+          if (request->len > 0)
+            request->len -= n_moved;
+          n_chunks++;
+          continue;
+        }
+      else if (n_moved == 0)
+        {
+          break;
+        }
+
+      if (errno == EINTR)
+        continue;
+
+      if (errno != EAGAIN)
+        {
+          int errsv = errno;
+
+          g_set_error (&error, G_IO_ERROR,
+                       g_io_error_from_errno (errsv),
+                       "Failed to splice selection contents: %s",
+                       g_strerror (errsv));
+          finish_splice_transfer (task, request, error);
+          return G_SOURCE_REMOVE;
+        }
+
+      /* Either there is nothing to read yet, or the reader on the other
+       * end is not keeping up; wait for whichever side is blocking.
+       */
+      if (poll (&pfd, 1, 0) > 0)
+        wait_splice_transfer (task, out_fd, G_IO_OUT | G_IO_ERR);
+      else
+        wait_splice_transfer (task, in_fd, G_IO_IN | G_IO_HUP | G_IO_ERR);
+
+      return G_SOURCE_REMOVE;
+    }
+
+  finish_splice_transfer (task, request, NULL);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+wait_splice_transfer (GTask        *task,
+                      int           fd,
+                      GIOCondition  condition)
+{
+  GSource *source;
+  GSource *cancellable_source;
+
+  source = g_unix_fd_source_new (fd, condition);
+  cancellable_source = g_cancellable_source_new (g_task_get_cancellable (task));
+  g_source_set_dummy_callback (cancellable_source);
+  g_source_add_child_source (source, cancellable_source);
+  g_source_unref (cancellable_source);
+
+  g_source_set_callback (source, (GSourceFunc) splice_transfer_cb,
+                         task, NULL);
+  g_source_attach (source, g_main_context_get_thread_default ());
+  g_source_unref (source);
+}
+
+/*
+ * Moves the contents directly between the source and destination file
+ * descriptors with splice(), without copying them into userspace buffers.
+ * This is only possible when both ends are backed by file descriptors and
+ * at least one of them is a pipe. The destination is usually a file
+ * descriptor handed over by a client, which may be in blocking mode and
+ * whose flags are shared with the client, and SPLICE_F_NONBLOCK only
+ * applies to pipes. To never block the main loop on it, only take this
+ * path if the destination is a pipe, which is the case for transfers
+ * between Wayland clients.
+ */
+static gboolean
+try_splice_transfer_async (GTask           *task,
+                           TransferRequest *request)
+{
+  int in_fd, out_fd;
+
+  if (!G_IS_UNIX_INPUT_STREAM (request->istream) ||
+      !G_IS_UNIX_OUTPUT_STREAM (request->ostream))
+    return FALSE;
+
+  in_fd = g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream));
+  out_fd = g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (request->ostream));
+
+  if (!is_pipe (out_fd))
+    return FALSE;
+
+  if (!g_unix_set_fd_nonblocking (in_fd, TRUE, NULL))
+    return FALSE;
+
+  wait_splice_transfer (task, in_fd, G_IO_IN | G_IO_HUP | G_IO_ERR);
+
+  return TRUE;
+}
+
 static void
 source_read_cb (MetaSelectionSource *source,
                 GAsyncResult        *result,
@@ -386,6 +568,9 @@ source_read_cb (MetaSelectionSource *source,
   request = g_task_get_task_data (task);
   request->istream = stream;
 
+  if (try_splice_transfer_async (task, request))
+    return;
+
   if (request->len < 0)
     {
       g_output_stream_splice_async (request->ostream,
@@ -0,0 +1,258 @@
+#define CLUTTER_DISABLE_DEPRECATION_WARNINGS
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define ACTOR_SIZE 100
+#define DAMAGE_SIZE 10
+
+typedef struct _FooEffectClass
+{
+  ClutterOffscreenEffectClass parent_class;
+} FooEffectClass;
+
+typedef struct _FooEffect
+{
+  ClutterOffscreenEffect parent;
+} FooEffect;
+
+GType foo_effect_get_type (void);
+
+G_DEFINE_TYPE (FooEffect, foo_effect, CLUTTER_TYPE_OFFSCREEN_EFFECT)
+
+static void
+foo_effect_class_init (FooEffectClass *klass)
+{
+}
+
+static void
+foo_effect_init (FooEffect *self)
+{
+}
+
+/* An actor painting itself with a color that can be changed without
+ * queueing a redraw, so that the color in the offscreen buffer tells
+ * which parts of it were redrawn.
+ */
+typedef struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+} FooActorClass;
+
+typedef struct _FooActor
+{
+  ClutterActor parent;
+
+  guint32 color;
+} FooActor;
+
+GType foo_actor_get_type (void);
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR)
+
+static void
+foo_actor_paint (ClutterActor        *actor,
+                 ClutterPaintContext *paint_context)
+{
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  FooActor *foo_actor = (FooActor *) actor;
+  CoglFramebuffer *framebuffer;
+  ClutterActorBox allocation;
+  CoglPipeline *pipeline;
+
+  clutter_actor_get_allocation_box (actor, &allocation);
+
+  pipeline = cogl_pipeline_new (ctx);
+  cogl_pipeline_set_color4ub (pipeline,
+                              (foo_actor->color >> 16) & 0xff,
+                              (foo_actor->color >> 8) & 0xff,
+                              foo_actor->color & 0xff,
+                              0xff);
+
+  framebuffer = clutter_paint_context_get_framebuffer (paint_context);
+  cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
+                                   0, 0,
+                                   allocation.x2 - allocation.x1,
+                                   allocation.y2 - allocation.y1);
+  cogl_object_unref (pipeline);
+}
+
+static gboolean
+foo_actor_get_paint_volume (ClutterActor       *actor,
+                            ClutterPaintVolume *volume)
+{
+  return clutter_paint_volume_set_from_allocation (volume, actor);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint = foo_actor_paint;
+  actor_class->get_paint_volume = foo_actor_get_paint_volume;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+  FooActor *foo_actor;
+  FooActor *damage_actor;
+  ClutterEffect *effect;
+} Data;
+
+static guint32
+get_texture_pixel (CoglTexture *texture,
+                   int          x,
+                   int          y)
+{
+  int width = cogl_texture_get_width (texture);
+  int height = cogl_texture_get_height (texture);
+  g_autofree guint8 *data = NULL;
+  guint8 *pixel;
+
+  g_assert_cmpint (x, <, width);
+  g_assert_cmpint (y, <, height);
+
+  data = g_malloc (width * height * 4);
+  cogl_texture_get_data (texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         width * 4,
+                         data);
+
+  pixel = data + (y * width + x) * 4;
+
+  return (((guint32) pixel[0] << 16) |
+          ((guint32) pixel[1] << 8) |
+          pixel[2]);
+}
+
+static void
+paint_damage (Data    *data,
+              guint32  color)
+{
+  graphene_point3d_t origin = { 0 };
+  graphene_point3d_t position;
+  guint8 *pixels;
+
+  /* Change the color behind the effect's back, and only damage the small
+   * actor in the top left corner. Reading back the pixels of the damaged
+   * area paints the stage synchronously, with the read area as the redraw
+   * clip.
+   */
+  data->foo_actor->color = color;
+  data->damage_actor->color = color;
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (data->damage_actor));
+
+  clutter_actor_apply_transform_to_point (data->actor, &origin, &position);
+  pixels = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                      position.x, position.y,
+                                      DAMAGE_SIZE, DAMAGE_SIZE);
+  g_free (pixels);
+}
+
+static void
+paint_full (Data    *data,
+            guint32  color)
+{
+  float width, height;
+  guint8 *pixels;
+
+  data->foo_actor->color = color;
+  data->damage_actor->color = color;
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (data->foo_actor));
+
+  clutter_actor_get_size (data->stage, &width, &height);
+  pixels = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                      0, 0,
+                                      width, height);
+  g_free (pixels);
+}
+
+static void
+actor_offscreen_effect_damage (void)
+{
+  Data data = { 0 };
+  GMainLoop *main_loop;
+  CoglTexture *texture;
+  float stage_width;
+  gulong paint_handler;
+
+  data.stage = clutter_test_get_stage ();
+
+  data.actor = clutter_actor_new ();
+  clutter_actor_set_position (data.actor, 50, 50);
+  clutter_actor_set_size (data.actor, ACTOR_SIZE, ACTOR_SIZE);
+
+  data.foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (data.foo_actor),
+                          ACTOR_SIZE, ACTOR_SIZE);
+  clutter_actor_add_child (data.actor, CLUTTER_ACTOR (data.foo_actor));
+
+  data.damage_actor = g_object_new (foo_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (data.damage_actor),
+                          DAMAGE_SIZE, DAMAGE_SIZE);
+  clutter_actor_add_child (data.actor, CLUTTER_ACTOR (data.damage_actor));
+
+  data.effect = g_object_new (foo_effect_get_type (), NULL);
+  clutter_actor_add_effect (data.actor, data.effect);
+
+  clutter_actor_add_child (data.stage, data.actor);
+  clutter_actor_show (data.stage);
+
+  main_loop = g_main_loop_new (NULL, TRUE);
+  paint_handler = g_signal_connect_swapped (data.stage, "after-paint",
+                                            G_CALLBACK (g_main_loop_quit),
+                                            main_loop);
+  g_main_loop_run (main_loop);
+  g_clear_signal_handler (&paint_handler, data.stage);
+  g_main_loop_unref (main_loop);
+
+  /* Fully inside the view, only the damaged corner of the offscreen buffer
+   * is redrawn.
+   */
+  paint_full (&data, 0xff0000);
+  paint_damage (&data, 0x00ff00);
+
+  texture =
+    clutter_offscreen_effect_get_texture (CLUTTER_OFFSCREEN_EFFECT (data.effect));
+  g_assert_nonnull (texture);
+  g_assert_cmpint (get_texture_pixel (texture, 1, 1), ==, 0x00ff00);
+  g_assert_cmpint (get_texture_pixel (texture,
+                                      ACTOR_SIZE - 1, ACTOR_SIZE - 1),
+                   ==, 0xff0000);
+
+  /* Partially outside the view, the redraw clip doesn't cover all of the
+   * actor, so the whole offscreen buffer must be redrawn. The actor is moved
+   * with a translation, which doesn't need a new layout pass.
+   */
+  clutter_actor_get_size (data.stage, &stage_width, NULL);
+  clutter_actor_set_translation (data.actor,
+                                 stage_width - ACTOR_SIZE / 2 - 50, 0, 0);
+
+  paint_full (&data, 0x0000ff);
+  paint_damage (&data, 0xffff00);
+
+  texture =
+    clutter_offscreen_effect_get_texture (CLUTTER_OFFSCREEN_EFFECT (data.effect));
+  g_assert_nonnull (texture);
+  g_assert_cmpint (get_texture_pixel (texture, 1, 1), ==, 0xffff00);
+  g_assert_cmpint (get_texture_pixel (texture,
+                                      cogl_texture_get_width (texture) - 1,
+                                      cogl_texture_get_height (texture) - 1),
+                   ==, 0xffff00);
+
+  clutter_actor_destroy (data.actor);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/offscreen-effect/damage",
+                     actor_offscreen_effect_damage)
+)
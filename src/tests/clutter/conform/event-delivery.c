@@ -0,0 +1,117 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct
+{
+  ClutterEventType type;
+  float x;
+} DeliveredEvent;
+
+static gboolean
+on_captured_event (ClutterActor *stage,
+                   ClutterEvent *event,
+                   GArray       *delivered)
+{
+  DeliveredEvent delivered_event = { 0 };
+
+  switch (clutter_event_type (event))
+    {
+    case CLUTTER_MOTION:
+    case CLUTTER_KEY_PRESS:
+      delivered_event.type = clutter_event_type (event);
+      clutter_event_get_coords (event, &delivered_event.x, NULL);
+      g_array_append_val (delivered, delivered_event);
+      break;
+    default:
+      break;
+    }
+
+  return CLUTTER_EVENT_PROPAGATE;
+}
+
+static void
+put_motion_event (ClutterStage       *stage,
+                  ClutterInputDevice *device,
+                  float               x,
+                  float               y)
+{
+  ClutterEvent *event;
+
+  event = clutter_event_new (CLUTTER_MOTION);
+  clutter_event_set_stage (event, stage);
+  clutter_event_set_device (event, device);
+  clutter_event_set_coords (event, x, y);
+  clutter_event_put (event);
+  clutter_event_free (event);
+}
+
+static void
+put_key_event (ClutterStage       *stage,
+               ClutterInputDevice *device)
+{
+  ClutterEvent *event;
+
+  event = clutter_event_new (CLUTTER_KEY_PRESS);
+  clutter_event_set_stage (event, stage);
+  clutter_event_set_device (event, device);
+  clutter_event_set_key_symbol (event, CLUTTER_KEY_a);
+  clutter_event_put (event);
+  clutter_event_free (event);
+}
+
+static void
+event_delivery_compression_order (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterBackend *backend = clutter_get_default_backend ();
+  ClutterSeat *seat = clutter_backend_get_default_seat (backend);
+  g_autoptr (GArray) delivered = NULL;
+  DeliveredEvent *event;
+  gulong captured_handler;
+
+  delivered = g_array_new (FALSE, FALSE, sizeof (DeliveredEvent));
+  captured_handler = g_signal_connect (stage, "captured-event",
+                                       G_CALLBACK (on_captured_event),
+                                       delivered);
+
+  clutter_stage_set_throttle_motion_events (CLUTTER_STAGE (stage), TRUE);
+  clutter_actor_show (stage);
+
+  /* The first motion is queued until the next frame, and the key press
+   * and second motion are queued behind it. The first motion must not
+   * be folded into the second one across the key press.
+   */
+  put_motion_event (CLUTTER_STAGE (stage), clutter_seat_get_pointer (seat),
+                    10, 10);
+  put_key_event (CLUTTER_STAGE (stage), clutter_seat_get_keyboard (seat));
+  put_motion_event (CLUTTER_STAGE (stage), clutter_seat_get_pointer (seat),
+                    20, 20);
+
+  /* The last motion is never compressed, so wait for it rather than for a
+   * number of events */
+  while (delivered->len == 0 ||
+         g_array_index (delivered, DeliveredEvent,
+                        delivered->len - 1).x != 20)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_clear_signal_handler (&captured_handler, stage);
+
+  g_assert_cmpuint (delivered->len, ==, 3);
+
+  event = &g_array_index (delivered, DeliveredEvent, 0);
+  g_assert_cmpint (event->type, ==, CLUTTER_MOTION);
+  g_assert_cmpfloat (event->x, ==, 10);
+
+  event = &g_array_index (delivered, DeliveredEvent, 1);
+  g_assert_cmpint (event->type, ==, CLUTTER_KEY_PRESS);
+
+  event = &g_array_index (delivered, DeliveredEvent, 2);
+  g_assert_cmpint (event->type, ==, CLUTTER_MOTION);
+  g_assert_cmpfloat (event->x, ==, 20);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/event/delivery/compression-order",
+                     event_delivery_compression_order)
+)
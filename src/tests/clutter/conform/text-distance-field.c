@@ -0,0 +1,92 @@
+#include <clutter/clutter.h>
+#include <cogl-pango/cogl-pango.h>
+
+#include "cogl-pango/cogl-pango-private.h"
+#include "tests/clutter-test-utils.h"
+
+#define FRAMEBUFFER_SIZE 256
+
+static unsigned int
+get_n_distance_field_glyphs (CoglPangoFontMap *font_map)
+{
+  PangoRenderer *renderer = cogl_pango_font_map_get_renderer (font_map);
+  CoglPangoRenderer *cogl_renderer = COGL_PANGO_RENDERER (renderer);
+
+  return _cogl_pango_renderer_get_n_distance_field_glyphs (cogl_renderer);
+}
+
+static void
+draw_glyph_at_size (ClutterActor    *stage,
+                    CoglFramebuffer *framebuffer,
+                    int              size,
+                    float            scale)
+{
+  g_autoptr (PangoLayout) layout = NULL;
+  PangoFontDescription *desc;
+  CoglColor color;
+
+  layout = clutter_actor_create_pango_layout (stage, "A");
+
+  desc = pango_font_description_from_string ("Sans");
+  pango_font_description_set_absolute_size (desc, size * PANGO_SCALE);
+  pango_layout_set_font_description (layout, desc);
+  pango_font_description_free (desc);
+
+  cogl_color_init_from_4ub (&color, 0x00, 0x00, 0x00, 0xff);
+
+  cogl_framebuffer_push_matrix (framebuffer);
+  cogl_framebuffer_scale (framebuffer, scale, scale, 1.0f);
+  cogl_pango_show_layout (framebuffer, layout, 0, 0, &color);
+  cogl_framebuffer_pop_matrix (framebuffer);
+}
+
+static void
+text_distance_field_sizes (void)
+{
+  CoglPangoFontMap *font_map = COGL_PANGO_FONT_MAP (clutter_get_font_map ());
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  ClutterActor *stage = clutter_test_get_stage ();
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  CoglFramebuffer *framebuffer;
+  CoglTexture *texture;
+  gboolean was_enabled;
+  unsigned int n_glyphs;
+
+  texture = cogl_texture_2d_new_with_size (ctx,
+                                           FRAMEBUFFER_SIZE,
+                                           FRAMEBUFFER_SIZE);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  cogl_object_unref (texture);
+
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0,
+                                 FRAMEBUFFER_SIZE, FRAMEBUFFER_SIZE,
+                                 -1, 100);
+
+  was_enabled = cogl_pango_font_map_get_use_distance_fields (font_map);
+  cogl_pango_font_map_set_use_distance_fields (font_map, TRUE);
+  cogl_pango_font_map_clear_glyph_cache (font_map);
+
+  n_glyphs = get_n_distance_field_glyphs (font_map);
+
+  /* Text drawn at its own size keeps using the bitmaps */
+  draw_glyph_at_size (stage, framebuffer, 32, 1.0f);
+  g_assert_cmpuint (get_n_distance_field_glyphs (font_map), ==, n_glyphs);
+
+  /* Both sizes are above the minimum size for distance fields, so once
+   * they are scaled the glyph is rasterized once and shared by both */
+  draw_glyph_at_size (stage, framebuffer, 32, 2.0f);
+  g_assert_cmpuint (get_n_distance_field_glyphs (font_map), ==, n_glyphs + 1);
+
+  draw_glyph_at_size (stage, framebuffer, 64, 1.5f);
+  g_assert_cmpuint (get_n_distance_field_glyphs (font_map), ==, n_glyphs + 1);
+
+  cogl_pango_font_map_set_use_distance_fields (font_map, was_enabled);
+  cogl_pango_font_map_clear_glyph_cache (font_map);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/text/distance-field/sizes", text_distance_field_sizes)
+)
@@ -547,6 +547,31 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_get_layout_unshared (void)
+{
+  ClutterText *text_a, *text_b;
+  PangoLayout *layout_a, *layout_b;
+
+  text_a = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", "foo"));
+  g_object_ref_sink (text_a);
+  text_b = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", "foo"));
+  g_object_ref_sink (text_b);
+
+  /* Modifying the layout of one actor must not change the text of
+   * another actor showing the same contents
+   */
+  layout_a = clutter_text_get_layout (text_a);
+  pango_layout_set_text (layout_a, "bar", -1);
+
+  layout_b = clutter_text_get_layout (text_b);
+  g_assert (layout_a != layout_b);
+  g_assert_cmpstr (pango_layout_get_text (layout_b), ==, "foo");
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text_a));
+  clutter_actor_destroy (CLUTTER_ACTOR (text_b));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -561,4 +586,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/get-layout-unshared", text_get_layout_unshared)
 )
@@ -0,0 +1,197 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define N_FRAMES 200
+
+static const float sigmas[] = { 2.f, 8.f, 16.f, 32.f, 64.f };
+
+static const struct
+{
+  ClutterBlurMode mode;
+  const char *name;
+} modes[] = {
+  { CLUTTER_BLUR_MODE_GAUSSIAN, "gaussian" },
+  { CLUTTER_BLUR_MODE_DUAL_KAWASE, "dual-kawase" },
+};
+
+#define BENCH_TYPE_BLUR (bench_blur_get_type ())
+G_DECLARE_FINAL_TYPE (BenchBlur, bench_blur, BENCH, BLUR, ClutterActor)
+
+struct _BenchBlur
+{
+  ClutterActor parent;
+
+  ClutterBlurMode mode;
+  float sigma;
+};
+
+G_DEFINE_TYPE (BenchBlur, bench_blur, CLUTTER_TYPE_ACTOR)
+
+static void
+bench_blur_paint_node (ClutterActor     *actor,
+                       ClutterPaintNode *root)
+{
+  BenchBlur *bench_blur = BENCH_BLUR (actor);
+  ClutterPaintNode *blur_node;
+  ClutterActorBox box;
+  float width, height;
+  int i;
+
+  clutter_actor_get_allocation_box (actor, &box);
+  clutter_actor_box_get_size (&box, &width, &height);
+
+  blur_node = clutter_blur_node_new_with_mode (width, height,
+                                               bench_blur->sigma,
+                                               bench_blur->mode);
+  clutter_paint_node_add_rectangle (blur_node,
+                                    &(ClutterActorBox) {
+                                      0.f, 0.f,
+                                      width, height,
+                                    });
+  clutter_paint_node_add_child (root, blur_node);
+
+  /* Draw a checkerboard so there is something to blur */
+  for (i = 0; i < 64; i++)
+    {
+      ClutterPaintNode *color_node;
+      float x = (i % 8) * width / 8;
+      float y = (i / 8) * height / 8;
+
+      color_node = clutter_color_node_new ((i + i / 8) % 2 ?
+                                           CLUTTER_COLOR_White :
+                                           CLUTTER_COLOR_Red);
+      clutter_paint_node_add_rectangle (color_node,
+                                        &(ClutterActorBox) {
+                                          x, y,
+                                          x + width / 8, y + height / 8,
+                                        });
+      clutter_paint_node_add_child (blur_node, color_node);
+      clutter_paint_node_unref (color_node);
+    }
+
+  clutter_paint_node_unref (blur_node);
+}
+
+static void
+bench_blur_class_init (BenchBlurClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint_node = bench_blur_paint_node;
+}
+
+static void
+bench_blur_init (BenchBlur *bench_blur)
+{
+}
+
+typedef struct
+{
+  BenchBlur *bench_blur;
+  unsigned int mode_index;
+  unsigned int sigma_index;
+  int n_frames;
+  int64_t start_time_us;
+} BenchData;
+
+static void
+start_run (BenchData *data)
+{
+  data->bench_blur->mode = modes[data->mode_index].mode;
+  data->bench_blur->sigma = sigmas[data->sigma_index];
+
+  data->n_frames = 0;
+  data->start_time_us = g_get_monotonic_time ();
+}
+
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                BenchData        *data)
+{
+  int64_t elapsed_us;
+
+  /* Account for the GPU work of the blur, not only for queueing it */
+  cogl_framebuffer_finish (clutter_stage_view_get_framebuffer (view));
+
+  if (data->n_frames++ == 0)
+    {
+      /* Don't account for allocating the blur and compiling shaders */
+      data->start_time_us = g_get_monotonic_time ();
+      return;
+    }
+
+  if (data->n_frames <= N_FRAMES)
+    return;
+
+  elapsed_us = g_get_monotonic_time () - data->start_time_us;
+
+  printf ("%-12s sigma %5.1f: %7.3f ms/frame\n",
+          modes[data->mode_index].name,
+          sigmas[data->sigma_index],
+          (elapsed_us / 1000.0) / N_FRAMES);
+
+  if (++data->sigma_index == G_N_ELEMENTS (sigmas))
+    {
+      data->sigma_index = 0;
+
+      if (++data->mode_index == G_N_ELEMENTS (modes))
+        {
+          clutter_test_quit ();
+          return;
+        }
+    }
+
+  start_run (data);
+}
+
+static gboolean
+queue_redraw (gpointer stage)
+{
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  return G_SOURCE_CONTINUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  BenchData data = { 0 };
+  ClutterActor *stage;
+  ClutterActor *actor;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_size (stage, 1024, 768);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Blur");
+
+  printf ("Blur test with %d frames per run\n", N_FRAMES);
+
+  actor = g_object_new (BENCH_TYPE_BLUR, NULL);
+  clutter_actor_add_constraint (actor,
+                                clutter_bind_constraint_new (stage,
+                                                             CLUTTER_BIND_SIZE,
+                                                             0.f));
+  clutter_actor_add_child (stage, actor);
+
+  data.bench_blur = BENCH_BLUR (actor);
+  start_run (&data);
+
+  g_signal_connect (stage, "after-paint", G_CALLBACK (on_after_paint), &data);
+  clutter_threads_add_idle (queue_redraw, stage);
+
+  clutter_actor_show (stage);
+
+  clutter_test_main ();
+
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define TREE_DEPTH 5
+#define N_CHILDREN 4
+#define N_FRAMES 300
+
+#define BENCH_TYPE_LEAF (bench_leaf_get_type ())
+G_DECLARE_FINAL_TYPE (BenchLeaf, bench_leaf, BENCH, LEAF, ClutterActor)
+
+struct _BenchLeaf
+{
+  ClutterActor parent;
+
+  float size;
+};
+
+G_DEFINE_TYPE (BenchLeaf, bench_leaf, CLUTTER_TYPE_ACTOR)
+
+static unsigned int n_size_requests = 0;
+
+static void
+bench_leaf_get_preferred_width (ClutterActor *actor,
+                                float         for_height,
+                                float        *min_width_p,
+                                float        *natural_width_p)
+{
+  BenchLeaf *leaf = BENCH_LEAF (actor);
+
+  n_size_requests++;
+
+  *min_width_p = leaf->size;
+  *natural_width_p = leaf->size * 2;
+}
+
+static void
+bench_leaf_get_preferred_height (ClutterActor *actor,
+                                 float         for_width,
+                                 float        *min_height_p,
+                                 float        *natural_height_p)
+{
+  BenchLeaf *leaf = BENCH_LEAF (actor);
+
+  n_size_requests++;
+
+  *min_height_p = leaf->size;
+  *natural_height_p = leaf->size * 2;
+}
+
+static void
+bench_leaf_class_init (BenchLeafClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->get_preferred_width = bench_leaf_get_preferred_width;
+  actor_class->get_preferred_height = bench_leaf_get_preferred_height;
+}
+
+static void
+bench_leaf_init (BenchLeaf *leaf)
+{
+  leaf->size = 2.f;
+}
+
+static void
+bench_leaf_set_size (BenchLeaf *leaf,
+                     float      size)
+{
+  leaf->size = size;
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (leaf));
+}
+
+typedef struct
+{
+  GPtrArray *leaves;
+  int n_frames;
+  int64_t update_start_us;
+  int64_t total_update_us;
+  unsigned int start_n_size_requests;
+} BenchData;
+
+static ClutterActor *
+create_tree (int        depth,
+             GPtrArray *leaves)
+{
+  ClutterLayoutManager *layout_manager;
+  ClutterActor *container;
+  int i;
+
+  if (depth == 0)
+    {
+      ClutterActor *leaf = g_object_new (BENCH_TYPE_LEAF, NULL);
+
+      g_ptr_array_add (leaves, leaf);
+      return leaf;
+    }
+
+  if (depth % 2 == 0)
+    {
+      layout_manager = clutter_box_layout_new ();
+      clutter_box_layout_set_orientation (CLUTTER_BOX_LAYOUT (layout_manager),
+                                          depth % 4 == 0 ?
+                                          CLUTTER_ORIENTATION_VERTICAL :
+                                          CLUTTER_ORIENTATION_HORIZONTAL);
+    }
+  else
+    {
+      layout_manager = clutter_grid_layout_new ();
+    }
+
+  container = clutter_actor_new ();
+  clutter_actor_set_layout_manager (container, layout_manager);
+
+  for (i = 0; i < N_CHILDREN; i++)
+    {
+      ClutterActor *child = create_tree (depth - 1, leaves);
+
+      if (CLUTTER_IS_GRID_LAYOUT (layout_manager))
+        {
+          clutter_grid_layout_attach (CLUTTER_GRID_LAYOUT (layout_manager),
+                                      child,
+                                      i % 2, i / 2,
+                                      1, 1);
+        }
+      else
+        {
+          clutter_actor_add_child (container, child);
+        }
+    }
+
+  return container;
+}
+
+static void
+on_before_update (ClutterStage     *stage,
+                  ClutterStageView *view,
+                  BenchData        *data)
+{
+  BenchLeaf *leaf;
+
+  /* Resize a single leaf per frame, alternating its size */
+  leaf = g_ptr_array_index (data->leaves,
+                            g_random_int_range (0, data->leaves->len));
+  bench_leaf_set_size (leaf, data->n_frames % 2 ? 2.f : 3.f);
+
+  data->update_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_before_paint (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 BenchData        *data)
+{
+  data->total_update_us += g_get_monotonic_time () - data->update_start_us;
+}
+
+static void
+on_after_paint (ClutterStage        *stage,
+                ClutterPaintContext *paint_context,
+                BenchData           *data)
+{
+  if (data->n_frames++ == 0)
+    {
+      /* Don't account for the initial layout */
+      data->total_update_us = 0;
+      data->start_n_size_requests = n_size_requests;
+      return;
+    }
+
+  if (data->n_frames <= N_FRAMES)
+    return;
+
+  printf ("%u leaves: %.3f ms/frame in layout, %.1f leaf size requests/frame\n",
+          data->leaves->len,
+          (data->total_update_us / 1000.0) / N_FRAMES,
+          (double) (n_size_requests - data->start_n_size_requests) / N_FRAMES);
+
+  clutter_test_quit ();
+}
+
+static gboolean
+queue_redraw (gpointer stage)
+{
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  return G_SOURCE_CONTINUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  BenchData data = { 0 };
+  ClutterActor *stage;
+  ClutterActor *tree;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Layout");
+
+  printf ("Layout test with a tree of depth %d and %d children per node\n",
+          TREE_DEPTH, N_CHILDREN);
+
+  data.leaves = g_ptr_array_new ();
+
+  tree = create_tree (TREE_DEPTH, data.leaves);
+  clutter_actor_add_constraint (tree,
+                                clutter_bind_constraint_new (stage,
+                                                             CLUTTER_BIND_SIZE,
+                                                             0.f));
+  clutter_actor_add_child (stage, tree);
+
+  g_signal_connect (stage, "before-update",
+                    G_CALLBACK (on_before_update), &data);
+  g_signal_connect (stage, "before-paint",
+                    G_CALLBACK (on_before_paint), &data);
+  g_signal_connect (stage, "after-paint",
+                    G_CALLBACK (on_after_paint), &data);
+  clutter_threads_add_idle (queue_redraw, stage);
+
+  clutter_actor_show (stage);
+
+  clutter_test_main ();
+
+  g_ptr_array_free (data.leaves, TRUE);
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#include <math.h>
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define N_ACTORS 2000
+#define N_FRAMES 500
+
+typedef struct
+{
+  ClutterActor *stage;
+  GPtrArray *actors;
+  int n_frames;
+  int64_t update_start_us;
+  int64_t total_update_us;
+} BenchData;
+
+static void
+on_before_update (ClutterStage     *stage,
+                  ClutterStageView *view,
+                  BenchData        *data)
+{
+  unsigned int i;
+
+  /* Moving the actors queues their redraws, which also keeps the frame clock
+   * running, so only the per-actor redraws are collected on each frame. */
+  for (i = 0; i < data->actors->len; i++)
+    {
+      ClutterActor *actor = g_ptr_array_index (data->actors, i);
+      double angle = (2.0 * G_PI * (data->n_frames + i)) / 60.0;
+
+      clutter_actor_set_translation (actor,
+                                     (float) (8.0 * cos (angle)),
+                                     (float) (8.0 * sin (angle)),
+                                     0.f);
+    }
+
+  data->update_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_before_paint (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 BenchData        *data)
+{
+  data->total_update_us += g_get_monotonic_time () - data->update_start_us;
+}
+
+static void
+on_after_paint (ClutterStage        *stage,
+                ClutterPaintContext *paint_context,
+                BenchData           *data)
+{
+  if (++data->n_frames < N_FRAMES)
+    return;
+
+  printf ("%d animated actors: %.3f ms/frame spent collecting redraws\n",
+          N_ACTORS,
+          (data->total_update_us / 1000.0) / N_FRAMES);
+
+  clutter_test_quit ();
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  BenchData data = { 0 };
+  ClutterActor *stage;
+  int i;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Queue redraws");
+
+  printf ("Queue redraw test with %d actors moving on every frame\n",
+          N_ACTORS);
+
+  data.stage = stage;
+  data.actors = g_ptr_array_new ();
+
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      ClutterActor *actor;
+
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor, CLUTTER_COLOR_White);
+      clutter_actor_set_size (actor, 8, 8);
+      clutter_actor_set_position (actor,
+                                  g_random_int_range (8, 496),
+                                  g_random_int_range (8, 496));
+      clutter_actor_add_child (stage, actor);
+      g_ptr_array_add (data.actors, actor);
+    }
+
+  g_signal_connect (stage, "before-update",
+                    G_CALLBACK (on_before_update), &data);
+  g_signal_connect (stage, "before-paint",
+                    G_CALLBACK (on_before_paint), &data);
+  g_signal_connect (stage, "after-paint",
+                    G_CALLBACK (on_after_paint), &data);
+
+  clutter_actor_show (stage);
+
+  clutter_test_main ();
+
+  g_ptr_array_free (data.actors, TRUE);
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include <clutter/clutter-mutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define N_ACTORS 1000
+#define N_FRAMES 300
+
+typedef struct
+{
+  ClutterActor *stage;
+  gboolean retain;
+  int n_frames;
+  int64_t start_time_us;
+  uint64_t start_n_created;
+} BenchData;
+
+static void
+set_retain_paint_nodes (ClutterActor *stage,
+                        gboolean      retain)
+{
+  ClutterActorIter iter;
+  ClutterActor *child;
+
+  clutter_actor_iter_init (&iter, stage);
+  while (clutter_actor_iter_next (&iter, &child))
+    clutter_actor_set_retain_paint_nodes (child, retain);
+}
+
+static void
+start_run (BenchData *data)
+{
+  set_retain_paint_nodes (data->stage, data->retain);
+
+  data->n_frames = 0;
+  data->start_time_us = g_get_monotonic_time ();
+  data->start_n_created = clutter_paint_node_get_n_created ();
+}
+
+static void
+on_after_paint (ClutterActor        *stage,
+                ClutterPaintContext *paint_context,
+                BenchData           *data)
+{
+  int64_t elapsed_us;
+  uint64_t n_created;
+
+  if (++data->n_frames < N_FRAMES)
+    return;
+
+  elapsed_us = g_get_monotonic_time () - data->start_time_us;
+  n_created = clutter_paint_node_get_n_created () - data->start_n_created;
+
+  printf ("%-9s: %8.1f paint nodes created/frame, %7.3f ms/frame\n",
+          data->retain ? "retained" : "rebuilt",
+          (double) n_created / N_FRAMES,
+          (elapsed_us / 1000.0) / N_FRAMES);
+
+  if (data->retain)
+    {
+      clutter_test_quit ();
+      return;
+    }
+
+  data->retain = TRUE;
+  start_run (data);
+}
+
+static gboolean
+queue_redraw (gpointer stage)
+{
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  return G_SOURCE_CONTINUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  BenchData data = { 0 };
+  ClutterActor *stage;
+  int i;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Retained paint nodes");
+
+  printf ("Retained paint node test with %d actors and %d frames per run\n",
+          N_ACTORS, N_FRAMES);
+
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      ClutterColor color;
+      ClutterActor *actor;
+
+      color.red = g_random_int_range (0, 256);
+      color.green = g_random_int_range (0, 256);
+      color.blue = g_random_int_range (0, 256);
+      color.alpha = 0xff;
+
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor, &color);
+      clutter_actor_set_size (actor, 16, 16);
+      clutter_actor_set_position (actor,
+                                  g_random_int_range (0, 496),
+                                  g_random_int_range (0, 496));
+      clutter_actor_add_child (stage, actor);
+    }
+
+  data.stage = stage;
+  data.retain = FALSE;
+  start_run (&data);
+
+  g_signal_connect (stage, "after-paint", G_CALLBACK (on_after_paint), &data);
+  clutter_threads_add_idle (queue_redraw, stage);
+
+  clutter_actor_show (stage);
+
+  clutter_test_main ();
+
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
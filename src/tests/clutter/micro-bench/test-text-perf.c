@@ -12,6 +12,13 @@ static int font_size;
 static int n_chars;
 static int rows, cols;
 
+/* When set, the labels cycle through this many different texts, changing
+ * on every frame, like a panel full of clocks would */
+static int n_texts;
+static char **texts;
+static GPtrArray *labels;
+static int n_updates;
+
 static void
 on_after_paint (ClutterActor        *actor,
                 ClutterPaintContext *paint_context,
@@ -39,9 +46,27 @@ on_after_paint (ClutterActor        *actor,
   ++fps;
 }
 
+static void
+update_labels (void)
+{
+  unsigned int i;
+
+  for (i = 0; i < labels->len; i++)
+    {
+      ClutterText *label = g_ptr_array_index (labels, i);
+
+      clutter_text_set_text (label, texts[(n_updates + i) % n_texts]);
+    }
+
+  n_updates++;
+}
+
 static gboolean
 queue_redraw (gpointer stage)
 {
+  if (n_texts > 0)
+    update_labels ();
+
   clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 
   return G_SOURCE_CONTINUE;
@@ -81,26 +106,35 @@ get_character (int ch)
   return ch + ranges[i].first_letter;
 }
 
+static char *
+create_text (int offset)
+{
+  GString *str;
+  int i;
+
+  str = g_string_new (NULL);
+  for (i = 0; i < n_chars; i++)
+    g_string_append_unichar (str, get_character (offset + i));
+
+  return g_string_free (str, FALSE);
+}
+
 static ClutterActor *
 create_label (void)
 {
   ClutterColor label_color = { 0xff, 0xff, 0xff, 0xff };
   ClutterActor *label;
   char         *font_name;
-  GString      *str;
-  int           i;
+  char         *text;
 
   font_name = g_strdup_printf ("Monospace %dpx", font_size);
+  text = create_text (0);
 
-  str = g_string_new (NULL);
-  for (i = 0; i < n_chars; i++)
-    g_string_append_unichar (str, get_character (i));
-
-  label = clutter_text_new_with_text (font_name, str->str);
+  label = clutter_text_new_with_text (font_name, text);
   clutter_text_set_color (CLUTTER_TEXT (label), &label_color);
 
   g_free (font_name);
-  g_string_free (str, TRUE);
+  g_free (text);
 
   return label;
 }
@@ -119,17 +153,31 @@ main (int argc, char *argv[])
 
   clutter_test_init (&argc, &argv);
 
-  if (argc != 3)
+  if (argc != 3 && argc != 4)
     {
-      g_printerr ("Usage test-text-perf FONT_SIZE N_CHARS\n");
+      g_printerr ("Usage test-text-perf FONT_SIZE N_CHARS [N_TEXTS]\n");
       exit (1);
     }
 
   font_size = atoi (argv[1]);
   n_chars = atoi (argv[2]);
+  n_texts = argc == 4 ? atoi (argv[3]) : 0;
 
   g_print ("Monospace %dpx, string length = %d\n", font_size, n_chars);
 
+  if (n_texts > 0)
+    {
+      int i;
+
+      g_print ("Cycling through %d texts\n", n_texts);
+
+      texts = g_new0 (char *, n_texts + 1);
+      for (i = 0; i < n_texts; i++)
+        texts[i] = create_text (i);
+    }
+
+  labels = g_ptr_array_new ();
+
   stage = clutter_test_get_stage ();
   clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
   clutter_actor_set_background_color (CLUTTER_ACTOR (stage), CLUTTER_COLOR_Black);
@@ -178,6 +226,7 @@ main (int argc, char *argv[])
         clutter_actor_set_scale (label, scale, scale);
 	clutter_actor_set_position (label, w * col * scale, h * row * scale);
 	clutter_container_add_actor (CLUTTER_CONTAINER (stage), label);
+        g_ptr_array_add (labels, label);
       }
 
   clutter_actor_show (stage);
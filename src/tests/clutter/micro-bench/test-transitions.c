@@ -0,0 +1,175 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define N_ACTORS 1000
+#define N_FRAMES 500
+
+typedef struct
+{
+  int n_frames;
+  int64_t advance_start_us;
+  int64_t total_advance_us;
+  int n_notifications;
+} BenchData;
+
+static void
+on_marker_new_frame (ClutterTimeline *timeline,
+                     int              msecs,
+                     BenchData       *data)
+{
+  data->advance_start_us = g_get_monotonic_time ();
+}
+
+static void
+on_before_update (ClutterStage     *stage,
+                  ClutterStageView *view,
+                  BenchData        *data)
+{
+  if (data->advance_start_us == 0)
+    return;
+
+  data->total_advance_us += g_get_monotonic_time () - data->advance_start_us;
+  data->advance_start_us = 0;
+
+  if (++data->n_frames < N_FRAMES)
+    return;
+
+  printf ("%d actors with 5 transitions each: "
+          "%.3f ms/frame advancing transitions, "
+          "%.1f notifications/frame\n",
+          N_ACTORS,
+          (data->total_advance_us / 1000.0) / N_FRAMES,
+          (double) data->n_notifications / N_FRAMES);
+
+  clutter_test_quit ();
+}
+
+static void
+on_notify (GObject    *gobject,
+           GParamSpec *pspec,
+           BenchData  *data)
+{
+  data->n_notifications++;
+}
+
+static void
+add_transition (ClutterActor      *actor,
+                const char        *property_name,
+                ClutterTransition *transition)
+{
+  ClutterTimeline *timeline = CLUTTER_TIMELINE (transition);
+
+  clutter_timeline_set_duration (timeline, 1000);
+  clutter_timeline_set_repeat_count (timeline, -1);
+  clutter_timeline_set_auto_reverse (timeline, TRUE);
+  clutter_actor_add_transition (actor, property_name, transition);
+  g_object_unref (transition);
+}
+
+static void
+add_transitions (ClutterActor *actor)
+{
+  graphene_point_t position_from, position_to;
+  graphene_size_t size_from, size_to;
+  ClutterTransition *transition;
+
+  transition = clutter_property_transition_new ("translation-x");
+  clutter_transition_set_from (transition, G_TYPE_FLOAT, 0.0f);
+  clutter_transition_set_to (transition, G_TYPE_FLOAT, 16.0f);
+  add_transition (actor, "translation-x", transition);
+
+  transition = clutter_property_transition_new ("scale-x");
+  clutter_transition_set_from (transition, G_TYPE_DOUBLE, 1.0);
+  clutter_transition_set_to (transition, G_TYPE_DOUBLE, 2.0);
+  add_transition (actor, "scale-x", transition);
+
+  graphene_point_init (&position_from,
+                       clutter_actor_get_x (actor),
+                       clutter_actor_get_y (actor));
+  graphene_point_init (&position_to,
+                       position_from.x + 8,
+                       position_from.y + 8);
+  transition = clutter_property_transition_new ("position");
+  clutter_transition_set_from (transition, GRAPHENE_TYPE_POINT, &position_from);
+  clutter_transition_set_to (transition, GRAPHENE_TYPE_POINT, &position_to);
+  add_transition (actor, "position", transition);
+
+  graphene_size_init (&size_from, 8, 8);
+  graphene_size_init (&size_to, 16, 16);
+  transition = clutter_property_transition_new ("size");
+  clutter_transition_set_from (transition, GRAPHENE_TYPE_SIZE, &size_from);
+  clutter_transition_set_to (transition, GRAPHENE_TYPE_SIZE, &size_to);
+  add_transition (actor, "size", transition);
+
+  transition = clutter_property_transition_new ("background-color");
+  clutter_transition_set_from (transition, CLUTTER_TYPE_COLOR,
+                               CLUTTER_COLOR_White);
+  clutter_transition_set_to (transition, CLUTTER_TYPE_COLOR,
+                             CLUTTER_COLOR_Red);
+  add_transition (actor, "background-color", transition);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  BenchData data = { 0 };
+  ClutterTimeline *marker;
+  ClutterActor *stage;
+  int i;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Transitions");
+
+  printf ("Transition test with %d actors animating on every frame\n",
+          N_ACTORS);
+
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      ClutterActor *actor;
+
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor, CLUTTER_COLOR_White);
+      clutter_actor_set_size (actor, 8, 8);
+      clutter_actor_set_position (actor,
+                                  g_random_int_range (8, 480),
+                                  g_random_int_range (8, 480));
+      clutter_actor_add_child (stage, actor);
+
+      g_signal_connect (actor, "notify", G_CALLBACK (on_notify), &data);
+    }
+
+  clutter_actor_show (stage);
+
+  for (i = 0; i < N_ACTORS; i++)
+    add_transitions (clutter_actor_get_child_at_index (stage, i));
+
+  /* The frame clock advances the most recently started timeline first, so
+   * this one marks the start of the transitions of each frame. The stage
+   * emits ::before-update once all of them have been advanced and their
+   * notifications emitted.
+   */
+  marker = clutter_timeline_new_for_actor (stage, 1000);
+  clutter_timeline_set_repeat_count (marker, -1);
+  g_signal_connect (marker, "new-frame",
+                    G_CALLBACK (on_marker_new_frame), &data);
+  g_signal_connect (stage, "before-update",
+                    G_CALLBACK (on_before_update), &data);
+  clutter_timeline_start (marker);
+
+  clutter_test_main ();
+
+  g_object_unref (marker);
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
@@ -37,6 +37,7 @@
 #include "tests/meta-test-utils.h"
 #include "tests/unit-tests.h"
 #include "tests/orientation-manager-unit-tests.h"
+#include "wayland/meta-wayland-private.h"
 #include "x11/meta-x11-display-private.h"
 
 static MonitorTestCase initial_test_case = {
@@ -3344,6 +3345,105 @@ meta_test_monitor_non_upright_panel (void)
   check_monitor_test_clients_state ();
 }
 
+typedef struct _OutputEventCounts
+{
+  int n_events;
+  GHashTable *wayland_outputs;
+  GHashTable *done_events;
+} OutputEventCounts;
+
+static void
+on_output_protocol_event (void                                    *user_data,
+                          enum wl_protocol_logger_type             type,
+                          const struct wl_protocol_logger_message *message)
+{
+  OutputEventCounts *counts = user_data;
+  const char *interface_name;
+  gpointer wayland_output;
+
+  if (type != WL_PROTOCOL_LOGGER_EVENT)
+    return;
+
+  interface_name = wl_resource_get_class (message->resource);
+  if (!g_str_equal (interface_name, wl_output_interface.name) &&
+      !g_str_equal (interface_name, "zxdg_output_v1"))
+    return;
+
+  counts->n_events++;
+
+  wayland_output = wl_resource_get_user_data (message->resource);
+  g_hash_table_add (counts->wayland_outputs, wayland_output);
+
+  if (g_str_equal (message->message->name, "done"))
+    {
+      int n_done_events;
+
+      n_done_events = GPOINTER_TO_INT (g_hash_table_lookup (counts->done_events,
+                                                            message->resource));
+      g_hash_table_insert (counts->done_events,
+                           message->resource,
+                           GINT_TO_POINTER (n_done_events + 1));
+    }
+}
+
+static void
+meta_test_monitor_wayland_output_events (void)
+{
+  MetaWaylandCompositor *compositor = meta_wayland_compositor_get_default ();
+  MonitorTestCase test_case = initial_test_case;
+  MetaMonitorTestSetup *test_setup;
+  struct wl_protocol_logger *logger;
+  OutputEventCounts counts = { 0 };
+  GHashTableIter iter;
+  gpointer n_done_events;
+
+  test_setup = create_monitor_test_setup (&test_case.setup,
+                                          MONITOR_TEST_FLAG_NO_STORED);
+  emulate_hotplug (test_setup);
+  check_monitor_test_clients_state ();
+
+  counts.wayland_outputs = g_hash_table_new (NULL, NULL);
+  counts.done_events = g_hash_table_new (NULL, NULL);
+  logger = wl_display_add_protocol_logger (compositor->wayland_display,
+                                           on_output_protocol_event,
+                                           &counts);
+
+  /* Reapplying an identical configuration must not send anything. */
+  test_setup = create_monitor_test_setup (&test_case.setup,
+                                          MONITOR_TEST_FLAG_NO_STORED);
+  emulate_hotplug (test_setup);
+  META_TEST_LOG_CALL ("Checking monitor configuration",
+                      check_monitor_configuration (&test_case.expect));
+  g_assert_cmpint (counts.n_events, ==, 0);
+
+  /* Changing one monitor must only send events for that monitor, with a
+   * single "done" event per resource.
+   */
+  test_case.setup.outputs[1].width_mm = 300;
+  test_case.setup.outputs[1].height_mm = 170;
+  test_case.expect.monitors[1].width_mm = 300;
+  test_case.expect.monitors[1].height_mm = 170;
+  test_setup = create_monitor_test_setup (&test_case.setup,
+                                          MONITOR_TEST_FLAG_NO_STORED);
+  emulate_hotplug (test_setup);
+  META_TEST_LOG_CALL ("Checking monitor configuration",
+                      check_monitor_configuration (&test_case.expect));
+
+  g_assert_cmpint (counts.n_events, >, 0);
+  g_assert_cmpuint (g_hash_table_size (counts.wayland_outputs), ==, 1);
+  g_assert_cmpuint (g_hash_table_size (counts.done_events), >, 0);
+
+  g_hash_table_iter_init (&iter, counts.done_events);
+  while (g_hash_table_iter_next (&iter, NULL, &n_done_events))
+    g_assert_cmpint (GPOINTER_TO_INT (n_done_events), ==, 1);
+
+  wl_protocol_logger_destroy (logger);
+  g_hash_table_unref (counts.wayland_outputs);
+  g_hash_table_unref (counts.done_events);
+
+  check_monitor_test_clients_state ();
+}
+
 static void
 meta_test_monitor_switch_external_without_external (void)
 {
@@ -8595,6 +8695,8 @@ init_monitor_tests (void)
                     meta_test_monitor_non_upright_panel);
   add_monitor_test ("/backends/monitor/switch-external-without-external",
                     meta_test_monitor_switch_external_without_external);
+  add_monitor_test ("/backends/monitor/wayland-output-events",
+                    meta_test_monitor_wayland_output_events);
 
   add_monitor_test ("/backends/monitor/orientation/is-managed",
                     meta_test_monitor_orientation_is_managed);
@@ -0,0 +1,194 @@
+#include "config.h"
+
+#include "tests/selection-tests.h"
+
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <glib-unix.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "meta/display.h"
+#include "meta/meta-selection.h"
+#include "meta/meta-selection-source.h"
+#include "meta/util.h"
+
+#define TEST_MIMETYPE "text/plain"
+#define TEST_CONTENT "selection contents"
+
+#define META_TYPE_TEST_SELECTION_SOURCE (meta_test_selection_source_get_type ())
+G_DECLARE_FINAL_TYPE (MetaTestSelectionSource,
+                      meta_test_selection_source,
+                      META, TEST_SELECTION_SOURCE,
+                      MetaSelectionSource)
+
+struct _MetaTestSelectionSource
+{
+  MetaSelectionSource parent_instance;
+  int fd;
+};
+
+G_DEFINE_TYPE (MetaTestSelectionSource,
+               meta_test_selection_source,
+               META_TYPE_SELECTION_SOURCE)
+
+static void
+meta_test_selection_source_read_async (MetaSelectionSource *source,
+                                       const char          *mimetype,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  MetaTestSelectionSource *test_source = META_TEST_SELECTION_SOURCE (source);
+  g_autoptr (GTask) task = NULL;
+
+  task = g_task_new (source, cancellable, callback, user_data);
+  g_task_set_source_tag (task, meta_test_selection_source_read_async);
+
+  g_assert_cmpint (test_source->fd, >=, 0);
+  g_task_return_pointer (task,
+                         g_unix_input_stream_new (test_source->fd, TRUE),
+                         g_object_unref);
+  test_source->fd = -1;
+}
+
+static GInputStream *
+meta_test_selection_source_read_finish (MetaSelectionSource  *source,
+                                        GAsyncResult         *result,
+                                        GError              **error)
+{
+  g_assert (g_task_get_source_tag (G_TASK (result)) ==
+            meta_test_selection_source_read_async);
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GList *
+meta_test_selection_source_get_mimetypes (MetaSelectionSource *source)
+{
+  return g_list_prepend (NULL, g_strdup (TEST_MIMETYPE));
+}
+
+static void
+meta_test_selection_source_class_init (MetaTestSelectionSourceClass *klass)
+{
+  MetaSelectionSourceClass *source_class = META_SELECTION_SOURCE_CLASS (klass);
+
+  source_class->read_async = meta_test_selection_source_read_async;
+  source_class->read_finish = meta_test_selection_source_read_finish;
+  source_class->get_mimetypes = meta_test_selection_source_get_mimetypes;
+}
+
+static void
+meta_test_selection_source_init (MetaTestSelectionSource *source)
+{
+  source->fd = -1;
+}
+
+typedef struct _TransferData
+{
+  gboolean done;
+  GError *error;
+} TransferData;
+
+static void
+transfer_cb (MetaSelection *selection,
+             GAsyncResult  *result,
+             TransferData  *data)
+{
+  meta_selection_transfer_finish (selection, result, &data->error);
+  data->done = TRUE;
+}
+
+static gboolean
+is_readable (int fd)
+{
+  struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+  return poll (&pfd, 1, 0) > 0;
+}
+
+static void
+test_transfer_cancel (gconstpointer user_data)
+{
+  gboolean destination_is_pipe = GPOINTER_TO_INT (user_data);
+  MetaSelection *selection;
+  MetaTestSelectionSource *source;
+  g_autoptr (GOutputStream) output = NULL;
+  g_autoptr (GCancellable) cancellable = NULL;
+  TransferData data = { 0 };
+  int source_fds[2];
+  int destination_fds[2];
+  char buffer[64];
+  struct pollfd pfd;
+  ssize_t n_read;
+
+  g_assert_true (g_unix_open_pipe (source_fds, FD_CLOEXEC, NULL));
+  if (destination_is_pipe)
+    g_assert_true (g_unix_open_pipe (destination_fds, FD_CLOEXEC, NULL));
+  else
+    g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0,
+                                 destination_fds), ==, 0);
+
+  selection = meta_selection_new (meta_get_display ());
+  source = g_object_new (META_TYPE_TEST_SELECTION_SOURCE, NULL);
+  source->fd = source_fds[0];
+  meta_selection_set_owner (selection, META_SELECTION_CLIPBOARD,
+                            META_SELECTION_SOURCE (source));
+
+  /* Keep a reference on the destination, like the Wayland data offer does,
+   * so that only an explicit close makes the reader see EOF. */
+  output = g_unix_output_stream_new (destination_fds[1], TRUE);
+  cancellable = g_cancellable_new ();
+  meta_selection_transfer_async (selection, META_SELECTION_CLIPBOARD,
+                                 TEST_MIMETYPE, -1,
+                                 output, cancellable,
+                                 (GAsyncReadyCallback) transfer_cb,
+                                 &data);
+
+  g_assert_cmpint (write (source_fds[1], TEST_CONTENT, strlen (TEST_CONTENT)),
+                   ==, strlen (TEST_CONTENT));
+
+  while (!is_readable (destination_fds[0]))
+    g_main_context_iteration (NULL, TRUE);
+
+  n_read = read (destination_fds[0], buffer, sizeof (buffer));
+  g_assert_cmpint (n_read, ==, strlen (TEST_CONTENT));
+  g_assert_cmpmem (buffer, n_read, TEST_CONTENT, strlen (TEST_CONTENT));
+
+  /* The source is still open, so the transfer is waiting for more data */
+  g_assert_false (data.done);
+  g_cancellable_cancel (cancellable);
+
+  while (!data.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_error (data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&data.error);
+
+  /* Both ends of the transfer must have been closed */
+  g_assert_true (g_output_stream_is_closed (output));
+  n_read = read (destination_fds[0], buffer, sizeof (buffer));
+  g_assert_cmpint (n_read, ==, 0);
+
+  pfd = (struct pollfd) { .fd = source_fds[1], .events = POLLOUT };
+  g_assert_cmpint (poll (&pfd, 1, 0), ==, 1);
+  g_assert_true (pfd.revents & POLLERR);
+
+  close (source_fds[1]);
+  close (destination_fds[0]);
+  g_object_unref (source);
+  g_object_unref (selection);
+}
+
+void
+init_selection_tests (void)
+{
+  g_test_add_data_func ("/core/selection/transfer-cancel/pipe",
+                        GINT_TO_POINTER (TRUE),
+                        test_transfer_cancel);
+  g_test_add_data_func ("/core/selection/transfer-cancel/socket",
+                        GINT_TO_POINTER (FALSE),
+                        test_transfer_cancel);
+}
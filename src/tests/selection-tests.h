@@ -0,0 +1,6 @@
+#ifndef SELECTION_TESTS_H
+#define SELECTION_TESTS_H
+
+void init_selection_tests (void);
+
+#endif /* SELECTION_TESTS_H */
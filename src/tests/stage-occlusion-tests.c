@@ -0,0 +1,173 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-virtual-monitor.h"
+#include "backends/native/meta-renderer-native.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-ref-test.h"
+
+static MetaVirtualMonitor *virtual_monitor;
+
+static void
+setup_test_environment (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  g_autoptr (MetaVirtualMonitorInfo) monitor_info = NULL;
+  GError *error = NULL;
+  GList *views;
+
+  meta_settings_override_experimental_features (settings);
+  meta_settings_enable_experimental_feature (
+    settings,
+    META_EXPERIMENTAL_FEATURE_SCALE_MONITOR_FRAMEBUFFER);
+
+  monitor_info = meta_virtual_monitor_info_new (100, 100, 60.0,
+                                                "MetaTestVendor",
+                                                "MetaVirtualMonitor",
+                                                "0x1234");
+  virtual_monitor = meta_monitor_manager_create_virtual_monitor (monitor_manager,
+                                                                 monitor_info,
+                                                                 &error);
+  if (!virtual_monitor)
+    g_error ("Failed to create virtual monitor: %s", error->message);
+
+  meta_monitor_manager_reload (monitor_manager);
+
+  views = meta_renderer_get_views (renderer);
+  g_assert_cmpint (g_list_length (views), ==, 1);
+}
+
+static void
+tear_down_test_environment (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+
+  g_object_unref (virtual_monitor);
+  meta_monitor_manager_reload (monitor_manager);
+}
+
+static ClutterStageView *
+get_view (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+
+  return CLUTTER_STAGE_VIEW (meta_renderer_get_views (renderer)->data);
+}
+
+static ClutterActor *
+create_actor (ClutterActor       *stage,
+              float               x,
+              float               y,
+              float               size,
+              const ClutterColor *color)
+{
+  ClutterActor *actor;
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_position (actor, x, y);
+  clutter_actor_set_size (actor, size, size);
+  clutter_actor_set_background_color (actor, color);
+  clutter_actor_add_child (stage, actor);
+
+  return actor;
+}
+
+static void
+meta_test_stage_occlusion_culling (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  ClutterActor *partially_covered;
+  ClutterActor *covered;
+  ClutterActor *occluder;
+  cairo_region_t *opaque_region;
+
+  partially_covered = create_actor (stage, 0, 0, 30, CLUTTER_COLOR_Green);
+  covered = create_actor (stage, 20, 20, 60, CLUTTER_COLOR_Red);
+  occluder = create_actor (stage, 10, 10, 80, CLUTTER_COLOR_Blue);
+
+  opaque_region = clutter_actor_get_opaque_region (occluder);
+  g_assert_nonnull (opaque_region);
+  g_assert_cmpint (cairo_region_contains_rectangle (opaque_region,
+                                                    &(cairo_rectangle_int_t) {
+                                                      .width = 80,
+                                                      .height = 80,
+                                                    }),
+                   ==,
+                   CAIRO_REGION_OVERLAP_IN);
+  cairo_region_destroy (opaque_region);
+
+  /* The red actor is fully hidden, the green one only partially */
+  meta_ref_test_verify_view (get_view (),
+                             g_test_get_path (), 0,
+                             meta_ref_test_determine_ref_test_flag ());
+
+  /* Scaled occluders still occlude, but less */
+  clutter_actor_set_pivot_point (occluder, 0.5, 0.5);
+  clutter_actor_set_scale (occluder, 0.5, 0.5);
+
+  meta_ref_test_verify_view (get_view (),
+                             g_test_get_path (), 1,
+                             meta_ref_test_determine_ref_test_flag ());
+
+  /* Transparent actors don't occlude anything */
+  clutter_actor_set_scale (occluder, 1.0, 1.0);
+  clutter_actor_set_opacity (occluder, 0);
+
+  meta_ref_test_verify_view (get_view (),
+                             g_test_get_path (), 2,
+                             meta_ref_test_determine_ref_test_flag ());
+
+  clutter_actor_destroy (occluder);
+  clutter_actor_destroy (covered);
+  clutter_actor_destroy (partially_covered);
+}
+
+static void
+init_stage_occlusion_tests (void)
+{
+  g_test_add_func ("/stage/occlusion/culling",
+                   meta_test_stage_occlusion_culling);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert (meta_context_configure (context, &argc, &argv, NULL));
+
+  init_stage_occlusion_tests ();
+
+  g_signal_connect (context, "before-tests",
+                    G_CALLBACK (setup_test_environment), NULL);
+  g_signal_connect (context, "after-tests",
+                    G_CALLBACK (tear_down_test_environment), NULL);
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context));
+}
@@ -37,6 +37,7 @@
 #include "tests/monitor-transform-tests.h"
 #include "tests/meta-test-utils.h"
 #include "tests/orientation-manager-unit-tests.h"
+#include "tests/selection-tests.h"
 
 MetaContext *test_context;
 
@@ -233,6 +234,7 @@ init_tests (void)
   init_boxes_tests ();
   init_monitor_transform_tests ();
   init_orientation_manager_tests ();
+  init_selection_tests ();
 }
 
 int
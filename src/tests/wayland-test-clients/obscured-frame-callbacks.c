@@ -0,0 +1,354 @@
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <wayland-client.h>
+
+#include "wayland-test-client-utils.h"
+
+#include "test-driver-client-protocol.h"
+#include "xdg-shell-client-protocol.h"
+
+/* Must match OBSCURED_FRAME_CALLBACK_INTERVAL_MS in meta-wayland.c */
+#define EXPECTED_INTERVAL_US (G_USEC_PER_SEC)
+#define N_SKIPPED_FRAMES 2
+#define N_OBSCURED_FRAMES 5
+
+typedef enum _State
+{
+  STATE_INIT = 0,
+  STATE_WAIT_FOR_CONFIGURE_BELOW,
+  STATE_WAIT_FOR_FRAME_BELOW,
+  STATE_WAIT_FOR_CONFIGURE_ABOVE,
+  STATE_WAIT_FOR_FRAME_ABOVE,
+  STATE_WAIT_FOR_OBSCURED_FRAMES,
+} State;
+
+typedef struct _Window
+{
+  struct wl_surface *surface;
+  struct xdg_surface *xdg_surface;
+  struct xdg_toplevel *xdg_toplevel;
+  int width;
+  int height;
+} Window;
+
+static struct wl_display *display;
+static struct wl_registry *registry;
+static struct wl_compositor *compositor;
+static struct xdg_wm_base *xdg_wm_base;
+static struct wl_shm *shm;
+static struct test_driver *test_driver;
+
+static Window below;
+static Window above;
+
+static State state;
+static int n_obscured_frames;
+static int64_t last_obscured_frame_us;
+
+static void
+handle_buffer_release (void             *data,
+                       struct wl_buffer *buffer)
+{
+  wl_buffer_destroy (buffer);
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+  handle_buffer_release
+};
+
+static void
+draw (Window   *window,
+      uint32_t  color)
+{
+  struct wl_shm_pool *pool;
+  struct wl_buffer *buffer;
+  struct wl_region *opaque_region;
+  uint32_t *pixels;
+  int fd, size, stride;
+  int i;
+
+  stride = window->width * 4;
+  size = stride * window->height;
+
+  fd = create_anonymous_file (size);
+  if (fd < 0)
+    g_error ("Creating a buffer file for %d B failed: %m", size);
+
+  pixels = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (pixels == MAP_FAILED)
+    g_error ("mmap failed: %m");
+
+  for (i = 0; i < window->width * window->height; i++)
+    pixels[i] = color;
+  munmap (pixels, size);
+
+  pool = wl_shm_create_pool (shm, fd, size);
+  buffer = wl_shm_pool_create_buffer (pool, 0,
+                                      window->width, window->height,
+                                      stride,
+                                      WL_SHM_FORMAT_XRGB8888);
+  wl_buffer_add_listener (buffer, &buffer_listener, NULL);
+  wl_shm_pool_destroy (pool);
+  close (fd);
+
+  opaque_region = wl_compositor_create_region (compositor);
+  wl_region_add (opaque_region, 0, 0, window->width, window->height);
+  wl_surface_set_opaque_region (window->surface, opaque_region);
+  wl_region_destroy (opaque_region);
+
+  wl_surface_attach (window->surface, buffer, 0, 0);
+}
+
+static void handle_frame_callback (void               *data,
+                                   struct wl_callback *callback,
+                                   uint32_t            time);
+
+static const struct wl_callback_listener frame_listener = {
+  handle_frame_callback,
+};
+
+static void
+request_frame (Window *window)
+{
+  struct wl_callback *callback;
+
+  callback = wl_surface_frame (window->surface);
+  wl_callback_add_listener (callback, &frame_listener, window);
+}
+
+static void
+handle_xdg_toplevel_configure (void                *data,
+                               struct xdg_toplevel *xdg_toplevel,
+                               int32_t              width,
+                               int32_t              height,
+                               struct wl_array     *states)
+{
+  Window *window = data;
+
+  if (width > 0 && height > 0)
+    {
+      window->width = width;
+      window->height = height;
+    }
+}
+
+static void
+handle_xdg_toplevel_close (void                *data,
+                           struct xdg_toplevel *xdg_toplevel)
+{
+  g_assert_not_reached ();
+}
+
+static const struct xdg_toplevel_listener xdg_toplevel_listener = {
+  handle_xdg_toplevel_configure,
+  handle_xdg_toplevel_close,
+};
+
+static void
+handle_xdg_surface_configure (void               *data,
+                              struct xdg_surface *xdg_surface,
+                              uint32_t            serial)
+{
+  Window *window = data;
+
+  xdg_surface_ack_configure (xdg_surface, serial);
+
+  if (window == &below && state == STATE_WAIT_FOR_CONFIGURE_BELOW)
+    {
+      draw (window, 0xff00ff00);
+      state = STATE_WAIT_FOR_FRAME_BELOW;
+    }
+  else if (window == &above && state == STATE_WAIT_FOR_CONFIGURE_ABOVE &&
+           window->width > 0 && window->height > 0)
+    {
+      draw (window, 0xff0000ff);
+      state = STATE_WAIT_FOR_FRAME_ABOVE;
+    }
+  else
+    {
+      wl_surface_commit (window->surface);
+      return;
+    }
+
+  request_frame (window);
+  wl_surface_commit (window->surface);
+}
+
+static const struct xdg_surface_listener xdg_surface_listener = {
+  handle_xdg_surface_configure,
+};
+
+static void
+create_window (Window     *window,
+               const char *title)
+{
+  window->surface = wl_compositor_create_surface (compositor);
+  window->xdg_surface = xdg_wm_base_get_xdg_surface (xdg_wm_base,
+                                                     window->surface);
+  xdg_surface_add_listener (window->xdg_surface,
+                            &xdg_surface_listener, window);
+  window->xdg_toplevel = xdg_surface_get_toplevel (window->xdg_surface);
+  xdg_toplevel_add_listener (window->xdg_toplevel,
+                             &xdg_toplevel_listener, window);
+  xdg_toplevel_set_title (window->xdg_toplevel, title);
+}
+
+static void
+handle_frame_callback (void               *data,
+                       struct wl_callback *callback,
+                       uint32_t            time)
+{
+  Window *window = data;
+  int64_t now_us;
+
+  wl_callback_destroy (callback);
+
+  switch (state)
+    {
+    case STATE_WAIT_FOR_FRAME_BELOW:
+      g_assert (window == &below);
+
+      /* Cover the first window completely with an opaque fullscreen one */
+      create_window (&above, "obscured-frame-callbacks-above");
+      xdg_toplevel_set_fullscreen (above.xdg_toplevel, NULL);
+      wl_surface_commit (above.surface);
+      state = STATE_WAIT_FOR_CONFIGURE_ABOVE;
+      break;
+    case STATE_WAIT_FOR_FRAME_ABOVE:
+      g_assert (window == &above);
+
+      state = STATE_WAIT_FOR_OBSCURED_FRAMES;
+      request_frame (&below);
+      wl_surface_commit (below.surface);
+      break;
+    case STATE_WAIT_FOR_OBSCURED_FRAMES:
+      g_assert (window == &below);
+
+      /* The first callbacks may still be emitted while the fullscreen
+       * window is being mapped, so only check the interval between the
+       * later, throttled ones. */
+      now_us = g_get_monotonic_time ();
+      if (n_obscured_frames >= N_SKIPPED_FRAMES)
+        {
+          int64_t interval_us = now_us - last_obscured_frame_us;
+
+          g_assert_cmpint (interval_us, >, EXPECTED_INTERVAL_US * 8 / 10);
+          g_assert_cmpint (interval_us, <, EXPECTED_INTERVAL_US * 16 / 10);
+        }
+      last_obscured_frame_us = now_us;
+
+      if (++n_obscured_frames == N_OBSCURED_FRAMES)
+        {
+          test_driver_sync_point (test_driver, 0);
+          wl_display_roundtrip (display);
+          exit (EXIT_SUCCESS);
+        }
+
+      request_frame (&below);
+      wl_surface_commit (below.surface);
+      break;
+    case STATE_INIT:
+    case STATE_WAIT_FOR_CONFIGURE_BELOW:
+    case STATE_WAIT_FOR_CONFIGURE_ABOVE:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+handle_xdg_wm_base_ping (void               *data,
+                         struct xdg_wm_base *xdg_wm_base,
+                         uint32_t            serial)
+{
+  xdg_wm_base_pong (xdg_wm_base, serial);
+}
+
+static const struct xdg_wm_base_listener xdg_wm_base_listener = {
+  handle_xdg_wm_base_ping,
+};
+
+static void
+handle_registry_global (void               *data,
+                        struct wl_registry *registry,
+                        uint32_t            id,
+                        const char         *interface,
+                        uint32_t            version)
+{
+  if (strcmp (interface, "wl_compositor") == 0)
+    {
+      compositor = wl_registry_bind (registry, id, &wl_compositor_interface, 1);
+    }
+  else if (strcmp (interface, "xdg_wm_base") == 0)
+    {
+      xdg_wm_base = wl_registry_bind (registry, id,
+                                      &xdg_wm_base_interface, 1);
+      xdg_wm_base_add_listener (xdg_wm_base, &xdg_wm_base_listener, NULL);
+    }
+  else if (strcmp (interface, "wl_shm") == 0)
+    {
+      shm = wl_registry_bind (registry,
+                              id, &wl_shm_interface, 1);
+    }
+  else if (strcmp (interface, "test_driver") == 0)
+    {
+      test_driver = wl_registry_bind (registry, id, &test_driver_interface, 1);
+    }
+}
+
+static void
+handle_registry_global_remove (void               *data,
+                               struct wl_registry *registry,
+                               uint32_t            name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+  handle_registry_global,
+  handle_registry_global_remove
+};
+
+int
+main (int    argc,
+      char **argv)
+{
+  display = wl_display_connect (NULL);
+  registry = wl_display_get_registry (display);
+  wl_registry_add_listener (registry, &registry_listener, NULL);
+  wl_display_roundtrip (display);
+
+  if (!shm)
+    {
+      fprintf (stderr, "No wl_shm global\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!xdg_wm_base)
+    {
+      fprintf (stderr, "No xdg_wm_base global\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!test_driver)
+    {
+      fprintf (stderr, "No test_driver global\n");
+      return EXIT_FAILURE;
+    }
+
+  below.width = 100;
+  below.height = 100;
+  create_window (&below, "obscured-frame-callbacks-below");
+  wl_surface_commit (below.surface);
+  state = STATE_WAIT_FOR_CONFIGURE_BELOW;
+
+  while (TRUE)
+    {
+      if (wl_display_dispatch (display) == -1)
+        return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
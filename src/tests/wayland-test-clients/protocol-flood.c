@@ -0,0 +1,163 @@
+#include "config.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wayland-client.h>
+
+#include "test-driver-client-protocol.h"
+
+#define FLOOD_DURATION_US (G_USEC_PER_SEC * 2)
+/* Small enough for the requests of a batch to fit into the client side
+ * connection buffer, which is fatal to overflow. */
+#define COMMITS_PER_BATCH 16
+
+static struct wl_display *display;
+static struct wl_registry *registry;
+static struct wl_compositor *compositor;
+static struct test_driver *test_driver;
+
+static struct wl_surface *surface;
+
+static void
+handle_registry_global (void               *data,
+                        struct wl_registry *registry,
+                        uint32_t            id,
+                        const char         *interface,
+                        uint32_t            version)
+{
+  if (strcmp (interface, "wl_compositor") == 0)
+    {
+      compositor = wl_registry_bind (registry, id, &wl_compositor_interface, 1);
+    }
+  else if (strcmp (interface, "test_driver") == 0)
+    {
+      test_driver = wl_registry_bind (registry, id, &test_driver_interface, 1);
+    }
+}
+
+static void
+handle_registry_global_remove (void               *data,
+                               struct wl_registry *registry,
+                               uint32_t            name)
+{
+}
+
+static const struct wl_registry_listener registry_listener = {
+  handle_registry_global,
+  handle_registry_global_remove
+};
+
+static void
+flood_batch (void)
+{
+  static int n_commits = 0;
+  int i;
+
+  for (i = 0; i < COMMITS_PER_BATCH; i++)
+    {
+      struct wl_region *region;
+
+      region = wl_compositor_create_region (compositor);
+      wl_region_add (region, 0, 0, 100, 100);
+      wl_region_subtract (region, 10, 10, 10, 10);
+      wl_surface_set_opaque_region (surface, region);
+      wl_surface_damage (surface, n_commits % 100, n_commits % 100, 10, 10);
+      wl_surface_commit (surface);
+      wl_region_destroy (region);
+
+      n_commits++;
+    }
+}
+
+static gboolean
+flush_batch (void)
+{
+  int fd = wl_display_get_fd (display);
+
+  /* Keep the socket full without waiting for the compositor to process
+   * what was sent, so that there are always requests to dispatch. Only
+   * block when the socket can't take more, and read the events (region
+   * id deletions) meanwhile so that the compositor can't overflow the
+   * connection on its end. */
+  while (wl_display_flush (display) == -1)
+    {
+      struct pollfd pfd = { .fd = fd, .events = POLLIN | POLLOUT };
+
+      if (errno != EAGAIN)
+        return FALSE;
+
+      while (wl_display_prepare_read (display) != 0)
+        wl_display_dispatch_pending (display);
+
+      if (poll (&pfd, 1, -1) == -1)
+        {
+          wl_display_cancel_read (display);
+          return FALSE;
+        }
+
+      if (pfd.revents & POLLIN)
+        {
+          if (wl_display_read_events (display) == -1)
+            return FALSE;
+        }
+      else
+        {
+          wl_display_cancel_read (display);
+        }
+
+      if (wl_display_dispatch_pending (display) == -1)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  int64_t flood_start_us;
+
+  display = wl_display_connect (NULL);
+  registry = wl_display_get_registry (display);
+  wl_registry_add_listener (registry, &registry_listener, NULL);
+  wl_display_roundtrip (display);
+
+  if (!compositor)
+    {
+      fprintf (stderr, "No wl_compositor global\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!test_driver)
+    {
+      fprintf (stderr, "No test_driver global\n");
+      return EXIT_FAILURE;
+    }
+
+  surface = wl_compositor_create_surface (compositor);
+
+  test_driver_sync_point (test_driver, 0);
+  wl_display_roundtrip (display);
+
+  flood_start_us = g_get_monotonic_time ();
+  while (g_get_monotonic_time () - flood_start_us < FLOOD_DURATION_US)
+    {
+      flood_batch ();
+
+      if (!flush_batch ())
+        return EXIT_FAILURE;
+    }
+
+  test_driver_sync_point (test_driver, 1);
+  wl_display_roundtrip (display);
+
+  wl_surface_destroy (surface);
+  wl_display_disconnect (display);
+
+  return EXIT_SUCCESS;
+}
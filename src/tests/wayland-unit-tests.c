@@ -18,9 +18,11 @@
 #include "config.h"
 
 #include <gio/gio.h>
+#include <math.h>
 
 #include "core/display-private.h"
 #include "core/window-private.h"
+#include "meta/meta-backend.h"
 #include "meta-test/meta-context-test.h"
 #include "tests/meta-wayland-test-driver.h"
 #include "wayland/meta-wayland.h"
@@ -258,6 +260,155 @@ toplevel_activation (void)
   g_test_assert_expected_messages ();
 }
 
+typedef struct _FloodData
+{
+  GMainLoop *loop;
+  ClutterActor *stage;
+  gboolean flooding;
+  int64_t last_paint_us;
+  int n_frames;
+  int64_t max_interval_us;
+  double interval_sum_us;
+  double interval_sum_sq_us;
+} FloodData;
+
+static void
+on_flood_after_paint (ClutterStage     *stage,
+                      ClutterStageView *stage_view,
+                      FloodData        *data)
+{
+  int64_t now_us;
+
+  if (!data->flooding)
+    return;
+
+  now_us = g_get_monotonic_time ();
+  if (data->last_paint_us)
+    {
+      int64_t interval_us = now_us - data->last_paint_us;
+
+      data->max_interval_us = MAX (data->max_interval_us, interval_us);
+      data->interval_sum_us += interval_us;
+      data->interval_sum_sq_us += (double) interval_us * interval_us;
+      data->n_frames++;
+    }
+  data->last_paint_us = now_us;
+
+  clutter_actor_queue_redraw (data->stage);
+}
+
+static void
+on_flood_sync_point (MetaWaylandTestDriver *test_driver,
+                     unsigned int           sequence,
+                     struct wl_client      *wl_client,
+                     FloodData             *data)
+{
+  switch (sequence)
+    {
+    case 0:
+      data->flooding = TRUE;
+      clutter_actor_queue_redraw (data->stage);
+      break;
+    case 1:
+      data->flooding = FALSE;
+      g_main_loop_quit (data->loop);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+protocol_flood_frame_jitter (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  WaylandTestClient *wayland_test_client;
+  FloodData data = {};
+  gulong sync_point_id;
+  gulong after_paint_id;
+  double mean_us;
+  double stddev_us;
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.stage = meta_backend_get_stage (backend);
+
+  sync_point_id = g_signal_connect (test_driver, "sync-point",
+                                    G_CALLBACK (on_flood_sync_point), &data);
+  after_paint_id = g_signal_connect (data.stage, "after-paint",
+                                     G_CALLBACK (on_flood_after_paint), &data);
+
+  wayland_test_client = wayland_test_client_new ("protocol-flood");
+  g_main_loop_run (data.loop);
+  wayland_test_client_finish (wayland_test_client);
+
+  g_signal_handler_disconnect (test_driver, sync_point_id);
+  g_signal_handler_disconnect (data.stage, after_paint_id);
+  g_main_loop_unref (data.loop);
+
+  g_assert_cmpint (data.n_frames, >, 0);
+
+  mean_us = data.interval_sum_us / data.n_frames;
+  stddev_us = sqrt (MAX (0.0, data.interval_sum_sq_us / data.n_frames -
+                              mean_us * mean_us));
+
+  g_test_message ("Frame intervals under protocol flood: %d frames, "
+                  "mean %.2f ms, stddev %.2f ms, max %.2f ms",
+                  data.n_frames,
+                  mean_us / 1000.0,
+                  stddev_us / 1000.0,
+                  data.max_interval_us / 1000.0);
+
+  /* The flooding client keeps the Wayland source ready for the whole flood,
+   * so without the dispatch budget no frame would be dispatched until it
+   * stops. With it, frames must not be delayed by more than a few refresh
+   * cycles. */
+  g_assert_cmpint (data.n_frames, >, 20);
+  g_assert_cmpint (data.max_interval_us, <, G_USEC_PER_SEC / 10);
+}
+
+static void
+on_obscured_sync_point (MetaWaylandTestDriver *test_driver,
+                        unsigned int           sequence,
+                        struct wl_client      *wl_client,
+                        GMainLoop             *loop)
+{
+  g_assert_cmpint (sequence, ==, 0);
+  g_main_loop_quit (loop);
+}
+
+static void
+obscured_frame_callbacks (void)
+{
+  MetaWaylandCompositor *compositor = meta_wayland_compositor_get_default ();
+  WaylandTestClient *wayland_test_client;
+  GMainLoop *loop;
+  gulong sync_point_id;
+  uint64_t n_suppressed;
+
+  n_suppressed =
+    meta_wayland_compositor_get_n_suppressed_frame_callbacks (compositor);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  sync_point_id = g_signal_connect (test_driver, "sync-point",
+                                    G_CALLBACK (on_obscured_sync_point),
+                                    loop);
+
+  /* The client checks the interval between the callbacks of its obscured
+   * window itself and fails if they aren't throttled. */
+  wayland_test_client = wayland_test_client_new ("obscured-frame-callbacks");
+  g_main_loop_run (loop);
+
+  /* At least the callbacks whose interval was checked must have been
+   * emitted by the low rate timeout. */
+  g_assert_cmpuint (meta_wayland_compositor_get_n_suppressed_frame_callbacks (compositor) -
+                    n_suppressed, >=, 3);
+
+  wayland_test_client_finish (wayland_test_client);
+
+  g_signal_handler_disconnect (test_driver, sync_point_id);
+  g_main_loop_unref (loop);
+}
+
 static void
 pre_run_wayland_tests (void)
 {
@@ -284,6 +435,10 @@ init_wayland_tests (void)
                    toplevel_apply_limits);
   g_test_add_func ("/wayland/toplevel/activation",
                    toplevel_activation);
+  g_test_add_func ("/wayland/protocol/flood-frame-jitter",
+                   protocol_flood_frame_jitter);
+  g_test_add_func ("/wayland/frame-callbacks/obscured",
+                   obscured_frame_callbacks);
 }
 
 int
@@ -140,12 +140,13 @@ meta_wayland_actor_surface_queue_frame_callbacks (MetaWaylandActorSurface *actor
                                                       surface);
 }
 
-void
+int
 meta_wayland_actor_surface_emit_frame_callbacks (MetaWaylandActorSurface *actor_surface,
                                                  uint32_t                 timestamp_ms)
 {
   MetaWaylandActorSurfacePrivate *priv =
     meta_wayland_actor_surface_get_instance_private (actor_surface);
+  int n_callbacks = 0;
 
   while (!wl_list_empty (&priv->frame_callback_list))
     {
@@ -154,7 +155,10 @@ meta_wayland_actor_surface_emit_frame_callbacks (MetaWaylandActorSurface *actor_
 
       wl_callback_send_done (callback->resource, timestamp_ms);
       wl_resource_destroy (callback->resource);
+      n_callbacks++;
     }
+
+  return n_callbacks;
 }
 
 double
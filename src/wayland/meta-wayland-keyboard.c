@@ -66,9 +66,17 @@ G_DEFINE_TYPE (MetaWaylandKeyboard, meta_wayland_keyboard,
 static void meta_wayland_keyboard_update_xkb_state (MetaWaylandKeyboard *keyboard);
 static void notify_modifiers (MetaWaylandKeyboard *keyboard);
 
+#define MAX_CACHED_KEYMAPS 8
+#define KEYMAP_SEND_BATCH_SIZE 16
+
 static void
 unbind_resource (struct wl_resource *resource)
 {
+  MetaWaylandKeyboard *keyboard = wl_resource_get_user_data (resource);
+
+  if (keyboard->pending_keymap_resources)
+    g_hash_table_remove (keyboard->pending_keymap_resources, resource);
+
   wl_list_remove (wl_resource_get_link (resource));
 }
 
@@ -102,15 +110,110 @@ send_keymap (MetaWaylandKeyboard *keyboard,
   meta_anonymous_file_close_fd (fd);
 }
 
+static void
+flush_pending_keymap (MetaWaylandKeyboard *keyboard,
+                      struct wl_resource  *resource)
+{
+  if (g_hash_table_remove (keyboard->pending_keymap_resources, resource))
+    send_keymap (keyboard, resource);
+}
+
+static gboolean
+send_pending_keymaps (gpointer user_data)
+{
+  MetaWaylandKeyboard *keyboard = user_data;
+  GHashTableIter iter;
+  struct wl_resource *resource;
+  int n_sent = 0;
+
+  g_hash_table_iter_init (&iter, keyboard->pending_keymap_resources);
+  while (n_sent < KEYMAP_SEND_BATCH_SIZE &&
+         g_hash_table_iter_next (&iter, (gpointer *) &resource, NULL))
+    {
+      g_hash_table_iter_remove (&iter);
+      send_keymap (keyboard, resource);
+      n_sent++;
+    }
+
+  if (g_hash_table_size (keyboard->pending_keymap_resources) > 0)
+    return G_SOURCE_CONTINUE;
+
+  keyboard->send_keymaps_idle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
 static void
 inform_clients_of_new_keymap (MetaWaylandKeyboard *keyboard)
 {
   struct wl_resource *keyboard_resource;
 
-  wl_resource_for_each (keyboard_resource, &keyboard->resource_list)
-    send_keymap (keyboard, keyboard_resource);
+  /* The focused client is about to receive key events and needs the new
+   * keymap right away, while everyone else gets it in batches from an idle
+   * callback, to avoid stalling when many clients are connected.
+   */
   wl_resource_for_each (keyboard_resource, &keyboard->focus_resource_list)
-    send_keymap (keyboard, keyboard_resource);
+    {
+      g_hash_table_remove (keyboard->pending_keymap_resources,
+                           keyboard_resource);
+      send_keymap (keyboard, keyboard_resource);
+    }
+
+  wl_resource_for_each (keyboard_resource, &keyboard->resource_list)
+    g_hash_table_add (keyboard->pending_keymap_resources, keyboard_resource);
+
+  if (g_hash_table_size (keyboard->pending_keymap_resources) > 0 &&
+      !keyboard->send_keymaps_idle_id)
+    {
+      keyboard->send_keymaps_idle_id =
+        g_idle_add (send_pending_keymaps, keyboard);
+      g_source_set_name_by_id (keyboard->send_keymaps_idle_id,
+                               "[mutter] send_pending_keymaps");
+    }
+}
+
+static MetaAnonymousFile *
+ensure_keymap_rofile (MetaWaylandXkbInfo *xkb_info,
+                      struct xkb_keymap  *keymap)
+{
+  MetaAnonymousFile *keymap_rofile;
+  char *keymap_string;
+  size_t keymap_size;
+
+  /* Backends hand out the same keymap again when switching back to a
+   * previously used configuration, so only serialize new ones.
+   */
+  keymap_rofile = g_hash_table_lookup (xkb_info->keymap_rofiles, keymap);
+  if (keymap_rofile)
+    return keymap_rofile;
+
+  keymap_string = xkb_keymap_get_as_string (keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+  if (!keymap_string)
+    {
+      g_warning ("Failed to get string version of keymap");
+      return NULL;
+    }
+  keymap_size = strlen (keymap_string) + 1;
+
+  keymap_rofile =
+    meta_anonymous_file_new (keymap_size, (const uint8_t *) keymap_string);
+  free (keymap_string);
+  if (!keymap_rofile)
+    {
+      g_warning ("Failed to create anonymous file for keymap");
+      return NULL;
+    }
+
+  /* Only ever referenced by xkb_info->keymap_rofile, which is about to be
+   * replaced, so dropping everything when the cache is full is safe.
+   */
+  if (g_hash_table_size (xkb_info->keymap_rofiles) >= MAX_CACHED_KEYMAPS)
+    g_hash_table_remove_all (xkb_info->keymap_rofiles);
+
+  g_hash_table_insert (xkb_info->keymap_rofiles,
+                       xkb_keymap_ref (keymap),
+                       keymap_rofile);
+
+  return keymap_rofile;
 }
 
 static void
@@ -118,8 +221,6 @@ meta_wayland_keyboard_take_keymap (MetaWaylandKeyboard *keyboard,
 				   struct xkb_keymap   *keymap)
 {
   MetaWaylandXkbInfo *xkb_info = &keyboard->xkb_info;
-  char *keymap_string;
-  size_t keymap_size;
 
   if (keymap == NULL)
     {
@@ -132,26 +233,9 @@ meta_wayland_keyboard_take_keymap (MetaWaylandKeyboard *keyboard,
 
   meta_wayland_keyboard_update_xkb_state (keyboard);
 
-  keymap_string =
-    xkb_keymap_get_as_string (xkb_info->keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
-  if (!keymap_string)
-    {
-      g_warning ("Failed to get string version of keymap");
-      return;
-    }
-  keymap_size = strlen (keymap_string) + 1;
-
-  g_clear_pointer (&xkb_info->keymap_rofile, meta_anonymous_file_free);
-  xkb_info->keymap_rofile =
-    meta_anonymous_file_new (keymap_size, (const uint8_t *) keymap_string);
-
-  free (keymap_string);
-
+  xkb_info->keymap_rofile = ensure_keymap_rofile (xkb_info, xkb_info->keymap);
   if (!xkb_info->keymap_rofile)
-    {
-      g_warning ("Failed to create anonymous file for keymap");
-      return;
-    }
+    return;
 
   inform_clients_of_new_keymap (keyboard);
 
@@ -536,7 +620,8 @@ meta_wayland_xkb_info_destroy (MetaWaylandXkbInfo *xkb_info)
 {
   g_clear_pointer (&xkb_info->keymap, xkb_keymap_unref);
   g_clear_pointer (&xkb_info->state, xkb_state_unref);
-  g_clear_pointer (&xkb_info->keymap_rofile, meta_anonymous_file_free);
+  xkb_info->keymap_rofile = NULL;
+  g_clear_pointer (&xkb_info->keymap_rofiles, g_hash_table_unref);
 }
 
 void
@@ -550,6 +635,9 @@ meta_wayland_keyboard_disable (MetaWaylandKeyboard *keyboard)
   meta_wayland_keyboard_end_grab (keyboard);
   meta_wayland_keyboard_set_focus (keyboard, NULL);
 
+  g_clear_handle_id (&keyboard->send_keymaps_idle_id, g_source_remove);
+  g_hash_table_remove_all (keyboard->pending_keymap_resources);
+
   wl_list_remove (&keyboard->resource_list);
   wl_list_init (&keyboard->resource_list);
   wl_list_remove (&keyboard->focus_resource_list);
@@ -759,6 +847,7 @@ meta_wayland_keyboard_set_focus (MetaWaylandKeyboard *keyboard,
 
           wl_resource_for_each (resource, &keyboard->focus_resource_list)
             {
+              flush_pending_keymap (keyboard, resource);
               broadcast_focus (keyboard, resource);
             }
         }
@@ -846,6 +935,12 @@ meta_wayland_keyboard_init (MetaWaylandKeyboard *keyboard)
   wl_list_init (&keyboard->resource_list);
   wl_list_init (&keyboard->focus_resource_list);
 
+  keyboard->pending_keymap_resources = g_hash_table_new (NULL, NULL);
+  keyboard->xkb_info.keymap_rofiles =
+    g_hash_table_new_full (NULL, NULL,
+                           (GDestroyNotify) xkb_keymap_unref,
+                           (GDestroyNotify) meta_anonymous_file_free);
+
   keyboard->default_grab.interface = &default_keyboard_grab_interface;
   keyboard->default_grab.keyboard = keyboard;
   keyboard->grab = &keyboard->default_grab;
@@ -860,6 +955,8 @@ meta_wayland_keyboard_finalize (GObject *object)
   MetaWaylandKeyboard *keyboard = META_WAYLAND_KEYBOARD (object);
 
   meta_wayland_xkb_info_destroy (&keyboard->xkb_info);
+  g_clear_handle_id (&keyboard->send_keymaps_idle_id, g_source_remove);
+  g_clear_pointer (&keyboard->pending_keymap_resources, g_hash_table_unref);
 
   G_OBJECT_CLASS (meta_wayland_keyboard_parent_class)->finalize (object);
 }
@@ -76,6 +76,7 @@ typedef struct
   struct xkb_keymap *keymap;
   struct xkb_state *state;
   MetaAnonymousFile *keymap_rofile;
+  GHashTable *keymap_rofiles;
 } MetaWaylandXkbInfo;
 
 struct _MetaWaylandKeyboard
@@ -85,6 +86,9 @@ struct _MetaWaylandKeyboard
   struct wl_list resource_list;
   struct wl_list focus_resource_list;
 
+  GHashTable *pending_keymap_resources;
+  guint send_keymaps_idle_id;
+
   MetaWaylandSurface *focus_surface;
   struct wl_listener focus_surface_listener;
   uint32_t focus_serial;
@@ -53,11 +53,17 @@ struct _MetaWaylandOutput
   GObject parent;
 
   struct wl_global *global;
+  int x;
+  int y;
+  int width_mm;
+  int height_mm;
+  enum wl_output_subpixel subpixel_order;
   uint32_t mode_flags;
   float refresh_rate;
   int scale;
   int mode_width;
   int mode_height;
+  MetaRectangle layout;
 
   GList *resources;
   GList *xdg_output_resources;
@@ -157,14 +163,6 @@ get_rotated_physical_dimensions (MetaMonitor *monitor,
     }
 }
 
-static gboolean
-is_different_rotation (MetaLogicalMonitor *a,
-                       MetaLogicalMonitor *b)
-{
-  return (meta_monitor_transform_is_rotated (a->transform) !=
-          meta_monitor_transform_is_rotated (b->transform));
-}
-
 static void
 get_native_output_mode_resolution (MetaMonitor     *monitor,
                                    MetaMonitorMode *mode,
@@ -182,6 +180,20 @@ get_native_output_mode_resolution (MetaMonitor     *monitor,
     meta_monitor_mode_get_resolution (mode, mode_width, mode_height);
 }
 
+static enum wl_output_subpixel
+get_wl_output_subpixel_order (MetaMonitor *monitor)
+{
+  CoglSubpixelOrder cogl_subpixel_order;
+
+  cogl_subpixel_order = meta_monitor_get_subpixel_order (monitor);
+  return cogl_subpixel_order_to_wl_output_subpixel (cogl_subpixel_order);
+}
+
+/*
+ * Sends the wl_output events for the properties of @monitor that differ from
+ * what was last sent for @wayland_output, or all of them if @need_all_events
+ * is TRUE.
+ */
 static void
 send_output_events (struct wl_resource *resource,
                     MetaWaylandOutput  *wayland_output,
@@ -194,45 +206,34 @@ send_output_events (struct wl_resource *resource,
   MetaMonitorMode *preferred_mode;
   guint mode_flags = WL_OUTPUT_MODE_CURRENT;
   MetaLogicalMonitor *logical_monitor;
-  MetaLogicalMonitor *old_logical_monitor;
-  guint old_mode_flags;
-  gint old_scale;
-  float old_refresh_rate;
+  int width_mm, height_mm;
+  enum wl_output_subpixel subpixel_order;
   float refresh_rate;
   int new_width, new_height;
+  gboolean need_done = FALSE;
 
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  old_logical_monitor =
-    meta_monitor_get_logical_monitor (wayland_output->monitor);
-  old_mode_flags = wayland_output->mode_flags;
-  old_scale = wayland_output->scale;
-  old_refresh_rate = wayland_output->refresh_rate;
 
   current_mode = meta_monitor_get_current_mode (monitor);
   refresh_rate = meta_monitor_mode_get_refresh_rate (current_mode);
 
-  gboolean need_done = FALSE;
+  get_rotated_physical_dimensions (monitor, &width_mm, &height_mm);
+  subpixel_order = get_wl_output_subpixel_order (monitor);
 
   if (need_all_events ||
-      old_logical_monitor->rect.x != logical_monitor->rect.x ||
-      old_logical_monitor->rect.y != logical_monitor->rect.y ||
-      is_different_rotation (old_logical_monitor, logical_monitor))
+      wayland_output->x != logical_monitor->rect.x ||
+      wayland_output->y != logical_monitor->rect.y ||
+      wayland_output->width_mm != width_mm ||
+      wayland_output->height_mm != height_mm ||
+      wayland_output->subpixel_order != subpixel_order)
     {
-      int width_mm, height_mm;
       const char *vendor;
       const char *product;
       uint32_t transform;
-      CoglSubpixelOrder cogl_subpixel_order;
-      enum wl_output_subpixel subpixel_order;
 
-      get_rotated_physical_dimensions (monitor, &width_mm, &height_mm);
       vendor = meta_monitor_get_vendor (monitor);
       product = meta_monitor_get_product (monitor);
 
-      cogl_subpixel_order = meta_monitor_get_subpixel_order (monitor);
-      subpixel_order =
-        cogl_subpixel_order_to_wl_output_subpixel (cogl_subpixel_order);
-
       /*
        * TODO: When we support wl_surface.set_buffer_transform, pass along
        * the correct transform here instead of always pretending its 'normal'.
@@ -264,8 +265,8 @@ send_output_events (struct wl_resource *resource,
   if (need_all_events ||
       wayland_output->mode_width != new_width ||
       wayland_output->mode_height != new_height ||
-      old_refresh_rate != refresh_rate ||
-      old_mode_flags != mode_flags)
+      wayland_output->refresh_rate != refresh_rate ||
+      wayland_output->mode_flags != mode_flags)
     {
       wl_output_send_mode (resource,
                            mode_flags,
@@ -281,7 +282,7 @@ send_output_events (struct wl_resource *resource,
 
       scale = calculate_wayland_output_scale (monitor);
       if (need_all_events ||
-          old_scale != scale)
+          wayland_output->scale != scale)
         {
           wl_output_send_scale (resource, scale);
           need_done = TRUE;
@@ -341,12 +342,22 @@ static void
 meta_wayland_output_set_monitor (MetaWaylandOutput *wayland_output,
                                  MetaMonitor       *monitor)
 {
+  MetaLogicalMonitor *logical_monitor;
   MetaMonitorMode *current_mode;
   MetaMonitorMode *preferred_mode;
 
   wayland_output->monitor = monitor;
   wayland_output->mode_flags = WL_OUTPUT_MODE_CURRENT;
 
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  wayland_output->x = logical_monitor->rect.x;
+  wayland_output->y = logical_monitor->rect.y;
+  wayland_output->layout = meta_logical_monitor_get_layout (logical_monitor);
+  get_rotated_physical_dimensions (monitor,
+                                   &wayland_output->width_mm,
+                                   &wayland_output->height_mm);
+  wayland_output->subpixel_order = get_wl_output_subpixel_order (monitor);
+
   current_mode = meta_monitor_get_current_mode (monitor);
   preferred_mode = meta_monitor_get_preferred_mode (monitor);
 
@@ -361,7 +372,7 @@ meta_wayland_output_set_monitor (MetaWaylandOutput *wayland_output,
                                      &wayland_output->mode_height);
 }
 
-static void
+static gboolean
 wayland_output_update_for_output (MetaWaylandOutput *wayland_output,
                                   MetaMonitor       *monitor)
 {
@@ -385,27 +396,31 @@ wayland_output_update_for_output (MetaWaylandOutput *wayland_output,
                               FALSE, &pending_done_event);
     }
 
-  /* Send the "done" events if needed */
-  if (pending_done_event)
-    {
-      for (l = wayland_output->resources; l; l = l->next)
-        {
-          struct wl_resource *resource = l->data;
+  meta_wayland_output_set_monitor (wayland_output, monitor);
 
-          if (wl_resource_get_version (resource) >= WL_OUTPUT_DONE_SINCE_VERSION)
-            wl_output_send_done (resource);
-        }
+  return pending_done_event;
+}
 
-      for (l = wayland_output->xdg_output_resources; l; l = l->next)
-        {
-          struct wl_resource *xdg_output = l->data;
+static void
+wayland_output_send_done (MetaWaylandOutput *wayland_output)
+{
+  GList *l;
 
-          if (wl_resource_get_version (xdg_output) < NO_XDG_OUTPUT_DONE_SINCE_VERSION)
-            zxdg_output_v1_send_done (xdg_output);
-        }
+  for (l = wayland_output->resources; l; l = l->next)
+    {
+      struct wl_resource *resource = l->data;
+
+      if (wl_resource_get_version (resource) >= WL_OUTPUT_DONE_SINCE_VERSION)
+        wl_output_send_done (resource);
     }
 
-  meta_wayland_output_set_monitor (wayland_output, monitor);
+  for (l = wayland_output->xdg_output_resources; l; l = l->next)
+    {
+      struct wl_resource *xdg_output = l->data;
+
+      if (wl_resource_get_version (xdg_output) < NO_XDG_OUTPUT_DONE_SINCE_VERSION)
+        zxdg_output_v1_send_done (xdg_output);
+    }
 }
 
 static MetaWaylandOutput *
@@ -475,6 +490,7 @@ meta_wayland_compositor_update_outputs (MetaWaylandCompositor *compositor,
 {
   GHashTable *new_table;
   GList *monitors, *l;
+  GList *pending_done_outputs = NULL;
 
   monitors = meta_monitor_manager_get_monitors (monitor_manager);
   new_table = g_hash_table_new_full (meta_monitor_spec_hash,
@@ -499,7 +515,12 @@ meta_wayland_compositor_update_outputs (MetaWaylandCompositor *compositor,
       else
         wayland_output = meta_wayland_output_new (compositor, monitor);
 
-      wayland_output_update_for_output (wayland_output, monitor);
+      if (wayland_output_update_for_output (wayland_output, monitor))
+        {
+          pending_done_outputs = g_list_prepend (pending_done_outputs,
+                                                 wayland_output);
+        }
+
       g_hash_table_insert (new_table,
                            meta_monitor_spec_clone (monitor_spec),
                            wayland_output);
@@ -511,6 +532,13 @@ meta_wayland_compositor_update_outputs (MetaWaylandCompositor *compositor,
       g_timeout_add_seconds (10, delayed_destroy_outputs, compositor->outputs);
     }
 
+  /* Only send the "done" events once every output has been updated, so that
+   * clients see the new configuration as a whole.
+   */
+  for (l = pending_done_outputs; l; l = l->next)
+    wayland_output_send_done (l->data);
+  g_list_free (pending_done_outputs);
+
   return new_table;
 }
 
@@ -600,11 +628,26 @@ send_xdg_output_events (struct wl_resource *resource,
   MetaLogicalMonitor *logical_monitor;
   int version;
 
+  gboolean need_done = FALSE;
+
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
   layout = meta_logical_monitor_get_layout (logical_monitor);
 
-  zxdg_output_v1_send_logical_position (resource, layout.x, layout.y);
-  zxdg_output_v1_send_logical_size (resource, layout.width, layout.height);
+  if (need_all_events ||
+      wayland_output->layout.x != layout.x ||
+      wayland_output->layout.y != layout.y)
+    {
+      zxdg_output_v1_send_logical_position (resource, layout.x, layout.y);
+      need_done = TRUE;
+    }
+
+  if (need_all_events ||
+      wayland_output->layout.width != layout.width ||
+      wayland_output->layout.height != layout.height)
+    {
+      zxdg_output_v1_send_logical_size (resource, layout.width, layout.height);
+      need_done = TRUE;
+    }
 
   version = wl_resource_get_version (resource);
 
@@ -624,7 +667,7 @@ send_xdg_output_events (struct wl_resource *resource,
       zxdg_output_v1_send_description (resource, description);
     }
 
-  if (pending_done_event)
+  if (pending_done_event && need_done)
     *pending_done_event = TRUE;
 }
 
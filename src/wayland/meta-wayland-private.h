@@ -88,6 +88,8 @@ struct _MetaWaylandCompositor
   char *display_name;
   GHashTable *outputs;
   GList *frame_callback_surfaces;
+  guint obscured_frame_callbacks_source_id;
+  uint64_t n_suppressed_frame_callbacks;
 
   MetaXWaylandManager xwayland_manager;
 
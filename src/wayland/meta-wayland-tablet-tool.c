@@ -782,9 +782,24 @@ static void
 handle_motion_event (MetaWaylandTabletTool *tool,
                      const ClutterEvent    *event)
 {
+  unsigned int i;
+
   if (!tool->focus_surface)
     return;
 
+  /* Replay the samples that were compressed into this event, so clients
+   * get the full resolution of the stylus and not only one per frame.
+   */
+  for (i = 0; i < clutter_event_get_n_history_events (event); i++)
+    {
+      const ClutterEvent *history_event =
+        clutter_event_get_history_event (event, i);
+
+      broadcast_motion (tool, history_event);
+      broadcast_axes (tool, history_event);
+      broadcast_frame (tool, history_event);
+    }
+
   broadcast_motion (tool, event);
   broadcast_axes (tool, event);
   broadcast_frame (tool, event);
@@ -74,10 +74,21 @@ meta_wayland_compositor_get_default (void)
   return wayland_compositor;
 }
 
+/*
+ * Maximum time spent dispatching client requests in consecutive main loop
+ * iterations before the Wayland event source yields to the frame clock.
+ */
+#define WAYLAND_DISPATCH_BUDGET_US 4000
+
 typedef struct
 {
   GSource source;
   struct wl_display *display;
+
+  int priority;
+  gboolean is_yielding;
+  int64_t busy_us;
+  int64_t last_dispatch_end_us;
 } WaylandEventSource;
 
 static gboolean
@@ -100,9 +111,48 @@ wayland_event_source_dispatch (GSource    *base,
 {
   WaylandEventSource *source = (WaylandEventSource *)base;
   struct wl_event_loop *loop = wl_display_get_event_loop (source->display);
+  int64_t dispatch_start_us;
+  int64_t dispatch_end_us;
+
+  if (source->is_yielding)
+    {
+      g_source_set_priority (base, source->priority);
+      source->is_yielding = FALSE;
+    }
+
+  dispatch_start_us = g_get_monotonic_time ();
 
   wl_event_loop_dispatch (loop, 0);
 
+  dispatch_end_us = g_get_monotonic_time ();
+
+  /* libwayland-server dispatches all requests of a client in one go, and a
+   * client flooding the compositor keeps the source ready on every main loop
+   * iteration, starving lower priority sources such as the frame clock. If
+   * we have been busy for longer than the budget without the source going
+   * idle, drop below the redraw priority for one iteration so that pending
+   * frames are dispatched before the remaining requests.
+   */
+  if (dispatch_start_us - source->last_dispatch_end_us >
+      WAYLAND_DISPATCH_BUDGET_US)
+    source->busy_us = 0;
+
+  source->busy_us += dispatch_end_us - dispatch_start_us;
+  source->last_dispatch_end_us = dispatch_end_us;
+
+  if (source->busy_us > WAYLAND_DISPATCH_BUDGET_US)
+    {
+      meta_topic (META_DEBUG_WAYLAND,
+                  "Spent %" G_GINT64_FORMAT " us dispatching requests, "
+                  "yielding to the frame clock",
+                  source->busy_us);
+
+      source->priority = g_source_get_priority (base);
+      g_source_set_priority (base, CLUTTER_PRIORITY_REDRAW + 1);
+      source->is_yielding = TRUE;
+      source->busy_us = 0;
+    }
+
   return TRUE;
 }
 
@@ -198,6 +248,77 @@ meta_wayland_compositor_update (MetaWaylandCompositor *compositor,
     meta_wayland_seat_update (compositor->seat, event);
 }
 
+#define OBSCURED_FRAME_CALLBACK_INTERVAL_MS 1000
+
+static int
+emit_surface_frame_callbacks (MetaWaylandCompositor *compositor,
+                              MetaWaylandSurface    *surface,
+                              int64_t                now_us)
+{
+  MetaWaylandActorSurface *actor_surface;
+
+  actor_surface = META_WAYLAND_ACTOR_SURFACE (surface->role);
+  return meta_wayland_actor_surface_emit_frame_callbacks (actor_surface,
+                                                          now_us / 1000);
+}
+
+static gboolean
+emit_obscured_frame_callbacks (gpointer user_data)
+{
+  MetaWaylandCompositor *compositor = user_data;
+  MetaBackend *backend = meta_context_get_backend (compositor->context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  gboolean has_obscured_surfaces = FALSE;
+  GList *l;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+
+  l = compositor->frame_callback_surfaces;
+  while (l)
+    {
+      GList *l_cur = l;
+      MetaWaylandSurface *surface = l->data;
+      MetaSurfaceActor *actor;
+
+      l = l->next;
+
+      actor = meta_wayland_surface_get_actor (surface);
+      if (!actor)
+        continue;
+
+      if (meta_surface_actor_wayland_get_current_primary_view (actor, stage))
+        continue;
+
+      compositor->n_suppressed_frame_callbacks +=
+        emit_surface_frame_callbacks (compositor, surface, now_us);
+      has_obscured_surfaces = TRUE;
+
+      compositor->frame_callback_surfaces =
+        g_list_delete_link (compositor->frame_callback_surfaces, l_cur);
+    }
+
+  if (has_obscured_surfaces)
+    return G_SOURCE_CONTINUE;
+
+  compositor->obscured_frame_callbacks_source_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ensure_obscured_frame_callbacks_source (MetaWaylandCompositor *compositor)
+{
+  if (compositor->obscured_frame_callbacks_source_id)
+    return;
+
+  compositor->obscured_frame_callbacks_source_id =
+    g_timeout_add (OBSCURED_FRAME_CALLBACK_INTERVAL_MS,
+                   emit_obscured_frame_callbacks,
+                   compositor);
+  g_source_set_name_by_id (compositor->obscured_frame_callbacks_source_id,
+                           "[mutter] emit_obscured_frame_callbacks");
+}
+
 static void
 on_after_update (ClutterStage          *stage,
                  ClutterStageView      *stage_view,
@@ -214,7 +335,6 @@ on_after_update (ClutterStage          *stage,
       GList *l_cur = l;
       MetaWaylandSurface *surface = l->data;
       MetaSurfaceActor *actor;
-      MetaWaylandActorSurface *actor_surface;
       ClutterStageView *surface_primary_view;
 
       l = l->next;
@@ -225,12 +345,20 @@ on_after_update (ClutterStage          *stage,
 
       surface_primary_view =
         meta_surface_actor_wayland_get_current_primary_view (actor, stage);
+      if (!surface_primary_view)
+        {
+          /* The surface is unmapped or fully obscured on every view; hold
+           * back its frame callbacks and let the low rate timeout emit them
+           * instead of doing so on every stage update.
+           */
+          ensure_obscured_frame_callbacks_source (compositor);
+          continue;
+        }
+
       if (stage_view != surface_primary_view)
         continue;
 
-      actor_surface = META_WAYLAND_ACTOR_SURFACE (surface->role);
-      meta_wayland_actor_surface_emit_frame_callbacks (actor_surface,
-                                                       now_us / 1000);
+      emit_surface_frame_callbacks (compositor, surface, now_us);
 
       compositor->frame_callback_surfaces =
         g_list_delete_link (compositor->frame_callback_surfaces, l_cur);
@@ -328,11 +456,23 @@ void
 meta_wayland_compositor_add_frame_callback_surface (MetaWaylandCompositor *compositor,
                                                     MetaWaylandSurface    *surface)
 {
+  MetaBackend *backend = meta_context_get_backend (compositor->context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  MetaSurfaceActor *actor;
+
   if (g_list_find (compositor->frame_callback_surfaces, surface))
     return;
 
   compositor->frame_callback_surfaces =
     g_list_prepend (compositor->frame_callback_surfaces, surface);
+
+  /* Obscured surfaces don't schedule a stage update when committing, so
+   * make sure their callbacks are still emitted by the low rate timeout.
+   */
+  actor = meta_wayland_surface_get_actor (surface);
+  if (actor &&
+      !meta_surface_actor_wayland_get_current_primary_view (actor, stage))
+    ensure_obscured_frame_callbacks_source (compositor);
 }
 
 void
@@ -343,6 +483,22 @@ meta_wayland_compositor_remove_frame_callback_surface (MetaWaylandCompositor *co
     g_list_remove (compositor->frame_callback_surfaces, surface);
 }
 
+/**
+ * meta_wayland_compositor_get_n_suppressed_frame_callbacks:
+ * @compositor: the #MetaWaylandCompositor instance
+ *
+ * Returns the number of frame callbacks of unmapped or fully obscured
+ * surfaces that were held back and emitted by the low rate timeout instead
+ * of after a stage update. Each callback is counted once.
+ *
+ * Returns: the number of suppressed frame callbacks
+ */
+uint64_t
+meta_wayland_compositor_get_n_suppressed_frame_callbacks (MetaWaylandCompositor *compositor)
+{
+  return compositor->n_suppressed_frame_callbacks;
+}
+
 void
 meta_wayland_compositor_add_presentation_feedback_surface (MetaWaylandCompositor *compositor,
                                                            MetaWaylandSurface    *surface)
@@ -425,6 +581,10 @@ meta_wayland_compositor_finalize (GObject *object)
 {
   MetaWaylandCompositor *compositor = META_WAYLAND_COMPOSITOR (object);
 
+  g_clear_handle_id (&compositor->obscured_frame_callbacks_source_id,
+                     g_source_remove);
+  g_clear_pointer (&compositor->frame_callback_surfaces, g_list_free);
+
   g_clear_pointer (&compositor->seat, meta_wayland_seat_free);
 
   g_clear_pointer (&compositor->display_name, g_free);
@@ -61,6 +61,9 @@ void                    meta_wayland_compositor_add_frame_callback_surface (Meta
 void                    meta_wayland_compositor_remove_frame_callback_surface (MetaWaylandCompositor *compositor,
                                                                                MetaWaylandSurface    *surface);
 
+META_EXPORT_TEST
+uint64_t                meta_wayland_compositor_get_n_suppressed_frame_callbacks (MetaWaylandCompositor *compositor);
+
 void                    meta_wayland_compositor_add_presentation_feedback_surface (MetaWaylandCompositor *compositor,
                                                                                    MetaWaylandSurface    *surface);
 